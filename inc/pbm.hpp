@@ -0,0 +1,495 @@
+/**
+ * @file pbm.hpp
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Header-only C++17 wrapper of the pbm images
+ *
+ * The data alignment is a template parameter, the pixel and span operations
+ * are resolved at compile time and can be inlined. The glyph operations and
+ * images with an alignment known only at run time (pbm::dynamicAlignment) use
+ * the C functions.
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PBM_HPP
+#define PBM_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "pbm_graphics.h"
+#include "pbm_types.h"
+
+namespace pbm {
+
+/**
+ * @brief Alignment parameter of images with the alignment given at run time
+ *
+ */
+constexpr pbm_data_alignment dynamicAlignment = PBM_DATA_MAX_ALIGNMENTS;
+
+namespace detail {
+
+constexpr uint32_t bitsPerByte = 8; ///< Pixels per data byte
+
+/**
+ * @brief Check for a horizontal data alignment
+ *
+ * @param alignment the data alignment
+ * @return true for the horizontal alignments
+ */
+constexpr bool isHorizontal(pbm_data_alignment alignment) {
+  return PBM_DATA_HORIZONTAL_MSB == alignment ||
+         PBM_DATA_HORIZONTAL_LSB == alignment;
+}
+
+/**
+ * @brief Check for a most significant bit first data alignment
+ *
+ * @param alignment the data alignment
+ * @return true for the MSB alignments
+ */
+constexpr bool isMsb(pbm_data_alignment alignment) {
+  return PBM_DATA_HORIZONTAL_MSB == alignment ||
+         PBM_DATA_VERTICAL_MSB == alignment;
+}
+
+/**
+ * @brief Size of the image data in bytes
+ *
+ * @param alignment the data alignment
+ * @param width width of the image
+ * @param height height of the image
+ * @return size_t number of bytes
+ */
+constexpr size_t dataSize(pbm_data_alignment alignment, uint32_t width,
+                          uint32_t height) {
+  if (0 == width || 0 == height) {
+    return 0;
+  }
+  return isHorizontal(alignment)
+             ? (size_t)((width - 1) / bitsPerByte + 1) * height
+             : (size_t)((height - 1) / bitsPerByte + 1) * width;
+}
+
+/**
+ * @brief Index of the byte with a pixel
+ *
+ * @param alignment the data alignment
+ * @param width width of the image
+ * @param x position in x
+ * @param y position in y
+ * @return size_t the byte index
+ */
+constexpr size_t byteIndex(pbm_data_alignment alignment, uint32_t width,
+                           uint32_t x, uint32_t y) {
+  return isHorizontal(alignment)
+             ? (size_t)y * ((width - 1) / bitsPerByte + 1) + x / bitsPerByte
+             : (size_t)(y / bitsPerByte) * width + x;
+}
+
+/**
+ * @brief Bit of a pixel in its byte
+ *
+ * @param alignment the data alignment
+ * @param x position in x
+ * @param y position in y
+ * @return uint8_t the bit mask
+ */
+constexpr uint8_t bitMask(pbm_data_alignment alignment, uint32_t x,
+                          uint32_t y) {
+  const uint32_t bit = (isHorizontal(alignment) ? x : y) % bitsPerByte;
+  return isMsb(alignment) ? (uint8_t)(0x80u >> bit) : (uint8_t)(0x01u << bit);
+}
+
+/**
+ * @brief Mask of the pixels first to last (0 - 7) of a byte
+ *
+ * @param alignment the data alignment
+ * @param first first pixel in the byte
+ * @param last last pixel in the byte
+ * @return uint8_t the bit mask
+ */
+constexpr uint8_t spanMask(pbm_data_alignment alignment, uint32_t first,
+                           uint32_t last) {
+  const uint32_t bits = (1u << (last - first + 1)) - 1;
+  return isMsb(alignment) ? (uint8_t)(bits << (bitsPerByte - 1 - last))
+                          : (uint8_t)(bits << first);
+}
+
+} // namespace detail
+
+/**
+ * @brief Non-owning view of the image data with the data alignment
+ *
+ * For dynamicAlignment, the alignment is read from the image at run time.
+ *
+ * @tparam Alignment the data alignment or dynamicAlignment
+ */
+template <pbm_data_alignment Alignment> class imageView {
+public:
+  /**
+   * @brief Create a view of an image buffer
+   *
+   * @param data the image data
+   * @param width width of the image
+   * @param height height of the image
+   * @param alignment the data alignment, only used for dynamicAlignment
+   */
+  imageView(uint8_t *data, uint32_t width, uint32_t height,
+            pbm_data_alignment alignment = Alignment)
+      : handle_{width, height,
+                (dynamicAlignment == Alignment) ? alignment : Alignment,
+                data} {}
+
+  /**
+   * @brief Create a view of a C image handler
+   *
+   * The alignment of the image has to match for a static alignment.
+   *
+   * @param image the C image handler
+   */
+  explicit imageView(const pbm_image &image) : handle_{image} {
+    assert(dynamicAlignment == Alignment || Alignment == image.alignment);
+  }
+
+  /**
+   * @brief Get the data alignment
+   *
+   * @return pbm_data_alignment the alignment of the image data
+   */
+  constexpr pbm_data_alignment alignment() const {
+    if constexpr (dynamicAlignment == Alignment) {
+      return handle_.alignment;
+    } else {
+      return Alignment;
+    }
+  }
+
+  uint32_t width() const { return handle_.width; }   ///< Image width
+  uint32_t height() const { return handle_.height; } ///< Image height
+  uint8_t *data() const { return handle_.data; }     ///< Image data
+
+  /**
+   * @brief Size of the image data
+   *
+   * @return size_t number of bytes
+   */
+  size_t size() const {
+    return detail::dataSize(alignment(), handle_.width, handle_.height);
+  }
+
+  /**
+   * @brief Get the C image handler for the C functions
+   *
+   * @return pbm_image* the image handler
+   */
+  pbm_image *handle() { return &handle_; }
+
+  /**
+   * @brief Get the C image handler for the C functions
+   *
+   * @return const pbm_image* the image handler
+   */
+  const pbm_image *handle() const { return &handle_; }
+
+  /**
+   * @brief Read a pixel without range check
+   *
+   * @param x position in x
+   * @param y position in y
+   * @return pbm_colors the color of the pixel
+   */
+  pbm_colors pixel(uint32_t x, uint32_t y) const {
+    const pbm_data_alignment align = alignment();
+    return (handle_.data[detail::byteIndex(align, handle_.width, x, y)] &
+            detail::bitMask(align, x, y))
+               ? PBM_BLACK
+               : PBM_WHITE;
+  }
+
+  /**
+   * @brief Write a pixel without range check
+   *
+   * @param x position in x
+   * @param y position in y
+   * @param color the desired color
+   */
+  void setPixelUnchecked(uint32_t x, uint32_t y, pbm_colors color) {
+    const pbm_data_alignment align = alignment();
+    uint8_t &byte = handle_.data[detail::byteIndex(align, handle_.width, x, y)];
+    const uint8_t mask = detail::bitMask(align, x, y);
+    byte = (PBM_BLACK == color) ? (uint8_t)(byte | mask)
+                                : (uint8_t)(byte & ~mask);
+  }
+
+  /**
+   * @brief Write a pixel like pbm_setPixel
+   *
+   * @param x position in x
+   * @param y position in y
+   * @param color the desired color
+   * @return pbm_return state, PBM_OUT_OF_RANGE outside of the image
+   */
+  pbm_return setPixel(uint32_t x, uint32_t y, pbm_colors color) {
+    if constexpr (dynamicAlignment == Alignment) {
+      return pbm_setPixel(&handle_, x, y, color);
+    } else {
+      x = (PBM_IMAGE_END == x) ? handle_.width - 1 : x;
+      y = (PBM_IMAGE_END == y) ? handle_.height - 1 : y;
+      if (x >= handle_.width || y >= handle_.height) {
+        return PBM_OUT_OF_RANGE;
+      }
+      setPixelUnchecked(x, y, color);
+      return PBM_OK;
+    }
+  }
+
+  /**
+   * @brief Draw a horizontal line of pixels, clipped to the image
+   *
+   * @param x start position in x
+   * @param y position in y
+   * @param length number of pixels
+   * @param color the desired color
+   */
+  void drawSpan(uint32_t x, uint32_t y, uint32_t length, pbm_colors color) {
+    if (y >= handle_.height || x >= handle_.width || 0 == length) {
+      return;
+    }
+    if (length > handle_.width - x) {
+      length = handle_.width - x;
+    }
+    if constexpr (dynamicAlignment == Alignment) {
+      pbm_drawLine(&handle_, x, y, x + length - 1, y, color);
+    } else if constexpr (detail::isHorizontal(Alignment)) {
+      // Masked first and last byte, the bytes between are set at once
+      uint8_t *row = &handle_.data[detail::byteIndex(Alignment, handle_.width,
+                                                      0, y)];
+      const uint32_t last = x + length - 1;
+      const uint32_t firstByte = x / detail::bitsPerByte;
+      const uint32_t lastByte = last / detail::bitsPerByte;
+      const uint32_t firstBit = x % detail::bitsPerByte;
+      const uint32_t lastBit = last % detail::bitsPerByte;
+      if (firstByte == lastByte) {
+        applyMask(row[firstByte],
+                  detail::spanMask(Alignment, firstBit, lastBit), color);
+        return;
+      }
+      applyMask(row[firstByte],
+                detail::spanMask(Alignment, firstBit, detail::bitsPerByte - 1),
+                color);
+      std::memset(&row[firstByte + 1], (PBM_BLACK == color) ? 0xFF : 0x00,
+                  lastByte - firstByte - 1);
+      applyMask(row[lastByte], detail::spanMask(Alignment, 0, lastBit), color);
+    } else {
+      // Every pixel is in an own byte with the same bit
+      uint8_t *bytes =
+          &handle_.data[detail::byteIndex(Alignment, handle_.width, x, y)];
+      const uint8_t mask = detail::bitMask(Alignment, x, y);
+      for (uint32_t i = 0; i < length; i++) {
+        applyMask(bytes[i], mask, color);
+      }
+    }
+  }
+
+  /**
+   * @brief Fill a rectangle, clipped to the image
+   *
+   * @param x left position
+   * @param y top position
+   * @param width width of the rectangle
+   * @param height height of the rectangle
+   * @param color the desired color
+   */
+  void fillRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                pbm_colors color) {
+    for (uint32_t i = 0; i < height && y + i < handle_.height; i++) {
+      drawSpan(x, y + i, width, color);
+    }
+  }
+
+  /**
+   * @brief Fill the whole image
+   *
+   * @param color the desired color
+   */
+  void fill(pbm_colors color) {
+    std::memset(handle_.data, (PBM_BLACK == color) ? 0xFF : 0x00, size());
+  }
+
+  /**
+   * @brief Scroll a rectangle, see pbm_scroll
+   *
+   * @param rect the scrolled rectangle or NULL for the whole image
+   * @param dx horizontal distance in pixel
+   * @param dy vertical distance in pixel
+   * @param fill the color of the uncovered pixels
+   * @return pbm_return state
+   */
+  pbm_return scroll(const pbm_rect *rect, int32_t dx, int32_t dy,
+                    pbm_colors fill) {
+    return pbm_scroll(&handle_, rect, dx, dy, fill);
+  }
+
+  /**
+   * @brief Write a character, see pbm_writeCharStyled
+   *
+   * @param x start position on the top left corner in x
+   * @param y start position on the top left corner in y
+   * @param color the desired color
+   * @param font the font
+   * @param character the desired character
+   * @param style the text style or NULL
+   * @return pbm_return state
+   */
+  pbm_return writeChar(uint32_t x, uint32_t y, pbm_colors color,
+                       const pbm_font &font, uint8_t character,
+                       const pbm_textStyle *style = nullptr) {
+    return pbm_writeCharStyled(&handle_, x, y, color, &font, style, character);
+  }
+
+  /**
+   * @brief Write a string, see pbm_writeStringStyled
+   *
+   * @param x start position in x
+   * @param y start position in y
+   * @param color the desired color
+   * @param font the font
+   * @param textAlignment alignment of the string to the position
+   * @param msg the C string
+   * @param style the text style or NULL
+   * @return pbm_return state
+   */
+  pbm_return writeString(uint32_t x, uint32_t y, pbm_colors color,
+                         const pbm_font &font,
+                         pbm_stringAlignment textAlignment, const char *msg,
+                         const pbm_textStyle *style = nullptr) {
+    return pbm_writeStringStyled(&handle_, x, y, color, &font, textAlignment,
+                                 style, msg);
+  }
+
+private:
+  /**
+   * @brief Set or clear the bits of a mask
+   *
+   * @param byte the data byte
+   * @param mask the bits to change
+   * @param color the desired color
+   */
+  static void applyMask(uint8_t &byte, uint8_t mask, pbm_colors color) {
+    byte = (PBM_BLACK == color) ? (uint8_t)(byte | mask)
+                                : (uint8_t)(byte & ~mask);
+  }
+
+  pbm_image handle_; ///< The C image handler
+};
+
+/**
+ * @brief Image owning its zero initialized data, move-only
+ *
+ * @tparam Alignment the data alignment or dynamicAlignment
+ */
+template <pbm_data_alignment Alignment>
+class image : public imageView<Alignment> {
+public:
+  /**
+   * @brief Allocate a white image
+   *
+   * @param width width of the image
+   * @param height height of the image
+   * @param alignment the data alignment, only used for dynamicAlignment
+   */
+  image(uint32_t width, uint32_t height,
+        pbm_data_alignment alignment = Alignment)
+      : image(std::make_unique<uint8_t[]>(detail::dataSize(
+                  (dynamicAlignment == Alignment) ? alignment : Alignment,
+                  width, height)),
+              width, height, alignment) {}
+
+  image(const image &) = delete;
+  image &operator=(const image &) = delete;
+
+  /**
+   * @brief Take the data of another image, which is left empty
+   *
+   * @param other the moved image
+   */
+  image(image &&other) noexcept
+      : imageView<Alignment>(other), data_(std::move(other.data_)) {
+    other.reset();
+  }
+
+  /**
+   * @brief Release the data and take the data of another image, which is
+   * left empty
+   *
+   * @param other the moved image
+   * @return image& this image
+   */
+  image &operator=(image &&other) noexcept {
+    if (this != &other) {
+      imageView<Alignment>::operator=(other);
+      data_ = std::move(other.data_);
+      other.reset();
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Get a non-owning view, valid as long as the image exists
+   *
+   * @return imageView<Alignment> the view
+   */
+  imageView<Alignment> view() { return imageView<Alignment>(*this); }
+
+private:
+  /**
+   * @brief Take the allocated data
+   *
+   * @param data the allocated data
+   * @param width width of the image
+   * @param height height of the image
+   * @param alignment the data alignment
+   */
+  image(std::unique_ptr<uint8_t[]> data, uint32_t width, uint32_t height,
+        pbm_data_alignment alignment)
+      : imageView<Alignment>(data.get(), width, height, alignment),
+        data_(std::move(data)) {}
+
+  /**
+   * @brief Leave an empty image without data after a move
+   *
+   */
+  void reset() {
+    imageView<Alignment>::operator=(
+        imageView<Alignment>(nullptr, 0, 0, this->alignment()));
+  }
+
+  std::unique_ptr<uint8_t[]> data_; ///< Owned image data
+};
+
+} // namespace pbm
+
+#endif /* PBM_HPP */
@@ -0,0 +1,169 @@
+/**
+ * @file pbm_batch.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Load and save many PBM images asynchronously
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_BATCH_H
+#define PBM_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pbm_io.h"
+#include "pbm_types.h"
+
+#ifndef PBM_BATCH_MAX_THREADS
+/**
+ * @brief Maximum number of workers of the thread backend
+ *
+ * The pool has the size of the depth up to this limit. Deeper batches queue
+ * the further requests until a worker is free.
+ */
+#define PBM_BATCH_MAX_THREADS (16)
+#endif
+
+/**
+ * @brief Operation of a batch request
+ *
+ */
+typedef enum {
+  PBM_BATCH_LOAD = 0, ///< Load the image from the path
+  PBM_BATCH_SAVE      ///< Save the image on the path
+} pbm_batchOperation;
+
+/**
+ * @brief Implementation of a batch
+ *
+ * With io_uring the files are opened, read and written by the kernel, but
+ * the loaded files are decoded and the saved images encoded by the thread
+ * calling pbm_submitBatch, pbm_pollBatch, pbm_waitBatch or pbm_closeBatch.
+ * The workers of the thread pool decode and encode in parallel.
+ */
+typedef enum {
+  PBM_BATCH_AUTO = 0, ///< io_uring if available, threads otherwise
+  PBM_BATCH_URING,    ///< Linux io_uring, driven by the calling thread
+  PBM_BATCH_THREADS   ///< Pool of threads with blocking IO
+} pbm_batchBackend;
+
+/**
+ * @brief Load or save request
+ *
+ * The request and its path are owned by the caller and must stay valid until
+ * the request is completed.
+ */
+typedef struct {
+  pbm_batchOperation operation;     ///< Load or save
+  const char *path;                 ///< Path of the image
+  pbm_image image;                  ///< Loaded image or image to save
+  pbm_format format;                ///< Format of a saved image
+  const pbm_conversion *conversion; ///< Conversion of a loaded PGM or PPM
+                                    ///< image, NULL to load only PBM images
+  pbm_return result;                ///< State of the completed request
+  void *user;                       ///< Data of the caller
+} pbm_batchRequest;
+
+/**
+ * @brief Queue of asynchronous load and save requests
+ *
+ */
+typedef struct {
+  pbm_batchBackend backend; ///< Used implementation
+  uint32_t depth;           ///< Maximum number of requests in flight
+  void *state;              ///< Queues, buffers and the ring or the threads
+} pbm_batch;
+
+/**
+ * @brief Open a batch
+ *
+ * Every request in flight reuses a file buffer of the batch. Release the
+ * batch with pbm_closeBatch.
+ *
+ * @param batch the opened batch
+ * @param depth the maximum number of requests in flight, 1 - 4096, the
+ * thread backend has at most PBM_BATCH_MAX_THREADS requests in flight
+ * @param backend the implementation, PBM_ERROR if it is not available
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_openBatch(pbm_batch *batch, uint32_t depth,
+                         pbm_batchBackend backend);
+
+/**
+ * @brief Complete all submitted requests and release the batch
+ *
+ * Images loaded by requests that were not polled must still be freed.
+ *
+ * @param batch the batch to close
+ */
+void pbm_closeBatch(pbm_batch *batch);
+
+/**
+ * @brief Submit load and save requests
+ *
+ * Loaded images are created on the heap like with pbm_loadImage. Saved
+ * images must be in the PBM_DATA_HORIZONTAL_MSB alignment and stay unchanged
+ * until the request is completed.
+ *
+ * @param batch the batch
+ * @param requests the requests to submit
+ * @param count the number of requests
+ * @return pbm_return state, no request is queued on an argument or memory
+ * error. On PBM_OK all requests are queued, a failed io_uring submission is
+ * returned by the next pbm_pollBatch or pbm_waitBatch.
+ */
+pbm_return pbm_submitBatch(pbm_batch *batch, pbm_batchRequest *requests,
+                           size_t count);
+
+/**
+ * @brief Get completed requests without blocking
+ *
+ * @param batch the batch
+ * @param completed the completed requests
+ * @param maximum the size of the completed array
+ * @param count the number of completed requests
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_pollBatch(pbm_batch *batch, pbm_batchRequest **completed,
+                         size_t maximum, size_t *count);
+
+/**
+ * @brief Wait for completed requests
+ *
+ * Blocks until at least one request is completed. The count is 0 if no
+ * request is left.
+ *
+ * @param batch the batch
+ * @param completed the completed requests
+ * @param maximum the size of the completed array
+ * @param count the number of completed requests
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_waitBatch(pbm_batch *batch, pbm_batchRequest **completed,
+                         size_t maximum, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBM_BATCH_H */
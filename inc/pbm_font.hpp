@@ -0,0 +1,385 @@
+/**
+ * @file pbm_font.hpp
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Compile time font transcoding for C++17
+ *
+ * Converts a raw font array at compile time into the bit order of another
+ * alignment or into a packed font, together with the ink boxes of the
+ * glyphs. The results are constexpr variables in read-only storage, so only
+ * one font header is needed and nothing is converted at start up.
+ *
+ * The raw font array has to be usable in constant expressions, the font
+ * headers declare it with PBM_FONT_DATA (constexpr in C++).
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_FONT_HPP
+#define PBM_FONT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "pbm_fontHandler.h"
+#include "pbm_types.h"
+
+namespace pbm {
+
+namespace detail {
+
+constexpr uint32_t fontBitsPerByte = 8;   ///< Pixels per font data byte
+
+/**
+ * @brief Bytes of a font line
+ *
+ * @param width the font width
+ * @return uint32_t the number of bytes
+ */
+constexpr uint32_t fontRowBytes(uint32_t width) {
+  return (width + fontBitsPerByte - 1) / fontBitsPerByte;
+}
+
+/**
+ * @brief Column of a bit in a font line
+ *
+ * Font lines are little endian values with the first pixel on the highest bit
+ * (MSB) or on the lowest bit after the padding (LSB).
+ *
+ * @param bit the bit in the line value
+ * @param width the font width
+ * @param lsb the font is stored in the LSB alignment
+ * @return uint32_t the column, the width for a padding bit
+ */
+constexpr uint32_t bitColumn(uint32_t bit, uint32_t width, bool lsb) {
+  const uint32_t padding = fontRowBytes(width) * fontBitsPerByte - width;
+  if (lsb) {
+    return (bit < padding) ? width : bit - padding;
+  }
+  return (bit < width) ? width - 1 - bit : width;
+}
+
+/**
+ * @brief Bit of a column in a font line
+ *
+ * @param column the column
+ * @param width the font width
+ * @param lsb the font is stored in the LSB alignment
+ * @return uint32_t the bit in the line value
+ */
+constexpr uint32_t columnBit(uint32_t column, uint32_t width, bool lsb) {
+  const uint32_t padding = fontRowBytes(width) * fontBitsPerByte - width;
+  return lsb ? column + padding : width - 1 - column;
+}
+
+/**
+ * @brief Read a pixel of a glyph
+ *
+ * @param glyph the glyph bytes
+ * @param width the font width
+ * @param line the line
+ * @param column the column
+ * @param lsb the font is stored in the LSB alignment
+ * @return true for a set pixel
+ */
+constexpr bool glyphPixel(const unsigned char *glyph, uint32_t width,
+                          uint32_t line, uint32_t column, bool lsb) {
+  const uint32_t bit = columnBit(column, width, lsb);
+  return 0 != ((glyph[line * fontRowBytes(width) + bit / fontBitsPerByte] >>
+                (bit % fontBitsPerByte)) &
+               1u);
+}
+
+/**
+ * @brief Compute the ink box of a glyph like pbm_computeGlyphBoxes
+ *
+ * @param glyph the glyph bytes
+ * @param width the font width
+ * @param height the font height
+ * @param lsb the font is stored in the LSB alignment
+ * @return pbm_glyphBox the ink box, xMin > xMax for an empty glyph
+ */
+constexpr pbm_glyphBox inkBox(const unsigned char *glyph, uint32_t width,
+                              uint32_t height, bool lsb) {
+  pbm_glyphBox box = {UINT8_MAX, UINT8_MAX, 0, 0};
+  const uint32_t rowBytes = fontRowBytes(width);
+  for (uint32_t line = 0; line < height; line++) {
+    for (uint32_t i = 0; i < rowBytes; i++) {
+      const uint8_t value = glyph[line * rowBytes + i];
+      // Only the bytes with set pixels are examined
+      for (uint32_t bit = 0; 0 != value && bit < fontBitsPerByte; bit++) {
+        const uint32_t column =
+            bitColumn(i * fontBitsPerByte + bit, width, lsb);
+        if (0 == ((value >> bit) & 1u) || column >= width) {
+          continue;
+        }
+        box.xMin = (column < box.xMin) ? (uint8_t)column : box.xMin;
+        box.xMax = (column > box.xMax) ? (uint8_t)column : box.xMax;
+        box.yMin = (line < box.yMin) ? (uint8_t)line : box.yMin;
+        box.yMax = (uint8_t)line;
+      }
+    }
+  }
+  return box;
+}
+
+/**
+ * @brief Compare two lines of a glyph
+ *
+ * @param glyph the glyph bytes
+ * @param rowBytes bytes of a line
+ * @param a the first line
+ * @param b the second line
+ * @return true for equal lines
+ */
+constexpr bool equalLines(const unsigned char *glyph, uint32_t rowBytes,
+                          uint32_t a, uint32_t b) {
+  for (uint32_t i = 0; i < rowBytes; i++) {
+    if (glyph[a * rowBytes + i] != glyph[b * rowBytes + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Pack a glyph like pbm_packFont
+ *
+ * @param glyph the glyph bytes
+ * @param box the ink box of the glyph
+ * @param width the font width
+ * @param lsb the font is stored in the LSB alignment
+ * @param data output packed data or nullptr to measure
+ * @return uint32_t number of packed bytes
+ */
+constexpr uint32_t packGlyph(const unsigned char *glyph,
+                             const pbm_glyphBox &box, uint32_t width, bool lsb,
+                             unsigned char *data) {
+  if (box.xMin > box.xMax) {
+    return 0;
+  }
+  // Line records: 1 bit repeat flag (0) or new line (1) with the box bits
+  const uint32_t boxWidth = box.xMax - box.xMin + 1u;
+  const uint32_t rowBytes = fontRowBytes(width);
+  uint32_t bit = 0;
+  uint32_t previous = box.yMin;
+  for (uint32_t line = box.yMin; line <= box.yMax; line++) {
+    if (line > box.yMin && equalLines(glyph, rowBytes, line, previous)) {
+      bit++;
+      continue;
+    }
+    previous = line;
+    if (nullptr == data) {
+      bit += boxWidth + 1;
+      continue;
+    }
+    for (uint32_t i = 0; i <= boxWidth; i++, bit++) {
+      if (0 == i || glyphPixel(glyph, width, line, box.xMin + i - 1, lsb)) {
+        data[bit / fontBitsPerByte] |=
+            (unsigned char)(0x80u >> (bit % fontBitsPerByte));
+      }
+    }
+  }
+  return (bit + fontBitsPerByte - 1) / fontBitsPerByte;
+}
+
+} // namespace detail
+
+/**
+ * @brief Font converted at compile time
+ *
+ * @tparam Glyphs number of glyphs
+ * @tparam DataSize size of the glyph data
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Alignment alignment of the glyph data
+ * @tparam Encoding storage format of the glyph data
+ */
+template <size_t Glyphs, size_t DataSize, uint8_t Width, uint8_t Height,
+          pbm_data_alignment Alignment, pbm_fontEncoding Encoding>
+struct compiledFont {
+  unsigned char data[DataSize] = {}; ///< Glyph data
+  pbm_glyphBox boxes[Glyphs] = {};   ///< Ink boxes of the glyphs
+  uint32_t offsets[(PBM_FONT_PACKED == Encoding) ? Glyphs : 1] =
+      {}; ///< Byte offsets of the packed glyphs
+
+  /**
+   * @brief Get the font handler of the converted font
+   *
+   * @return pbm_font the font handler with the ink boxes
+   */
+  constexpr pbm_font font() const {
+    return pbm_font{data,
+                    Width,
+                    Height,
+                    Alignment,
+                    boxes,
+                    Encoding,
+                    (PBM_FONT_PACKED == Encoding) ? offsets : nullptr,
+                    nullptr,
+                    nullptr,
+                    0,
+                    nullptr,
+                    0,
+                    0,
+                    nullptr};
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief Convert a raw font into the bit order of another alignment
+ *
+ * @tparam Target alignment of the converted font
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Source alignment of the raw font
+ * @tparam Glyphs number of glyphs
+ * @tparam GlyphBytes bytes per glyph
+ * @param raw the raw font
+ * @return the converted font
+ */
+template <pbm_data_alignment Target, uint8_t Width, uint8_t Height,
+          pbm_data_alignment Source, size_t Glyphs, size_t GlyphBytes>
+constexpr auto transcode(const unsigned char (&raw)[Glyphs][GlyphBytes]) {
+  static_assert(GlyphBytes == fontRowBytes(Width) * Height,
+                "font size does not match the raw font array");
+  compiledFont<Glyphs, Glyphs * GlyphBytes, Width, Height, Target,
+               PBM_FONT_BITMAP>
+      font;
+  const bool lsb = (PBM_DATA_HORIZONTAL_LSB == Source);
+  const bool targetLsb = (PBM_DATA_HORIZONTAL_LSB == Target);
+  const uint32_t rowBytes = fontRowBytes(Width);
+  for (size_t glyph = 0; glyph < Glyphs; glyph++) {
+    const pbm_glyphBox box = inkBox(raw[glyph], Width, Height, lsb);
+    font.boxes[glyph] = box;
+    if (lsb == targetLsb) {
+      for (size_t i = 0; i < GlyphBytes; i++) {
+        font.data[glyph * GlyphBytes + i] = raw[glyph][i];
+      }
+      continue;
+    }
+    // Only the ink box can contain set pixels
+    for (uint32_t line = box.yMin; box.xMin <= box.xMax && line <= box.yMax;
+         line++) {
+      unsigned char *dst = &font.data[glyph * GlyphBytes + line * rowBytes];
+      for (uint32_t column = box.xMin; column <= box.xMax; column++) {
+        if (glyphPixel(raw[glyph], Width, line, column, lsb)) {
+          const uint32_t bit = columnBit(column, Width, targetLsb);
+          dst[bit / fontBitsPerByte] |=
+              (unsigned char)(1u << (bit % fontBitsPerByte));
+        }
+      }
+    }
+  }
+  return font;
+}
+
+/**
+ * @brief Size of a raw font packed like pbm_packFont
+ *
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Source alignment of the raw font
+ * @tparam Glyphs number of glyphs
+ * @tparam GlyphBytes bytes per glyph
+ * @param raw the raw font
+ * @return size_t the packed size, at least 1
+ */
+template <uint8_t Width, uint8_t Height, pbm_data_alignment Source,
+          size_t Glyphs, size_t GlyphBytes>
+constexpr size_t packedSize(const unsigned char (&raw)[Glyphs][GlyphBytes]) {
+  size_t bytes = 0;
+  for (size_t glyph = 0; glyph < Glyphs; glyph++) {
+    const bool lsb = (PBM_DATA_HORIZONTAL_LSB == Source);
+    bytes += packGlyph(raw[glyph], inkBox(raw[glyph], Width, Height, lsb),
+                       Width, lsb, nullptr);
+  }
+  return (0 == bytes) ? 1 : bytes;
+}
+
+/**
+ * @brief Pack a raw font like pbm_packFont
+ *
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Source alignment of the raw font
+ * @tparam DataSize the packed size
+ * @tparam Glyphs number of glyphs
+ * @tparam GlyphBytes bytes per glyph
+ * @param raw the raw font
+ * @return the packed font
+ */
+template <uint8_t Width, uint8_t Height, pbm_data_alignment Source,
+          size_t DataSize, size_t Glyphs, size_t GlyphBytes>
+constexpr auto pack(const unsigned char (&raw)[Glyphs][GlyphBytes]) {
+  static_assert(GlyphBytes == fontRowBytes(Width) * Height,
+                "font size does not match the raw font array");
+  compiledFont<Glyphs, DataSize, Width, Height, PBM_DATA_HORIZONTAL_MSB,
+               PBM_FONT_PACKED>
+      font;
+  const bool lsb = (PBM_DATA_HORIZONTAL_LSB == Source);
+  uint32_t bytes = 0;
+  for (size_t glyph = 0; glyph < Glyphs; glyph++) {
+    font.boxes[glyph] = inkBox(raw[glyph], Width, Height, lsb);
+    font.offsets[glyph] = bytes;
+    bytes += packGlyph(raw[glyph], font.boxes[glyph], Width, lsb,
+                       &font.data[bytes]);
+  }
+  return font;
+}
+
+} // namespace detail
+
+/**
+ * @brief Raw font converted at compile time to the target alignment, with the
+ * ink boxes of the glyphs
+ *
+ * Usage: constexpr pbm_font font = pbm::transcodedFont<font_6x8H_MSB, 6, 8,
+ * PBM_DATA_HORIZONTAL_MSB, PBM_DATA_HORIZONTAL_LSB>.font();
+ *
+ * @tparam Raw the raw font array
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Source alignment of the raw font
+ * @tparam Target alignment of the converted font
+ */
+template <const auto &Raw, uint8_t Width, uint8_t Height,
+          pbm_data_alignment Source, pbm_data_alignment Target>
+inline constexpr auto transcodedFont =
+    detail::transcode<Target, Width, Height, Source>(Raw);
+
+/**
+ * @brief Raw font packed at compile time (see pbm_packFont)
+ *
+ * @tparam Raw the raw font array
+ * @tparam Width font width
+ * @tparam Height font height
+ * @tparam Source alignment of the raw font
+ */
+template <const auto &Raw, uint8_t Width, uint8_t Height,
+          pbm_data_alignment Source>
+inline constexpr auto packedFont =
+    detail::pack<Width, Height, Source,
+                 detail::packedSize<Width, Height, Source>(Raw)>(Raw);
+
+} // namespace pbm
+
+#endif /* PBM_FONT_HPP */
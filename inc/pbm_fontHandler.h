@@ -30,14 +30,105 @@ extern "C" {
 #include "pbm_types.h"
 
 /**
- * @brief PBM font handler
+ * @brief Declaration of the font data arrays in the font headers
+ *
+ * The arrays are constexpr in C++ to convert them at compile time (see
+ * pbm_font.hpp).
+ */
+#ifdef __cplusplus
+#define PBM_FONT_DATA constexpr unsigned char
+#else
+#define PBM_FONT_DATA const unsigned char
+#endif
+
+/**
+ * @brief Storage format of the font glyphs
+ *
+ */
+typedef enum {
+  PBM_FONT_BITMAP = 0, ///< Every glyph is a full bitmap of the font cell
+  PBM_FONT_PACKED      ///< Every glyph stores only its ink box, without line
+                       ///< padding and with repeated lines marked by one bit
+} pbm_fontEncoding;
+
+/**
+ * @brief Ink bounding box of a glyph inside its font cell
+ *
+ * A glyph without any set pixel is marked with xMin > xMax.
+ */
+typedef struct {
+  uint8_t xMin; ///< First column with a set pixel
+  uint8_t yMin; ///< First line with a set pixel
+  uint8_t xMax; ///< Last column with a set pixel
+  uint8_t yMax; ///< Last line with a set pixel
+} pbm_glyphBox;
+
+/**
+ * @brief Horizontal metrics of a glyph in a proportional font
  *
+ * Only the columns from leftBearing up to leftBearing + advance of the glyph
+ * cell are drawn. The pen moves by advance and the character gap to the next
+ * glyph.
  */
 typedef struct {
+  uint8_t leftBearing; ///< First column of the glyph cell which is drawn
+  uint8_t advance;     ///< Drawn columns of the glyph from the left bearing
+  uint8_t inkWidth;    ///< Columns from the left bearing to the last set pixel
+} pbm_glyphMetrics;
+
+/**
+ * @brief Kerning correction between two glyphs
+ *
+ * Kerning tables have to be sorted by left and then by right glyph.
+ */
+typedef struct {
+  uint16_t left;  ///< Glyph index of the first character
+  uint16_t right; ///< Glyph index of the following character
+  int8_t offset;  ///< Additional pen movement in pixel (negative moves closer)
+} pbm_kerningPair;
+
+/**
+ * @brief Range of consecutive codepoints with consecutive glyphs
+ *
+ * Glyph maps have to be sorted by the first codepoint without overlapping
+ * ranges. The first range is looked up directly and should contain the most
+ * used characters (e.g. ASCII).
+ */
+typedef struct {
+  uint32_t first; ///< First codepoint of the range
+  uint16_t count; ///< Number of codepoints in the range
+  uint16_t glyph; ///< Glyph index of the first codepoint
+} pbm_glyphRange;
+
+/**
+ * @brief PBM font handler
+ *
+ * The optional members can be left zero initialized for a fixed width font.
+ */
+typedef struct pbm_font {
   const unsigned char *fontData; ///< Font structure represented in bytes
   uint8_t width;                 ///< Font width
   uint8_t height;                ///< Font height
   pbm_data_alignment alignment;  ///< Data alignment of the the font structure
+  const pbm_glyphBox *glyphBoxes; ///< Optional ink boxes of all glyphs (see
+                                  ///< pbm_computeGlyphBoxes) or NULL,
+                                  ///< required for packed fonts
+  pbm_fontEncoding encoding;      ///< Storage format of fontData
+  const uint32_t *glyphOffsets;   ///< Byte offsets of the glyphs in fontData
+                                  ///< for packed fonts (see pbm_packFont)
+  const pbm_glyphMetrics *metrics; ///< Optional proportional metrics of all
+                                   ///< glyphs or NULL for a fixed width
+  const pbm_kerningPair *kerning;  ///< Optional sorted kerning table or NULL
+  uint16_t kerningCount;           ///< Number of kerning pairs
+  const pbm_glyphRange *glyphMap;  ///< Optional sparse codepoint to glyph
+                                   ///< map for UTF-8 strings or NULL for 8
+                                   ///< bit strings (character = glyph)
+  uint16_t glyphMapCount;          ///< Number of glyph map ranges
+  uint16_t defaultGlyph;           ///< Glyph of codepoints outside of the map
+  const struct pbm_font *const *rotations; ///< Optional fonts rotated by 90,
+                                           ///< 180 and 270 degree clockwise
+                                           ///< for rotated text (see
+                                           ///< pbm_rotateFont) or NULL
 } pbm_font;
 
 #ifdef __cplusplus
@@ -0,0 +1,100 @@
+/**
+ * @file pbm_fontLoader.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Load BDF and PSF fonts at runtime as pbm_font
+ *
+ * The font files are mapped into the memory. PSF glyphs with 8 pixel width
+ * are used directly from the mapped file for the PBM_DATA_HORIZONTAL_MSB
+ * alignment, all other fonts are converted into one allocation with the
+ * glyphs and tables.
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_FONTLOADER_H
+#define PBM_FONTLOADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pbm_fontHandler.h"
+#include "pbm_types.h"
+
+/**
+ * @brief Font loaded from a file with the owned memory
+ *
+ */
+typedef struct {
+  pbm_font font;      ///< The usable font
+  void *memory;       ///< Allocation of the glyphs and tables or NULL
+  void *mapping;      ///< Mapped font file for zero copy glyphs or NULL
+  size_t mappingSize; ///< Size of the mapped font file
+} pbm_loadedFont;
+
+/**
+ * @brief Load a PSF1 or PSF2 console font
+ *
+ * A unicode table of the font is loaded as glyph map (UTF-8 strings).
+ * Fonts without a table and up to 256 glyphs use 8 bit strings, characters
+ * beyond the glyphs of the font are empty.
+ * Release the font with pbm_unloadFont.
+ *
+ * @param fontPath the path to the PSF font
+ * @param alignment PBM_DATA_HORIZONTAL_MSB or PBM_DATA_HORIZONTAL_LSB
+ * @param loadedFont the loaded font
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_loadFontPSF(const char *fontPath,
+                           pbm_data_alignment alignment,
+                           pbm_loadedFont *loadedFont);
+
+/**
+ * @brief Load a BDF font
+ *
+ * The glyphs are placed in a cell of the font bounding box. Fonts with
+ * encodings up to 255 use 8 bit strings and the encoding as glyph index,
+ * fonts with larger encodings use a glyph map (UTF-8 strings).
+ * Glyphs with another device width than the cell get proportional metrics.
+ * Release the font with pbm_unloadFont.
+ *
+ * @param fontPath the path to the BDF font
+ * @param alignment PBM_DATA_HORIZONTAL_MSB or PBM_DATA_HORIZONTAL_LSB
+ * @param loadedFont the loaded font
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_loadFontBDF(const char *fontPath,
+                           pbm_data_alignment alignment,
+                           pbm_loadedFont *loadedFont);
+
+/**
+ * @brief Release the memory of a loaded font
+ *
+ * @param loadedFont the font to release
+ */
+void pbm_unloadFont(pbm_loadedFont *loadedFont);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBM_FONTLOADER_H */
@@ -38,6 +38,7 @@ extern "C" {
 #include "pbm_fontHandler.h"
 #include "pbm_types.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -46,6 +47,20 @@ extern "C" {
  */
 #define PBM_IMAGE_END UINT32_MAX
 
+#ifdef PBM_FIXED_ALIGNMENT
+/**
+ * @brief Fixed data alignment of all images
+ *
+ * When PBM_FIXED_ALIGNMENT is defined at compile time to one of the
+ * pbm_dataAlignment values, the graphics functions are specialised to this
+ * alignment and ignore the alignment stored in the image. Every image passed
+ * to the library must then use this alignment. Font and bitmap alignments are
+ * not affected.
+ *
+ */
+#define PBM_IMAGE_ALIGNMENT (PBM_FIXED_ALIGNMENT)
+#endif
+
 /**
  * @brief Alignment of the string to the given position
  *
@@ -59,9 +74,168 @@ typedef enum {
   PBM_STRING_RIGHT_CENTER,
   PBM_STRING_LEFT_BOTTOM,
   PBM_STRING_CENTER_BOTTOM,
-  PBM_STRING_RIGHT_BOTTOM
+  PBM_STRING_RIGHT_BOTTOM,
+  PBM_STRING_JUSTIFY_TOP,    ///< Text box lines fill the box width
+  PBM_STRING_JUSTIFY_CENTER, ///< Text box lines fill the box width
+  PBM_STRING_JUSTIFY_BOTTOM  ///< Text box lines fill the box width
 } pbm_stringAlignment;
 
+/**
+ * @brief Line breaking of the text box
+ *
+ */
+typedef enum {
+  PBM_WRAP_NONE = 0, ///< Lines are only broken at newlines and clipped
+  PBM_WRAP_WORD,     ///< Lines are broken between words if possible
+  PBM_WRAP_CHARACTER ///< Lines are broken at any character
+} pbm_wrapMode;
+
+/**
+ * @brief Maximum number of lines in a text box
+ *
+ */
+#define PBM_TEXTBOX_MAX_LINES (64)
+
+/**
+ * @brief Line of a text box layout
+ *
+ */
+typedef struct {
+  uint32_t start;   ///< Index of the first character in the text
+  uint32_t length;  ///< Number of characters without trailing spaces
+  uint32_t width;   ///< Width of the line in pixel
+  uint16_t spaces;  ///< Number of spaces inside the line
+  uint8_t lastLine; ///< Last line of a paragraph (never justified)
+} pbm_textLine;
+
+/**
+ * @brief Cached line breaks of a text box
+ *
+ * The cache is reused as long as the text, the font, the box size and the
+ * wrap mode are not changed. A zero initialized cache is empty.
+ *
+ * The text content is hashed on every draw to detect a changed text behind
+ * the same pointer. A caller which edits the text only through its own code
+ * can set skipTextHash and call pbm_invalidateTextBox after every edit.
+ */
+typedef struct {
+  const char *text;      ///< The laid out text
+  uint32_t textHash;     ///< Hash of the text content
+  uint8_t skipTextHash;  ///< Trust the text pointer, don't hash the text
+  const pbm_font *font;  ///< Font of the layout
+  uint32_t boxWidth;     ///< Width of the text box in unscaled font pixels
+  uint32_t boxHeight;    ///< Height of the text box in unscaled font pixels
+  pbm_wrapMode wrapMode; ///< Wrap mode of the layout
+  uint32_t lineCount;    ///< Number of valid lines
+  pbm_textLine lines[PBM_TEXTBOX_MAX_LINES]; ///< Line breaks of the text
+} pbm_textBoxCache;
+
+#define PBM_TEXT_SCALE_MAX (8) ///< Maximal integer scale factor of text
+
+/**
+ * @brief Drawing mode of the text
+ *
+ */
+typedef enum {
+  PBM_TEXT_OPAQUE = 0, ///< The whole glyph cell is drawn, unset glyph pixels
+                       ///< with the inverted color
+  PBM_TEXT_TRANSPARENT ///< Only the set glyph pixels are drawn
+} pbm_textMode;
+
+/**
+ * @brief Clockwise rotation of the text
+ *
+ */
+typedef enum {
+  PBM_ROTATE_0 = 0, ///< Upright text
+  PBM_ROTATE_90,    ///< Text from top to bottom
+  PBM_ROTATE_180,   ///< Upside down text from right to left
+  PBM_ROTATE_270    ///< Text from bottom to top
+} pbm_textRotation;
+
+/**
+ * @brief Emphasis flags of the text, derived from the regular font
+ *
+ */
+typedef enum {
+  PBM_TEXT_BOLD = 0x01,      ///< Every glyph line combined with itself shifted
+                             ///< by one pixel to the right
+  PBM_TEXT_ITALIC = 0x02,    ///< Glyph lines progressively shifted from the
+                             ///< left at the bottom to the right at the top
+  PBM_TEXT_UNDERLINE = 0x04, ///< Filled bottom line of the glyph cells
+  PBM_TEXT_STRIKE = 0x08     ///< Filled middle line of the glyph cells
+} pbm_textEmphasis;
+
+/**
+ * @brief Style options to write text
+ *
+ * A NULL style is equal to a zero initialized style.
+ * Scaled text is the unscaled text with every pixel drawn as a square of
+ * scale x scale pixels, including the character and line gaps.
+ * Rotated text is drawn with the pre-rotated fonts of the font (see
+ * pbm_rotateFont). The position and the alignment of rotated strings refer to
+ * the box around the rotated string.
+ * The emphasis stays inside the glyph cells. Italic lines are shifted at most
+ * up to the border of the drawn columns, bold pixels shifted out of a cell
+ * are cut. Underline and strike also fill the gaps between the characters.
+ * Emphasized text has to be upright.
+ */
+typedef struct {
+  pbm_textMode mode; ///< Drawing mode of the glyphs
+  uint8_t scale;     ///< Integer scale factor up to PBM_TEXT_SCALE_MAX, 0 and
+                     ///< 1 draw the font in its original size
+  uint8_t smooth;    ///< Smooth the diagonal edges of even scaled glyphs with
+                     ///< the Scale2x (EPX) rules
+  pbm_textRotation rotation; ///< Rotation of the text, text boxes have to be
+                             ///< upright
+  uint8_t emphasis;          ///< Combination of pbm_textEmphasis flags
+} pbm_textStyle;
+
+/**
+ * @brief Measured size of a string
+ *
+ * All values are in pixel relative to the top left corner of the string.
+ */
+typedef struct {
+  uint32_t width;     ///< Width of the string cells
+  uint32_t height;    ///< Height of the string cells
+  uint32_t inkX;      ///< First column with a set pixel
+  uint32_t inkY;      ///< First line with a set pixel
+  uint32_t inkWidth;  ///< Width of the set pixels, 0 if nothing is set
+  uint32_t inkHeight; ///< Height of the set pixels, 0 if nothing is set
+} pbm_textExtent;
+
+/**
+ * @brief Measured string which can be drawn several times
+ *
+ * The string is not copied and must be valid as long as the layout is used.
+ */
+typedef struct {
+  const pbm_font *font;  ///< Font of the measured string
+  const char *msg;       ///< The measured C string
+  uint32_t length;       ///< Number of characters in the string
+  pbm_textExtent extent; ///< Measured size of the string
+} pbm_textLayout;
+
+/**
+ * @brief Pre-rotated fonts of an upright font (see pbm_addFontRotations)
+ *
+ * The structure must be valid as long as the upright font is used.
+ */
+typedef struct {
+  pbm_font fonts[3];        ///< Fonts rotated by 90, 180 and 270 degree
+  const pbm_font *table[3]; ///< Rotation table of the upright font
+} pbm_fontRotations;
+
+/**
+ * @brief Compute the number of data bytes of an image in its alignment
+ *
+ * @param imageHandler the image to measure
+ * @param size the number of data bytes, set on success
+ * @return pbm_return state, PBM_SIZE if the size does not fit into size_t
+ */
+pbm_return pbm_imageDataSize(const pbm_image *imageHandler, size_t *size);
+
 /**
  * @brief Fill the full image to the desired color
  *
@@ -91,6 +265,43 @@ pbm_return pbm_invertColor(pbm_image *imageHandler);
 pbm_return
 pbm_setPixel(pbm_image *imageHandler, uint32_t x, uint32_t y, pbm_colors color);
 
+/**
+ * @brief set several pixels in the image to the desired color
+ *
+ * The arguments are validated once for the whole batch. Consecutive points
+ * which land in the same data byte are merged into a single read-modify-write
+ * operation, so sorted point clouds (see pbm_sortPoints) are written byte by
+ * byte instead of pixel by pixel. Points outside the image are skipped.
+ *
+ * @param imageHandler the image to set the pixels
+ * @param points array of points, PBM_IMAGE_END is allowed per coordinate
+ * @param count number of points in the array
+ * @param color the desired color
+ * @return pbm_return state, PBM_OUT_OF_RANGE if at least one point was skipped
+ */
+pbm_return pbm_setPixels(pbm_image *imageHandler,
+                         const pbm_point *points,
+                         uint32_t count,
+                         pbm_colors color);
+
+/**
+ * @brief sort points in the order of their data bytes in the image
+ *
+ * Optional preparation for pbm_setPixels to get the maximum of merged byte
+ * accesses for unordered point clouds. Sorting costs far more than a single
+ * plot of the cloud, only sort clouds which are drawn many times.
+ * PBM_IMAGE_END coordinates are replaced by the last column or row of the
+ * image.
+ *
+ * @param imageHandler the image which defines the data alignment
+ * @param points array of points to sort in place
+ * @param count number of points in the array
+ * @return pbm_return state
+ */
+pbm_return pbm_sortPoints(const pbm_image *imageHandler,
+                          pbm_point *points,
+                          uint32_t count);
+
 /**
  * @brief draw a line in the image
  *
@@ -125,6 +336,54 @@ pbm_return pbm_drawCircle(pbm_image *imageHandler,
                           uint32_t radius,
                           pbm_colors color);
 
+/**
+ * @brief Draw a bitmap aligned to a position into the image
+ *
+ * Set bitmap pixels are drawn in the color, unset pixels with the inverted
+ * color or, if transparent, not at all. The bitmap is clipped to the image.
+ * Bitmaps in the PBM_DATA_HORIZONTAL_MSB and PBM_DATA_HORIZONTAL_LSB
+ * alignment are copied line by line, vertical bitmaps in the alignment of the
+ * image page by page. Vertical bitmaps in another alignment than the image are
+ * read pixel by pixel.
+ *
+ * @param imageHandler the image to draw the bitmap
+ * @param x position in x
+ * @param y position in y
+ * @param color the desired color
+ * @param alignment alignment of the bitmap to the position, justified is left
+ * @param bitmap the bitmap to draw
+ * @param mode drawing mode of the unset bitmap pixels
+ * @return pbm_return state
+ */
+pbm_return pbm_drawBitmap(pbm_image *const imageHandler,
+                          const uint32_t x,
+                          const uint32_t y,
+                          pbm_colors color,
+                          pbm_stringAlignment alignment,
+                          const pbm_image *bitmap,
+                          pbm_textMode mode);
+
+/**
+ * @brief Scroll the pixels of a rectangle in the image
+ *
+ * The pixels are moved by dx to the right and dy to the bottom, negative
+ * values move them to the left and the top. Pixels moved out of the
+ * rectangle are lost, the uncovered pixels are filled with the fill color.
+ *
+ * @param imageHandler the image to scroll
+ * @param rect the scrolled rectangle, clipped to the image, or NULL for the
+ * whole image
+ * @param dx horizontal distance in pixel
+ * @param dy vertical distance in pixel
+ * @param fill the color of the uncovered pixels
+ * @return pbm_return state
+ */
+pbm_return pbm_scroll(pbm_image *imageHandler,
+                      const pbm_rect *rect,
+                      int32_t dx,
+                      int32_t dy,
+                      pbm_colors fill);
+
 /**
  * @brief Write a character with the given font into the image
  *
@@ -143,11 +402,60 @@ pbm_return pbm_writeChar(pbm_image *const imageHandler,
                          const pbm_font *font,
                          const uint8_t character);
 
+/**
+ * @brief Write a character with the given font and style into the image
+ *
+ * In transparent mode, only the ink box of the glyph is visited if the font
+ * has precomputed glyph boxes.
+ *
+ * @param imageHandler the image to write a character
+ * @param x start position on the top left corner in x
+ * @param y start position on the top left corner in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param style the text style or NULL for the default style
+ * @param character the desired character from the font
+ * @return pbm_return state
+ */
+pbm_return pbm_writeCharStyled(pbm_image *const imageHandler,
+                               const uint32_t x,
+                               const uint32_t y,
+                               pbm_colors color,
+                               const pbm_font *font,
+                               const pbm_textStyle *style,
+                               const uint8_t character);
+
+/**
+ * @brief Write a unicode character with the given font and style into the
+ * image
+ *
+ * The codepoint is mapped with the glyph map of the font. Fonts without glyph
+ * map use the codepoint as glyph index (0 - 255).
+ *
+ * @param imageHandler the image to write a character
+ * @param x start position on the top left corner in x
+ * @param y start position on the top left corner in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param style the text style or NULL for the default style
+ * @param codepoint the unicode codepoint of the character
+ * @return pbm_return state
+ */
+pbm_return pbm_writeCodepoint(pbm_image *const imageHandler,
+                              const uint32_t x,
+                              const uint32_t y,
+                              pbm_colors color,
+                              const pbm_font *font,
+                              const pbm_textStyle *style,
+                              const uint32_t codepoint);
+
 /**
  * @brief Write a string on one with the given font into the image
  *
  * The string must be a C character string and be mapped to the given font.
- * The gap between the character is fix with 2 pixels
+ * Fonts with a glyph map are written with UTF-8 strings.
+ * The gap between the character is fix with 1 pixel. Proportional fonts
+ * advance by the glyph metrics and the kerning table of the font.
  *
  * @param imageHandler the image to write a string
  * @param x start position on the top left corner in x
@@ -166,6 +474,290 @@ pbm_return pbm_writeString(pbm_image *const imageHandler,
                            pbm_stringAlignment textAlignment,
                            const char *msg);
 
+/**
+ * @brief Write a string on one line with the given font and style into the
+ * image
+ *
+ * @param imageHandler the image to write a string
+ * @param x start position in x
+ * @param y start position in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param textAlignment alignment of the string to the start position
+ * @param style the text style or NULL for the default style
+ * @param msg the C string to write to the image
+ * @return pbm_return state
+ */
+pbm_return pbm_writeStringStyled(pbm_image *const imageHandler,
+                                 const uint32_t x,
+                                 const uint32_t y,
+                                 pbm_colors color,
+                                 const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 const pbm_textStyle *style,
+                                 const char *msg);
+
+/**
+ * @brief Write a character scaled by an integer factor into the image
+ *
+ * Every glyph pixel is drawn as a square of scale x scale pixels.
+ *
+ * @param imageHandler the image to write a character
+ * @param x start position on the top left corner in x
+ * @param y start position on the top left corner in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param scale the scale factor (1 - PBM_TEXT_SCALE_MAX)
+ * @param character the character to write
+ * @return pbm_return state
+ */
+pbm_return pbm_writeCharScaled(pbm_image *const imageHandler,
+                               const uint32_t x,
+                               const uint32_t y,
+                               pbm_colors color,
+                               const pbm_font *font,
+                               uint8_t scale,
+                               const uint8_t character);
+
+/**
+ * @brief Write a string scaled by an integer factor on one line into the image
+ *
+ * The string and the character gaps are scaled with the glyphs. Use
+ * pbm_writeStringStyled with a style for transparent or smoothed scaled text.
+ *
+ * @param imageHandler the image to write a string
+ * @param x start position in x
+ * @param y start position in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param textAlignment alignment of the scaled string to the start position
+ * @param scale the scale factor (1 - PBM_TEXT_SCALE_MAX)
+ * @param msg the C string to write to the image
+ * @return pbm_return state
+ */
+pbm_return pbm_writeStringScaled(pbm_image *const imageHandler,
+                                 const uint32_t x,
+                                 const uint32_t y,
+                                 pbm_colors color,
+                                 const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 uint8_t scale,
+                                 const char *msg);
+
+/**
+ * @brief Write a text with several lines into a box of the image
+ *
+ * The text is broken at newlines and, depending on the wrap mode, at the box
+ * border. Every line is aligned horizontally in the box, the whole block
+ * vertically. Justified lines are widened over their spaces, except the last
+ * line of a paragraph. Lines which do not fit completely into the box height
+ * are skipped, the pixels outside of the box are clipped.
+ *
+ * @param imageHandler the image to write the text
+ * @param box the text box in the image
+ * @param color the desired color
+ * @param font the font handler to write the text
+ * @param textAlignment alignment of the lines in the box
+ * @param wrapMode line breaking at the box border
+ * @param style the text style or NULL for the default style
+ * @param text the C string to write
+ * @param cache optional line break cache for redrawing the same text or NULL
+ * @return pbm_return state
+ */
+pbm_return pbm_writeTextBox(pbm_image *const imageHandler,
+                            const pbm_rect *box,
+                            pbm_colors color,
+                            const pbm_font *font,
+                            pbm_stringAlignment textAlignment,
+                            pbm_wrapMode wrapMode,
+                            const pbm_textStyle *style,
+                            const char *text,
+                            pbm_textBoxCache *cache);
+
+/**
+ * @brief Mark the layout of a text box cache as outdated
+ *
+ * Required after a change of the text content if skipTextHash is set.
+ *
+ * @param cache the text box cache
+ */
+void pbm_invalidateTextBox(pbm_textBoxCache *cache);
+
+/**
+ * @brief Hash a string with FNV-1a
+ *
+ * Used by the text box and the text caches to detect changed strings.
+ *
+ * @param text the C string, NULL is hashed like an empty string
+ * @return uint32_t the hash value
+ */
+uint32_t pbm_hashString(const char *text);
+
+/**
+ * @brief Measure the size of a string on one line
+ *
+ * The ink bounds use the glyph boxes of the font if available, otherwise they
+ * are calculated from the glyph data. The extent is unscaled, all values of a
+ * scaled string are multiplied by the scale. The ink bounds do not include the
+ * emphasis of a style.
+ *
+ * @param font the font handler to write the string
+ * @param msg the C string to measure
+ * @param extent output size of the string
+ * @return pbm_return state
+ */
+pbm_return pbm_measureString(const pbm_font *font,
+                             const char *msg,
+                             pbm_textExtent *extent);
+
+/**
+ * @brief Measure a string once to draw it later with pbm_drawLayout
+ *
+ * @param layout output layout of the string
+ * @param font the font handler to write the string
+ * @param msg the C string, must be valid as long as the layout is used
+ * @return pbm_return state
+ */
+pbm_return pbm_layoutString(pbm_textLayout *layout,
+                            const pbm_font *font,
+                            const char *msg);
+
+/**
+ * @brief Draw a measured string into the image
+ *
+ * The alignment uses the measured size, the string is not scanned again.
+ *
+ * @param imageHandler the image to write the string
+ * @param layout the measured string
+ * @param x start position in x
+ * @param y start position in y
+ * @param color the desired color
+ * @param textAlignment alignment of the string to the start position
+ * @param style the text style or NULL for the default style
+ * @return pbm_return state
+ */
+pbm_return pbm_drawLayout(pbm_image *const imageHandler,
+                          const pbm_textLayout *layout,
+                          const uint32_t x,
+                          const uint32_t y,
+                          pbm_colors color,
+                          pbm_stringAlignment textAlignment,
+                          const pbm_textStyle *style);
+
+/**
+ * @brief Compute the ink bounding boxes of the font glyphs
+ *
+ * The boxes have to be computed once per font and can then be assigned to
+ * pbm_font.glyphBoxes to skip the empty lines and columns of the glyphs in the
+ * transparent text mode.
+ *
+ * @param font the font to analyse
+ * @param boxes output array with at least count elements
+ * @param count number of glyphs in the font (256 for a full 8 bit font)
+ * @return pbm_return state
+ */
+pbm_return pbm_computeGlyphBoxes(const pbm_font *font,
+                                 pbm_glyphBox *boxes,
+                                 uint32_t count);
+
+/**
+ * @brief Compute proportional metrics from the ink of the font glyphs
+ *
+ * Every glyph gets the width of its set pixels, glyphs without set pixels
+ * (e.g. space) get the half font width. The result can be assigned to
+ * pbm_font.metrics to use a fixed width font as proportional font.
+ *
+ * @param font the font to analyse
+ * @param metrics output array with at least count elements
+ * @param count number of glyphs in the font (256 for a full 8 bit font)
+ * @return pbm_return state
+ */
+pbm_return pbm_computeGlyphMetrics(const pbm_font *font,
+                                   pbm_glyphMetrics *metrics,
+                                   uint32_t count);
+
+/**
+ * @brief Pack a bitmap font into the compressed PBM_FONT_PACKED format
+ *
+ * Every glyph is cropped to its ink box and its lines are stored without
+ * padding. A line equal to the previous one is stored as a single bit. The
+ * packed glyphs are drawn straight from the packed data.
+ *
+ * The offsets and boxes add 8 bytes per glyph, so packing pays off for fonts
+ * of about 12x20 pixels and larger (12x20: 2.1 times, 32x53: 3.2 times
+ * smaller). Small fonts like 6x8 get larger than the bitmap font. Opaque and
+ * scaled packed text is drawn slower than bitmap text, transparent packed
+ * text faster as only the ink boxes are drawn.
+ *
+ * Call the function with data = NULL to get the required data size. The
+ * packed font uses data as fontData, offsets as glyphOffsets and boxes as
+ * glyphBoxes with the encoding PBM_FONT_PACKED and the alignment
+ * PBM_DATA_HORIZONTAL_MSB. Width, height and the optional tables are equal to
+ * the source font.
+ *
+ * @param font the bitmap font to pack
+ * @param count number of glyphs in the font (256 for a full 8 bit font)
+ * @param data output packed glyph data or NULL
+ * @param dataSize size of data, returns the required size
+ * @param offsets output byte offsets of the glyphs with count elements
+ * @param boxes output ink boxes of the glyphs with count elements
+ * @return pbm_return state, PBM_SIZE if data is too small
+ */
+pbm_return pbm_packFont(const pbm_font *font,
+                        uint32_t count,
+                        uint8_t *data,
+                        uint32_t *dataSize,
+                        uint32_t *offsets,
+                        pbm_glyphBox *boxes);
+
+/**
+ * @brief Rotate the glyphs of a font for rotated text
+ *
+ * The rotated font is a bitmap font with the alignment
+ * PBM_DATA_HORIZONTAL_MSB. Width and height are swapped for 90 and 270
+ * degree. Only the glyph data is rotated, the metrics, boxes and maps of the
+ * upright font are used to write rotated text. Add the rotated fonts in the
+ * order 90, 180 and 270 degree to the rotations of the upright font, or use
+ * pbm_addFontRotations for all three rotations.
+ *
+ * Call the function with data = NULL to get the required data size.
+ *
+ * @param font the upright font
+ * @param count number of glyphs in the font (256 for a full 8 bit font)
+ * @param rotation the clockwise rotation (90, 180 or 270 degree)
+ * @param data output rotated glyph data or NULL
+ * @param dataSize size of data, returns the required size
+ * @param rotatedFont output rotated font using data
+ * @return pbm_return state, PBM_SIZE if data is too small
+ */
+pbm_return pbm_rotateFont(const pbm_font *font,
+                          uint32_t count,
+                          pbm_textRotation rotation,
+                          uint8_t *data,
+                          uint32_t *dataSize,
+                          pbm_font *rotatedFont);
+
+/**
+ * @brief Rotate a font by 90, 180 and 270 degree for rotated text
+ *
+ * The glyphs of all three rotations are stored one after the other in data,
+ * the rotations of the font are set to the table of the rotated fonts.
+ *
+ * Call the function with data = NULL to get the required data size.
+ *
+ * @param font the upright font, gets the rotations
+ * @param count number of glyphs in the font (256 for a full 8 bit font)
+ * @param data output rotated glyph data or NULL
+ * @param dataSize size of data, returns the required size
+ * @param rotations output rotated fonts using data
+ * @return pbm_return state, PBM_SIZE if data is too small
+ */
+pbm_return pbm_addFontRotations(pbm_font *font,
+                                uint32_t count,
+                                uint8_t *data,
+                                uint32_t *dataSize,
+                                pbm_fontRotations *rotations);
+
 #ifdef __cplusplus
 }
 #endif
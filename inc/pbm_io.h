@@ -0,0 +1,446 @@
+/**
+ * @file pbm_io.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Decode and encode PBM images, convert PGM and PPM images
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_IO_H
+#define PBM_IO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pbm_types.h"
+
+/**
+ * @brief PBM file formats
+ *
+ */
+typedef enum {
+  PBM_FORMAT_BINARY = 0,  ///< P4, packed bits
+  PBM_FORMAT_PLAIN,       ///< P1, one ASCII digit per pixel
+  PBM_FORMAT_GRAY,        ///< P5, binary grayscale samples, read only
+  PBM_FORMAT_GRAY_PLAIN,  ///< P2, ASCII grayscale samples, read only
+  PBM_FORMAT_COLOR,       ///< P6, binary RGB samples, read only
+  PBM_FORMAT_COLOR_PLAIN  ///< P3, ASCII RGB samples, read only
+} pbm_format;
+
+/**
+ * @brief Conversion of grayscale and color images to the bitmap
+ *
+ */
+typedef enum {
+  PBM_CONVERT_THRESHOLD = 0, ///< Pixels darker than the threshold are black
+  PBM_CONVERT_DITHER         ///< Ordered 8x8 dither of the brightness
+} pbm_convertMode;
+
+/**
+ * @brief Options of the grayscale and color conversion
+ *
+ */
+typedef struct {
+  pbm_convertMode mode; ///< Conversion of the brightness
+  uint8_t threshold;    ///< Brightness of the first white pixel, 0 - 255
+} pbm_conversion;
+
+/**
+ * @brief Ownership of the decoded image data
+ *
+ */
+typedef enum {
+  PBM_DECODE_COPY = 0, ///< The data is copied to the heap, free it after use
+  PBM_DECODE_ALIAS     ///< The P4 data points into the decoded buffer
+} pbm_decodeMode;
+
+/**
+ * @brief Header information of an encoded image
+ *
+ */
+typedef struct {
+  pbm_format format;   ///< Format of the magic number
+  uint32_t width;      ///< Width of the image
+  uint32_t height;     ///< Height of the image
+  uint32_t maxval;     ///< Maximum sample value, 1 for bitmaps
+  uint64_t dataOffset; ///< Offset of the raster after the header
+  uint64_t dataSize;   ///< Bytes of a binary raster, at least the bytes of a
+                       ///< plain raster
+} pbm_imageInfo;
+
+/**
+ * @brief File with several concatenated images
+ *
+ * Regular files are mapped, other files are read sequentially. The offset
+ * index is built on the first seek or count, or loaded from an index file.
+ */
+typedef struct {
+  uint8_t *mapping;  ///< Copy on write mapping of the file or NULL
+  size_t size;       ///< Size of the file, 0 if unknown
+  FILE *file;        ///< Sequentially read file if it is not mapped
+  size_t position;   ///< Offset of the next image in the mapping
+  size_t next;       ///< Number of the next image
+  uint64_t *offsets; ///< Offset of every image, NULL without index
+  size_t count;      ///< Number of indexed images
+} pbm_stream;
+
+/**
+ * @brief Load an PBM P1 or P4 image from the path
+ * The data of the image will be created on the heap.
+ * The user is responsible to free the data at the end of the application.
+ *
+ * @param imagePath The path to the image
+ * @param imageHandler Image handler structure.
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_loadImage(const char *imagePath, pbm_image *imageHandler);
+
+/**
+ * @brief Load a PBM, PGM or PPM image from the path as bitmap
+ *
+ * Grayscale and color images are converted row by row, only one source row
+ * is kept in memory. The data of the image will be created on the heap.
+ *
+ * @param imagePath The path to the image
+ * @param imageHandler Image handler structure.
+ * @param conversion The conversion to the bitmap, NULL for a threshold at the
+ * half brightness
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_loadImageConverted(const char *imagePath,
+                                  pbm_image *imageHandler,
+                                  const pbm_conversion *conversion);
+
+/**
+ * @brief Read the header of a PBM, PGM or PPM image on the path
+ *
+ * Only the first bytes of the file are read, the size of the file is checked
+ * against the payload of the header.
+ *
+ * @param imagePath The path to the image
+ * @param info The header information
+ * @return pbm_return state, PBM_ERROR for an invalid header or a too short
+ * file, PBM_SIZE for a too big image
+ */
+pbm_return pbm_probeImage(const char *imagePath, pbm_imageInfo *info);
+
+/**
+ * @brief Read the header of a PBM, PGM or PPM image in a memory buffer
+ *
+ * @param buffer the encoded image
+ * @param size the number of bytes in the buffer
+ * @param info the header information
+ * @return pbm_return state, PBM_ERROR for an invalid header or a too short
+ * buffer, PBM_SIZE for a too big image
+ */
+pbm_return pbm_probeMemory(const uint8_t *buffer, size_t size,
+                           pbm_imageInfo *info);
+
+/**
+ * @brief Saves or overwrites an image on the path.
+ *
+ * @param imagePath The path to the new image
+ * @param imageHandler The image to save
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_saveImage(const char *imagePath, const pbm_image *imageHandler);
+
+/**
+ * @brief Saves or overwrites an image in the format on the path.
+ *
+ * @param imagePath The path to the new image
+ * @param imageHandler The image to save
+ * @param format The format of the file
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_saveImageFormat(const char *imagePath,
+                               const pbm_image *imageHandler,
+                               pbm_format format);
+
+/**
+ * @brief Decode a PBM P1 or P4 image from a memory buffer
+ *
+ * The image is in the PBM_DATA_HORIZONTAL_MSB alignment. With
+ * PBM_DECODE_ALIAS no memory is allocated, the image data points into the
+ * buffer, which must outlive the image and be writable if the image is
+ * changed. P1 images can not be aliased and return PBM_ARGUMENTS.
+ *
+ * @param buffer the encoded image
+ * @param size the number of bytes in the buffer
+ * @param imageHandler the decoded image, only changed on success
+ * @param mode copy the data or alias the buffer
+ * @param used optional, the bytes of header and data, the start of a
+ * following image
+ * @return pbm_return state, PBM_ERROR for an invalid or truncated image,
+ * PBM_SIZE for a too big image
+ */
+pbm_return pbm_decodeFromMemory(const uint8_t *buffer, size_t size,
+                                pbm_image *imageHandler, pbm_decodeMode mode,
+                                size_t *used);
+
+/**
+ * @brief Decode a PBM, PGM or PPM image from a memory buffer as bitmap
+ *
+ * Like pbm_decodeFromMemory with copied data, grayscale and color images are
+ * converted row by row.
+ *
+ * @param buffer the encoded image
+ * @param size the number of bytes in the buffer
+ * @param imageHandler the decoded image, only changed on success
+ * @param conversion the conversion to the bitmap, NULL for a threshold at the
+ * half brightness
+ * @param used optional, the bytes of header and data
+ * @return pbm_return state
+ */
+pbm_return pbm_decodeFromMemoryConverted(const uint8_t *buffer, size_t size,
+                                         pbm_image *imageHandler,
+                                         const pbm_conversion *conversion,
+                                         size_t *used);
+
+/**
+ * @brief Encode an image as PBM P4 into a caller provided buffer
+ *
+ * The image must be in the PBM_DATA_HORIZONTAL_MSB alignment. If the buffer
+ * is NULL or too small, nothing is written, PBM_SIZE is returned and the size
+ * is set to the required number of bytes.
+ *
+ * @param imageHandler the image to encode
+ * @param buffer the destination buffer or NULL to query the size
+ * @param size in: the size of the buffer, out: the encoded or required size
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToMemory(const pbm_image *imageHandler, uint8_t *buffer,
+                              size_t *size);
+
+/**
+ * @brief Encode an image in the format into a caller provided buffer
+ *
+ * Like pbm_encodeToMemory. P1 lines hold at most 64 pixels.
+ *
+ * @param imageHandler the image to encode
+ * @param format the format to write
+ * @param buffer the destination buffer or NULL to query the size
+ * @param size in: the size of the buffer, out: the encoded or required size
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToMemoryFormat(const pbm_image *imageHandler,
+                                    pbm_format format, uint8_t *buffer,
+                                    size_t *size);
+
+/**
+ * @brief Decode a PBM P1 or P4 image from an open stream
+ *
+ * The stream is read up to the end of the image data and stays open. The data
+ * of the image will be created on the heap.
+ *
+ * @param file the stream to read
+ * @param imageHandler the decoded image, only changed on success
+ * @return pbm_return state
+ */
+pbm_return pbm_decodeFromFile(FILE *file, pbm_image *imageHandler);
+
+/**
+ * @brief Decode a PBM, PGM or PPM image from an open stream as bitmap
+ *
+ * @param file the stream to read
+ * @param imageHandler the decoded image, only changed on success
+ * @param conversion the conversion to the bitmap, NULL for a threshold at the
+ * half brightness
+ * @return pbm_return state
+ */
+pbm_return pbm_decodeFromFileConverted(FILE *file, pbm_image *imageHandler,
+                                       const pbm_conversion *conversion);
+
+/**
+ * @brief Encode an image as PBM P4 into an open stream
+ *
+ * @param file the stream to write
+ * @param imageHandler the image in the PBM_DATA_HORIZONTAL_MSB alignment
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToFile(FILE *file, const pbm_image *imageHandler);
+
+/**
+ * @brief Encode an image in the format into an open stream
+ *
+ * @param file the stream to write
+ * @param imageHandler the image in the PBM_DATA_HORIZONTAL_MSB alignment
+ * @param format the format to write
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToFileFormat(FILE *file, const pbm_image *imageHandler,
+                                  pbm_format format);
+
+/**
+ * @brief Decode a PBM P1 or P4 image from a file descriptor
+ *
+ * Exactly the bytes of the image are read, so pipes and sockets with several
+ * images can be decoded one after the other. The data of the image will be
+ * created on the heap.
+ *
+ * @param fd the file descriptor to read
+ * @param imageHandler the decoded image, only changed on success
+ * @return pbm_return state
+ */
+pbm_return pbm_decodeFromFd(int fd, pbm_image *imageHandler);
+
+/**
+ * @brief Decode a PBM, PGM or PPM image from a file descriptor as bitmap
+ *
+ * @param fd the file descriptor to read
+ * @param imageHandler the decoded image, only changed on success
+ * @param conversion the conversion to the bitmap, NULL for a threshold at the
+ * half brightness
+ * @return pbm_return state
+ */
+pbm_return pbm_decodeFromFdConverted(int fd, pbm_image *imageHandler,
+                                     const pbm_conversion *conversion);
+
+/**
+ * @brief Encode an image as PBM P4 into a file descriptor
+ *
+ * @param fd the file descriptor to write
+ * @param imageHandler the image in the PBM_DATA_HORIZONTAL_MSB alignment
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToFd(int fd, const pbm_image *imageHandler);
+
+/**
+ * @brief Encode an image in the format into a file descriptor
+ *
+ * @param fd the file descriptor to write
+ * @param imageHandler the image in the PBM_DATA_HORIZONTAL_MSB alignment
+ * @param format the format to write
+ * @return pbm_return state
+ */
+pbm_return pbm_encodeToFdFormat(int fd, const pbm_image *imageHandler,
+                                pbm_format format);
+
+/**
+ * @brief Open a file with concatenated PBM, PGM or PPM images
+ *
+ * Release the stream with pbm_closeStream.
+ *
+ * @param streamPath the path to the file
+ * @param stream the opened stream
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_openStream(const char *streamPath, pbm_stream *stream);
+
+/**
+ * @brief Close a stream and release its mapping and index
+ *
+ * Images aliasing the mapping are invalid afterwards.
+ *
+ * @param stream the stream to close
+ */
+void pbm_closeStream(pbm_stream *stream);
+
+/**
+ * @brief Decode the next PBM P1 or P4 image of a stream
+ *
+ * With PBM_DECODE_ALIAS the P4 data points into the mapping of the file and
+ * stays valid until the stream is closed, changes of the image are private.
+ * Streams that are not mapped can only be copied.
+ *
+ * @param stream the stream to read
+ * @param imageHandler the decoded image, only changed on success
+ * @param mode copy the data or alias the mapping
+ * @return pbm_return state, PBM_OUT_OF_RANGE after the last image
+ */
+pbm_return pbm_readStream(pbm_stream *stream, pbm_image *imageHandler,
+                          pbm_decodeMode mode);
+
+/**
+ * @brief Decode the next PBM, PGM or PPM image of a stream as bitmap
+ *
+ * @param stream the stream to read
+ * @param imageHandler the decoded image, only changed on success
+ * @param conversion the conversion to the bitmap, NULL for a threshold at the
+ * half brightness
+ * @return pbm_return state, PBM_OUT_OF_RANGE after the last image
+ */
+pbm_return pbm_readStreamConverted(pbm_stream *stream, pbm_image *imageHandler,
+                                   const pbm_conversion *conversion);
+
+/**
+ * @brief Scan the stream and build the offset index
+ *
+ * Only the headers are parsed, binary rasters are skipped. Streams that are
+ * not mapped must be seekable, the next image stays the same.
+ *
+ * @param stream the stream to index
+ * @return pbm_return state, PBM_ERROR for an invalid image
+ */
+pbm_return pbm_indexStream(pbm_stream *stream);
+
+/**
+ * @brief Select the next image of a stream
+ *
+ * The index is built first if it is missing.
+ *
+ * @param stream the stream
+ * @param index the number of the image, starting with 0
+ * @return pbm_return state, PBM_OUT_OF_RANGE for a missing image
+ */
+pbm_return pbm_seekStream(pbm_stream *stream, size_t index);
+
+/**
+ * @brief Get the number of images of a stream
+ *
+ * The index is built first if it is missing.
+ *
+ * @param stream the stream
+ * @param count the number of images
+ * @return pbm_return state
+ */
+pbm_return pbm_streamCount(pbm_stream *stream, size_t *count);
+
+/**
+ * @brief Save the offset index of a stream to a file
+ *
+ * The index is built first if it is missing. The index file stores the size
+ * of the stream and the offsets as little endian 64 bit values.
+ *
+ * @param stream the stream
+ * @param indexPath the path to the index file
+ * @return pbm_return state
+ */
+pbm_return pbm_saveStreamIndex(pbm_stream *stream, const char *indexPath);
+
+/**
+ * @brief Load the offset index of a stream from a file
+ *
+ * An index of a file with another size or invalid offsets is rejected.
+ *
+ * @param stream the stream
+ * @param indexPath the path to the index file
+ * @return pbm_return state, PBM_ERROR for a missing or invalid index file
+ */
+pbm_return pbm_loadStreamIndex(pbm_stream *stream, const char *indexPath);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBM_IO_H */
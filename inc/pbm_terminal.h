@@ -0,0 +1,168 @@
+/**
+ * @file pbm_terminal.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Character cell terminal on an image
+ *
+ * The terminal keeps the characters of a fixed width font in cells and only
+ * draws the changed cells into the image. It handles the control characters
+ * and a subset of the ANSI escape sequences of a console.
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PBM_TERMINAL_H
+#define PBM_TERMINAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "pbm_fontHandler.h"
+#include "pbm_graphics.h"
+#include "pbm_types.h"
+
+#define PBM_TERMINAL_MAX_PARAMETERS (4) ///< Parameters of an escape sequence
+#define PBM_TERMINAL_TAB_SIZE (8)       ///< Columns between the tab stops
+
+/**
+ * @brief Attributes of a terminal cell
+ *
+ */
+typedef enum {
+  PBM_TERMINAL_BOLD = 0x01,      ///< Bold character (SGR 1)
+  PBM_TERMINAL_UNDERLINE = 0x02, ///< Underlined character (SGR 4)
+  PBM_TERMINAL_INVERSE = 0x04,   ///< Inverted colors (SGR 7)
+  PBM_TERMINAL_DIRTY = 0x80      ///< The cell has to be drawn
+} pbm_terminalAttribute;
+
+/**
+ * @brief Character cell of the terminal
+ *
+ */
+typedef struct {
+  uint8_t character;  ///< The character of the cell
+  uint8_t attributes; ///< Combination of pbm_terminalAttribute flags
+} pbm_terminalCell;
+
+/**
+ * @brief Terminal handler
+ *
+ * The cells are stored row by row as ring buffer, scrolling only moves the
+ * first row. The image is updated with pbm_flushTerminal.
+ */
+typedef struct {
+  pbm_image *image;        ///< Image of the terminal
+  const pbm_font *font;    ///< Fixed width font of the cells
+  uint32_t x;              ///< Left position of the terminal in the image
+  uint32_t y;              ///< Top position of the terminal in the image
+  uint16_t rows;           ///< Number of rows
+  uint16_t columns;        ///< Number of columns
+  pbm_terminalCell *cells; ///< Cells with a size of rows x columns
+  uint16_t firstRow;       ///< Cell row shown as top row
+  uint16_t scrolledRows;   ///< Rows scrolled since the last flush
+  uint16_t cursorRow;      ///< Row of the cursor
+  uint16_t cursorColumn;   ///< Column of the cursor
+  pbm_colors color;        ///< Color of the characters
+  uint8_t attributes;      ///< Attributes of the written characters
+  uint8_t escapeState;     ///< State of the escape sequence parser
+  uint8_t parameterCount;  ///< Number of parsed parameters
+  uint16_t parameters[PBM_TERMINAL_MAX_PARAMETERS]; ///< Escape parameters
+} pbm_terminal;
+
+/**
+ * @brief Initialize an empty terminal
+ *
+ * Every cell is font width x font height pixels large and the terminal has to
+ * fit into the image. The whole terminal is drawn with the next flush.
+ *
+ * @param terminal the terminal to initialize
+ * @param imageHandler the image to draw the terminal
+ * @param x left position of the terminal in the image
+ * @param y top position of the terminal in the image
+ * @param font fixed width font without metrics and kerning
+ * @param rows number of rows
+ * @param columns number of columns
+ * @param cells buffer of rows x columns cells
+ * @param color the color of the characters
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_initTerminal(pbm_terminal *terminal,
+                            pbm_image *imageHandler,
+                            uint32_t x,
+                            uint32_t y,
+                            const pbm_font *font,
+                            uint16_t rows,
+                            uint16_t columns,
+                            pbm_terminalCell *cells,
+                            pbm_colors color);
+
+/**
+ * @brief Write characters to the terminal
+ *
+ * Handled control characters: newline (also returns the cursor to the first
+ * column), carriage return, backspace and tab.
+ * Handled escape sequences: cursor movement (CSI A, B, C, D, H, f), erase in
+ * display and line (CSI J, K) and the attributes reset, bold, underline and
+ * inverse (CSI m). Other sequences are ignored. Sequences can be split over
+ * several calls.
+ *
+ * @param terminal the terminal
+ * @param msg the C string to write
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_writeTerminal(pbm_terminal *terminal, const char *msg);
+
+/**
+ * @brief Move the cursor
+ *
+ * @param terminal the terminal
+ * @param row the new row
+ * @param column the new column
+ * @return pbm_return state, PBM_OUT_OF_RANGE outside of the terminal
+ */
+pbm_return pbm_setTerminalCursor(pbm_terminal *terminal,
+                                 uint16_t row,
+                                 uint16_t column);
+
+/**
+ * @brief Clear all cells and move the cursor to the top left cell
+ *
+ * @param terminal the terminal
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_clearTerminal(pbm_terminal *terminal);
+
+/**
+ * @brief Draw the changes of the terminal into the image
+ *
+ * Scrolled rows are moved in the image and only the changed cells are drawn.
+ *
+ * @param terminal the terminal
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_flushTerminal(pbm_terminal *terminal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBM_TERMINAL_H */
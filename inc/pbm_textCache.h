@@ -0,0 +1,118 @@
+/**
+ * @file pbm_textCache.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Cache of rendered strings for repeated labels
+ *
+ * The rendered strings are stored as bitmaps and drawn again with a bitmap
+ * blit instead of rendering every glyph. The cache is limited by a memory
+ * budget and evicts the least recently used strings.
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_TEXTCACHE_H
+#define PBM_TEXTCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pbm_graphics.h"
+
+#define PBM_TEXT_CACHE_BUCKETS (64) ///< Hash buckets of the text cache
+
+/**
+ * @brief Cached rendered string (private)
+ *
+ */
+typedef struct pbm_textCacheEntry pbm_textCacheEntry;
+
+/**
+ * @brief Text cache handler
+ *
+ * The strings are identified by the font pointer, the string content and the
+ * style. Clear the cache if the data of a cached font changes.
+ * The counters can be read and reset by the user.
+ */
+typedef struct {
+  size_t budget;                 ///< Maximal memory of the cached strings
+  size_t used;                   ///< Used memory of the cached strings
+  uint32_t entries;              ///< Number of cached strings
+  uint32_t hits;                 ///< Strings drawn from the cache
+  uint32_t misses;               ///< Strings rendered and added to the cache
+  uint32_t evictions;            ///< Strings removed to stay in the budget
+  pbm_textCacheEntry *newest;    ///< Most recently used string
+  pbm_textCacheEntry *oldest;    ///< Least recently used string
+  pbm_textCacheEntry *buckets[PBM_TEXT_CACHE_BUCKETS]; ///< Hash table
+} pbm_textCache;
+
+/**
+ * @brief Initialize an empty text cache
+ *
+ * @param cache the cache to initialize
+ * @param budget maximal memory of the cached strings in bytes
+ * @return pbm_return state of the function
+ */
+pbm_return pbm_initTextCache(pbm_textCache *cache, size_t budget);
+
+/**
+ * @brief Remove all strings of the cache and release their memory
+ *
+ * The budget and the counters are kept.
+ *
+ * @param cache the cache to clear
+ */
+void pbm_clearTextCache(pbm_textCache *cache);
+
+/**
+ * @brief Write a string like pbm_writeStringStyled through the cache
+ *
+ * A cached string is drawn with a single bitmap blit (two for opaque text).
+ * A new string is rendered once into a bitmap and added to the cache. Strings
+ * larger than the budget are written without the cache.
+ *
+ * @param cache the text cache
+ * @param imageHandler the image to write a string
+ * @param x start position in x
+ * @param y start position in y
+ * @param color the desired color
+ * @param font the font handler with the bitmapped font, size and orientation
+ * @param textAlignment alignment of the string to the start position
+ * @param style the text style or NULL for the default style
+ * @param msg the C string to write to the image
+ * @return pbm_return state
+ */
+pbm_return pbm_writeStringCached(pbm_textCache *cache,
+                                 pbm_image *const imageHandler,
+                                 const uint32_t x,
+                                 const uint32_t y,
+                                 pbm_colors color,
+                                 const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 const pbm_textStyle *style,
+                                 const char *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBM_TEXTCACHE_H */
@@ -67,6 +67,26 @@ typedef struct {
   uint8_t *data; ///< Image buffer data with min size of (width*height+7)/8
 } pbm_image;
 
+/**
+ * @brief PBM point in an image
+ *
+ */
+typedef struct {
+  uint32_t x; ///< x position (horizontal)
+  uint32_t y; ///< y position (vertical)
+} pbm_point;
+
+/**
+ * @brief PBM rectangle in an image
+ *
+ */
+typedef struct {
+  uint32_t x;      ///< left position (horizontal)
+  uint32_t y;      ///< top position (vertical)
+  uint32_t width;  ///< width of the rectangle
+  uint32_t height; ///< height of the rectangle
+} pbm_rect;
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,7 @@
 /**
  * @file sdl2_pbmIO.h
  * @author Adrian STEINER (adi.steiner@hotmail.ch)
- * @brief Load, save and render a PBM image
+ * @brief Render a PBM image with SDL2
  * @version 0.1
  * @date 18-12-2024
  *
@@ -31,28 +31,9 @@ extern "C" {
 #include <SDL2/SDL.h>
 #include <stdint.h>
 
+#include "pbm_io.h"
 #include "pbm_types.h"
 
-/**
- * @brief Load an PBM P4 image from the path
- * The data of the image will be created on the heap.
- * The user is responsible to free the data at the end of the application.
- *
- * @param imagePath The path to the image
- * @param imageHandler Image handler structure.
- * @return pbm_return state of the function
- */
-pbm_return pbm_loadImage(const char *imagePath, pbm_image *imageHandler);
-
-/**
- * @brief Saves or overwrites an image on the path.
- *
- * @param imagePath The path to the new image
- * @param imageHandler The image to save
- * @return pbm_return state of the function
- */
-pbm_return pbm_saveImage(const char *imagePath, const pbm_image *imageHandler);
-
 /**
  * @brief Render an image in the renderer.
  *
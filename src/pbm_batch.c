@@ -0,0 +1,1000 @@
+/**
+ * @file pbm_batch.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Load and save many PBM images with io_uring or a thread pool
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// pthreads, O_CLOEXEC and the syscall function for io_uring
+#define _DEFAULT_SOURCE
+
+#include "pbm_batch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && !defined(PBM_BATCH_NO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BATCH_URING (1) ///< The io_uring backend is built
+#endif
+
+#define BATCH_MAX_DEPTH (4096)        ///< Maximum number of requests in flight
+#define BATCH_BUFFER_SIZE (65536)     ///< First size of a file buffer
+#define BATCH_MAX_TRANSFER (1u << 30) ///< Maximum bytes of a read or write
+
+/**
+ * @brief Steps of a request in flight
+ *
+ */
+enum {
+  STAGE_IDLE = 0, ///< No request
+  STAGE_OPEN,     ///< Opening the file
+  STAGE_READ,     ///< Reading the file up to its end
+  STAGE_WRITE,    ///< Writing the encoded image
+  STAGE_CLOSE     ///< Closing the file
+};
+
+/**
+ * @brief Request in flight with its reused file buffer
+ *
+ */
+typedef struct {
+  pbm_batchRequest *request; ///< Request in flight or NULL
+  uint8_t stage;             ///< Current step
+  int fd;                    ///< Opened file or -1
+  uint8_t *buffer;           ///< File buffer, kept for the next requests
+  size_t capacity;           ///< Size of the file buffer
+  size_t size;               ///< Bytes of the encoded image to write
+  size_t done;               ///< Read or written bytes
+  pbm_return result;         ///< State of the file operations
+} batchSlot;
+
+/**
+ * @brief Growing ring of requests
+ *
+ */
+typedef struct {
+  pbm_batchRequest **items; ///< Queued requests
+  size_t capacity;          ///< Size of the items
+  size_t head;              ///< Index of the first request
+  size_t count;             ///< Number of queued requests
+} requestQueue;
+
+#ifdef BATCH_URING
+/**
+ * @brief Mapped submission and completion queues of an io_uring
+ *
+ */
+typedef struct {
+  int fd;                    ///< File descriptor of the ring or -1
+  void *sqMapping;           ///< Mapped submission ring
+  size_t sqMappingSize;      ///< Size of the submission ring mapping
+  void *cqMapping;           ///< Mapped completion ring
+  size_t cqMappingSize;      ///< Size of the completion ring mapping
+  struct io_uring_sqe *sqes; ///< Mapped submission entries
+  size_t sqesSize;           ///< Size of the submission entries mapping
+  uint32_t *sqTail;          ///< Tail of the submission ring
+  uint32_t sqMask;           ///< Index mask of the submission ring
+  uint32_t *sqArray;         ///< Indices of the submission entries
+  uint32_t *cqHead;          ///< Head of the completion ring
+  uint32_t *cqTail;          ///< Tail of the completion ring
+  uint32_t cqMask;           ///< Index mask of the completion ring
+  struct io_uring_cqe *cqes; ///< Completion entries
+  uint32_t unsubmitted;      ///< Queued entries not passed to the kernel
+} uringRing;
+#endif
+
+/**
+ * @brief Internal state of a batch
+ *
+ */
+typedef struct {
+  batchSlot *slots;       ///< Requests in flight, one per ring slot or thread
+  uint32_t depth;         ///< Number of slots, at most PBM_BATCH_MAX_THREADS
+                          ///< for the thread backend
+  uint32_t active;        ///< Number of requests in flight
+  uint8_t threaded;       ///< Thread pool instead of io_uring
+  requestQueue pending;   ///< Submitted requests waiting for a slot
+  requestQueue completed; ///< Completed requests to poll
+#ifdef BATCH_URING
+  uringRing ring;         ///< Ring of the io_uring backend
+#endif
+  pthread_t *threads;     ///< Workers of the thread backend
+  uint32_t threadCount;   ///< Number of started workers
+  uint32_t claimedSlots;  ///< Slots taken by the workers
+  uint8_t stop;           ///< Workers end when no request is pending
+  pthread_mutex_t lock;   ///< Lock of the queues of the thread backend
+  pthread_cond_t work;    ///< Signals pending requests to the workers
+  pthread_cond_t done;    ///< Signals completed requests to the caller
+} batchState;
+
+/**
+ * @brief Make room for further requests in a queue
+ *
+ * @param queue the queue
+ * @param count the number of requests to add
+ * @return pbm_return state
+ */
+static pbm_return queueReserve(requestQueue *queue, size_t count);
+
+/**
+ * @brief Append a request to a queue with reserved room
+ *
+ * @param queue the queue
+ * @param request the request to append
+ */
+static void queuePush(requestQueue *queue, pbm_batchRequest *request);
+
+/**
+ * @brief Remove the first request of a queue
+ *
+ * @param queue the non empty queue
+ * @return pbm_batchRequest* the first request
+ */
+static pbm_batchRequest *queuePop(requestQueue *queue);
+
+/**
+ * @brief Move completed requests to the caller
+ *
+ * @param state the batch state
+ * @param completed the completed requests
+ * @param maximum the size of the completed array
+ * @return size_t the number of moved requests
+ */
+static size_t takeCompleted(batchState *state, pbm_batchRequest **completed,
+                            size_t maximum);
+
+/**
+ * @brief Grow the file buffer of a slot
+ *
+ * @param slot the slot
+ * @param size the minimum size of the buffer
+ * @return pbm_return state
+ */
+static pbm_return reserveBuffer(batchSlot *slot, size_t size);
+
+/**
+ * @brief Encode the image of a save request into the file buffer
+ *
+ * @param slot the slot with the request
+ * @return pbm_return state
+ */
+static pbm_return prepareSave(batchSlot *slot);
+
+/**
+ * @brief Count read bytes and make room for the next read
+ *
+ * @param slot the slot of a load request
+ * @param bytes the read bytes, 0 at the end of the file
+ * @param finished set to 1 at the end of the file
+ * @return pbm_return state
+ */
+static pbm_return readProgress(batchSlot *slot, size_t bytes,
+                               uint8_t *finished);
+
+/**
+ * @brief Decode the file buffer of a successfully read load request
+ *
+ * @param slot the slot with the closed file
+ */
+static void decodeSlot(batchSlot *slot);
+
+/**
+ * @brief Complete the request of a slot
+ *
+ * @param state the batch state
+ * @param slot the slot with the closed file
+ */
+static void finishSlot(batchState *state, batchSlot *slot);
+
+/**
+ * @brief Load or save a request with blocking IO and decode a loaded file
+ *
+ * @param slot the slot with the request
+ */
+static void processBlocking(batchSlot *slot);
+
+/**
+ * @brief Start the workers of the thread backend
+ *
+ * @param state the batch state
+ * @return pbm_return state
+ */
+static pbm_return startThreads(batchState *state);
+
+/**
+ * @brief Stop the workers after the pending requests
+ *
+ * @param state the batch state
+ */
+static void stopThreads(batchState *state);
+
+/**
+ * @brief Worker of the thread backend
+ *
+ * @param argument the batch state
+ * @return void* NULL
+ */
+static void *workerThread(void *argument);
+
+#ifdef BATCH_URING
+/**
+ * @brief Set up an io_uring and check the used operations
+ *
+ * @param ring the ring
+ * @param entries the number of submission entries
+ * @return pbm_return state, PBM_ERROR if io_uring is not usable
+ */
+static pbm_return uringOpen(uringRing *ring, uint32_t entries);
+
+/**
+ * @brief Release an io_uring
+ *
+ * @param ring the ring
+ */
+static void uringClose(uringRing *ring);
+
+/**
+ * @brief Queue a submission entry
+ *
+ * @param ring the ring
+ * @param opcode the operation
+ * @param fd the file descriptor
+ * @param address the path or buffer
+ * @param length the bytes or the file mode
+ * @param offset the file offset
+ * @param flags the open flags
+ * @param slot the index of the slot
+ */
+static void uringQueue(uringRing *ring, uint8_t opcode, int fd,
+                       const void *address, uint32_t length, uint64_t offset,
+                       uint32_t flags, uint32_t slot);
+
+/**
+ * @brief Submit the queued entries and wait for completions
+ *
+ * @param ring the ring
+ * @param minimum the number of completions to wait for
+ * @return pbm_return state
+ */
+static pbm_return uringEnter(uringRing *ring, uint32_t minimum);
+
+/**
+ * @brief Start pending requests in the free slots
+ *
+ * @param state the batch state
+ */
+static void uringFill(batchState *state);
+
+/**
+ * @brief Queue the next operation of a slot
+ *
+ * @param state the batch state
+ * @param index the index of the slot
+ */
+static void uringStep(batchState *state, uint32_t index);
+
+/**
+ * @brief Advance a slot with the result of its operation
+ *
+ * @param state the batch state
+ * @param index the index of the slot
+ * @param result the result of the operation
+ */
+static void uringComplete(batchState *state, uint32_t index, int32_t result);
+
+/**
+ * @brief Submit, optionally wait and handle all available completions
+ *
+ * @param state the batch state
+ * @param wait 1 to wait for a completion of a request in flight
+ * @return pbm_return state
+ */
+static pbm_return uringProgress(batchState *state, uint8_t wait);
+#endif
+
+pbm_return pbm_openBatch(pbm_batch *batch, uint32_t depth,
+                         pbm_batchBackend backend) {
+  if (NULL == batch || 0 == depth || depth > BATCH_MAX_DEPTH ||
+      backend > PBM_BATCH_THREADS) {
+    return PBM_ARGUMENTS;
+  }
+  memset(batch, 0, sizeof(*batch));
+  batchState *state = (batchState *)calloc(1, sizeof(batchState));
+  if (NULL == state) {
+    return PBM_ERROR;
+  }
+
+  pbm_return retVal = PBM_ERROR;
+#ifdef BATCH_URING
+  state->ring.fd = -1;
+  if (PBM_BATCH_THREADS != backend) {
+    retVal = uringOpen(&state->ring, depth);
+    if (PBM_OK == retVal) {
+      backend = PBM_BATCH_URING;
+    }
+  }
+#endif
+  // A slot per ring request or per worker, the pool is not as deep
+  uint32_t slots = depth;
+  if (PBM_OK != retVal) {
+    if (PBM_BATCH_URING == backend) {
+      free(state);
+      return retVal;
+    }
+    backend = PBM_BATCH_THREADS;
+    if (slots > PBM_BATCH_MAX_THREADS) {
+      slots = PBM_BATCH_MAX_THREADS;
+    }
+  }
+  state->slots = (batchSlot *)calloc(slots, sizeof(batchSlot));
+  retVal = (NULL != state->slots) ? PBM_OK : PBM_ERROR;
+  state->depth = slots;
+  for (uint32_t i = 0; PBM_OK == retVal && i < slots; i++) {
+    state->slots[i].fd = -1;
+  }
+  if (PBM_OK == retVal && PBM_BATCH_THREADS == backend) {
+    retVal = startThreads(state);
+  }
+  if (PBM_OK != retVal) {
+#ifdef BATCH_URING
+    if (PBM_BATCH_URING == backend) {
+      uringClose(&state->ring);
+    }
+#endif
+    free(state->slots);
+    free(state);
+    return retVal;
+  }
+  batch->backend = backend;
+  batch->depth = depth;
+  batch->state = state;
+  return PBM_OK;
+}
+
+void pbm_closeBatch(pbm_batch *batch) {
+  if (NULL == batch || NULL == batch->state) {
+    return;
+  }
+  batchState *state = (batchState *)batch->state;
+  if (state->threaded) {
+    stopThreads(state);
+  }
+#ifdef BATCH_URING
+  else {
+    // The kernel may still use the buffers of the requests in flight
+    while ((0 != state->active || 0 != state->pending.count) &&
+           PBM_OK == uringProgress(state, 1)) {
+    }
+    uringClose(&state->ring);
+  }
+#endif
+  for (uint32_t i = 0; i < state->depth; i++) {
+    free(state->slots[i].buffer);
+  }
+  free(state->slots);
+  free(state->pending.items);
+  free(state->completed.items);
+  free(state);
+  memset(batch, 0, sizeof(*batch));
+}
+
+pbm_return pbm_submitBatch(pbm_batch *batch, pbm_batchRequest *requests,
+                           size_t count) {
+  if (NULL == batch || NULL == batch->state ||
+      (NULL == requests && 0 != count)) {
+    return PBM_ARGUMENTS;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (NULL == requests[i].path || requests[i].operation > PBM_BATCH_SAVE) {
+      return PBM_ARGUMENTS;
+    }
+  }
+  batchState *state = (batchState *)batch->state;
+  if (state->threaded) {
+    pthread_mutex_lock(&state->lock);
+  }
+  // Completing never allocates, every request has room in both queues
+  size_t queued = state->pending.count + state->active + count;
+  pbm_return retVal = queueReserve(&state->pending, count);
+  if (PBM_OK == retVal) {
+    retVal = queueReserve(&state->completed, queued);
+  }
+  if (PBM_OK == retVal) {
+    for (size_t i = 0; i < count; i++) {
+      requests[i].result = PBM_ERROR;
+      queuePush(&state->pending, &requests[i]);
+    }
+  }
+  if (state->threaded) {
+    pthread_cond_broadcast(&state->work);
+    pthread_mutex_unlock(&state->lock);
+    return retVal;
+  }
+#ifdef BATCH_URING
+  if (PBM_OK == retVal) {
+    // The requests stay queued, a failed submission is retried and reported
+    // by the next poll or wait
+    uringProgress(state, 0);
+  }
+#endif
+  return retVal;
+}
+
+pbm_return pbm_pollBatch(pbm_batch *batch, pbm_batchRequest **completed,
+                         size_t maximum, size_t *count) {
+  if (NULL == batch || NULL == batch->state || NULL == completed ||
+      NULL == count) {
+    return PBM_ARGUMENTS;
+  }
+  batchState *state = (batchState *)batch->state;
+  *count = 0;
+  if (state->threaded) {
+    pthread_mutex_lock(&state->lock);
+    *count = takeCompleted(state, completed, maximum);
+    pthread_mutex_unlock(&state->lock);
+    return PBM_OK;
+  }
+  pbm_return retVal = PBM_OK;
+#ifdef BATCH_URING
+  retVal = uringProgress(state, 0);
+#endif
+  *count = takeCompleted(state, completed, maximum);
+  return retVal;
+}
+
+pbm_return pbm_waitBatch(pbm_batch *batch, pbm_batchRequest **completed,
+                         size_t maximum, size_t *count) {
+  if (NULL == batch || NULL == batch->state || NULL == completed ||
+      NULL == count || 0 == maximum) {
+    return PBM_ARGUMENTS;
+  }
+  batchState *state = (batchState *)batch->state;
+  *count = 0;
+  if (state->threaded) {
+    pthread_mutex_lock(&state->lock);
+    while (0 == state->completed.count &&
+           (0 != state->pending.count || 0 != state->active)) {
+      pthread_cond_wait(&state->done, &state->lock);
+    }
+    *count = takeCompleted(state, completed, maximum);
+    pthread_mutex_unlock(&state->lock);
+    return PBM_OK;
+  }
+  pbm_return retVal = PBM_OK;
+#ifdef BATCH_URING
+  retVal = uringProgress(state, 0);
+  while (PBM_OK == retVal && 0 == state->completed.count &&
+         (0 != state->pending.count || 0 != state->active)) {
+    retVal = uringProgress(state, 1);
+  }
+#endif
+  *count = takeCompleted(state, completed, maximum);
+  return retVal;
+}
+
+static pbm_return queueReserve(requestQueue *queue, size_t count) {
+  if (queue->count + count <= queue->capacity) {
+    return PBM_OK;
+  }
+  size_t capacity = (0 != queue->capacity) ? 2 * queue->capacity : 64;
+  while (capacity < queue->count + count) {
+    capacity *= 2;
+  }
+  pbm_batchRequest **items =
+      (pbm_batchRequest **)malloc(capacity * sizeof(*items));
+  if (NULL == items) {
+    return PBM_ERROR;
+  }
+  // Unwrap the ring into the new items
+  for (size_t i = 0; i < queue->count; i++) {
+    items[i] = queue->items[(queue->head + i) % queue->capacity];
+  }
+  free(queue->items);
+  queue->items = items;
+  queue->capacity = capacity;
+  queue->head = 0;
+  return PBM_OK;
+}
+
+static void queuePush(requestQueue *queue, pbm_batchRequest *request) {
+  queue->items[(queue->head + queue->count) % queue->capacity] = request;
+  queue->count++;
+}
+
+static pbm_batchRequest *queuePop(requestQueue *queue) {
+  pbm_batchRequest *request = queue->items[queue->head];
+  queue->head = (queue->head + 1) % queue->capacity;
+  queue->count--;
+  return request;
+}
+
+static size_t takeCompleted(batchState *state, pbm_batchRequest **completed,
+                            size_t maximum) {
+  size_t count = 0;
+  while (count < maximum && 0 != state->completed.count) {
+    completed[count++] = queuePop(&state->completed);
+  }
+  return count;
+}
+
+static pbm_return reserveBuffer(batchSlot *slot, size_t size) {
+  if (size <= slot->capacity) {
+    return PBM_OK;
+  }
+  size_t capacity = (0 != slot->capacity) ? slot->capacity : BATCH_BUFFER_SIZE;
+  while (capacity < size) {
+    if (capacity > SIZE_MAX / 2) {
+      return PBM_SIZE;
+    }
+    capacity *= 2;
+  }
+  uint8_t *buffer = (uint8_t *)realloc(slot->buffer, capacity);
+  if (NULL == buffer) {
+    return PBM_ERROR;
+  }
+  slot->buffer = buffer;
+  slot->capacity = capacity;
+  return PBM_OK;
+}
+
+static pbm_return prepareSave(batchSlot *slot) {
+  const pbm_batchRequest *request = slot->request;
+  size_t size = 0;
+  pbm_return retVal =
+      pbm_encodeToMemoryFormat(&request->image, request->format, NULL, &size);
+  // Without a buffer only the required size is returned
+  if (PBM_SIZE != retVal || 0 == size) {
+    return (PBM_OK == retVal) ? PBM_ERROR : retVal;
+  }
+  retVal = reserveBuffer(slot, size);
+  if (PBM_OK == retVal) {
+    retVal = pbm_encodeToMemoryFormat(&request->image, request->format,
+                                      slot->buffer, &size);
+  }
+  slot->size = size;
+  slot->done = 0;
+  return retVal;
+}
+
+static pbm_return readProgress(batchSlot *slot, size_t bytes,
+                               uint8_t *finished) {
+  *finished = (0 == bytes);
+  slot->done += bytes;
+  if (slot->done < slot->capacity) {
+    return PBM_OK;
+  }
+  // A full buffer, the file may be longer
+  return reserveBuffer(slot, slot->capacity + 1);
+}
+
+static void decodeSlot(batchSlot *slot) {
+  pbm_batchRequest *request = slot->request;
+  if (PBM_OK != slot->result || PBM_BATCH_LOAD != request->operation) {
+    return;
+  }
+  if (NULL == request->conversion) {
+    slot->result = pbm_decodeFromMemory(slot->buffer, slot->done,
+                                        &request->image, PBM_DECODE_COPY,
+                                        NULL);
+  } else {
+    slot->result = pbm_decodeFromMemoryConverted(
+        slot->buffer, slot->done, &request->image, request->conversion, NULL);
+  }
+}
+
+static void finishSlot(batchState *state, batchSlot *slot) {
+  pbm_batchRequest *request = slot->request;
+  request->result = slot->result;
+  slot->request = NULL;
+  slot->stage = STAGE_IDLE;
+  slot->fd = -1;
+  queuePush(&state->completed, request);
+}
+
+static void processBlocking(batchSlot *slot) {
+  pbm_batchRequest *request = slot->request;
+  slot->done = 0;
+  if (PBM_BATCH_SAVE == request->operation) {
+    slot->result = prepareSave(slot);
+    if (PBM_OK != slot->result) {
+      return;
+    }
+    slot->fd = open(request->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    0666);
+  } else {
+    slot->result = reserveBuffer(slot, BATCH_BUFFER_SIZE);
+    if (PBM_OK != slot->result) {
+      return;
+    }
+    slot->fd = open(request->path, O_RDONLY | O_CLOEXEC);
+  }
+  if (slot->fd < 0) {
+    slot->result = PBM_ERROR;
+    return;
+  }
+
+  uint8_t finished = 0;
+  while (PBM_OK == slot->result && !finished) {
+    ssize_t count;
+    if (PBM_BATCH_SAVE == request->operation) {
+      count = write(slot->fd, &slot->buffer[slot->done],
+                    slot->size - slot->done);
+    } else {
+      count = read(slot->fd, &slot->buffer[slot->done],
+                   slot->capacity - slot->done);
+    }
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count < 0 || (0 == count && PBM_BATCH_SAVE == request->operation)) {
+      slot->result = PBM_ERROR;
+    } else if (PBM_BATCH_SAVE == request->operation) {
+      slot->done += (size_t)count;
+      finished = (slot->done == slot->size);
+    } else {
+      slot->result = readProgress(slot, (size_t)count, &finished);
+    }
+  }
+  if (0 != close(slot->fd) && PBM_OK == slot->result) {
+    slot->result = PBM_ERROR;
+  }
+  decodeSlot(slot);
+}
+
+static pbm_return startThreads(batchState *state) {
+  state->threads = (pthread_t *)malloc(state->depth * sizeof(pthread_t));
+  if (NULL == state->threads) {
+    return PBM_ERROR;
+  }
+  if (0 != pthread_mutex_init(&state->lock, NULL)) {
+    free(state->threads);
+    return PBM_ERROR;
+  }
+  pthread_cond_init(&state->work, NULL);
+  pthread_cond_init(&state->done, NULL);
+  state->threaded = 1;
+  for (uint32_t i = 0; i < state->depth; i++) {
+    if (0 != pthread_create(&state->threads[i], NULL, workerThread, state)) {
+      break;
+    }
+    state->threadCount++;
+  }
+  if (state->threadCount != state->depth) {
+    stopThreads(state);
+    return PBM_ERROR;
+  }
+  return PBM_OK;
+}
+
+static void stopThreads(batchState *state) {
+  pthread_mutex_lock(&state->lock);
+  state->stop = 1;
+  pthread_cond_broadcast(&state->work);
+  pthread_mutex_unlock(&state->lock);
+  for (uint32_t i = 0; i < state->threadCount; i++) {
+    pthread_join(state->threads[i], NULL);
+  }
+  pthread_cond_destroy(&state->work);
+  pthread_cond_destroy(&state->done);
+  pthread_mutex_destroy(&state->lock);
+  free(state->threads);
+  state->threads = NULL;
+  state->threadCount = 0;
+}
+
+static void *workerThread(void *argument) {
+  batchState *state = (batchState *)argument;
+  pthread_mutex_lock(&state->lock);
+  batchSlot *slot = &state->slots[state->claimedSlots++];
+  for (;;) {
+    while (!state->stop && 0 == state->pending.count) {
+      pthread_cond_wait(&state->work, &state->lock);
+    }
+    // The pending requests are completed before stopping
+    if (0 == state->pending.count) {
+      break;
+    }
+    slot->request = queuePop(&state->pending);
+    state->active++;
+    // Only the queues are shared, IO and decoding run without the lock
+    pthread_mutex_unlock(&state->lock);
+    processBlocking(slot);
+    pthread_mutex_lock(&state->lock);
+    state->active--;
+    finishSlot(state, slot);
+    pthread_cond_broadcast(&state->done);
+  }
+  pthread_mutex_unlock(&state->lock);
+  return NULL;
+}
+
+#ifdef BATCH_URING
+static pbm_return uringOpen(uringRing *ring, uint32_t entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring->fd < 0) {
+    ring->fd = -1;
+    return PBM_ERROR;
+  }
+
+  // Kernels before 5.6 have no probe and miss the file operations
+  const uint8_t operations[] = {IORING_OP_OPENAT, IORING_OP_READ,
+                                IORING_OP_WRITE, IORING_OP_CLOSE};
+  size_t probeSize = sizeof(struct io_uring_probe) +
+                     IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, probeSize);
+  uint8_t supported =
+      (NULL != probe && 0 == syscall(__NR_io_uring_register, ring->fd,
+                                     IORING_REGISTER_PROBE, probe,
+                                     IORING_OP_LAST));
+  for (uint32_t i = 0; supported && i < sizeof(operations); i++) {
+    supported = (operations[i] <= probe->last_op &&
+                 0 != (probe->ops[operations[i]].flags &
+                       IO_URING_OP_SUPPORTED));
+  }
+  free(probe);
+  if (!supported) {
+    uringClose(ring);
+    return PBM_ERROR;
+  }
+
+  ring->sqMappingSize =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring->cqMappingSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cqMappingSize > ring->sqMappingSize) {
+      ring->sqMappingSize = ring->cqMappingSize;
+    }
+    ring->cqMappingSize = 0;
+  }
+  ring->sqMapping = mmap(NULL, ring->sqMappingSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+  if (MAP_FAILED == ring->sqMapping) {
+    ring->sqMapping = NULL;
+    uringClose(ring);
+    return PBM_ERROR;
+  }
+  ring->cqMapping = ring->sqMapping;
+  if (0 != ring->cqMappingSize) {
+    ring->cqMapping = mmap(NULL, ring->cqMappingSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, ring->fd, IORING_OFF_CQ_RING);
+    if (MAP_FAILED == ring->cqMapping) {
+      ring->cqMapping = NULL;
+      uringClose(ring);
+      return PBM_ERROR;
+    }
+  }
+  ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqesSize,
+                                           PROT_READ | PROT_WRITE, MAP_SHARED,
+                                           ring->fd, IORING_OFF_SQES);
+  if (MAP_FAILED == (void *)ring->sqes) {
+    ring->sqes = NULL;
+    uringClose(ring);
+    return PBM_ERROR;
+  }
+
+  uint8_t *sq = (uint8_t *)ring->sqMapping;
+  uint8_t *cq = (uint8_t *)ring->cqMapping;
+  ring->sqTail = (uint32_t *)&sq[params.sq_off.tail];
+  ring->sqMask = *(uint32_t *)&sq[params.sq_off.ring_mask];
+  ring->sqArray = (uint32_t *)&sq[params.sq_off.array];
+  ring->cqHead = (uint32_t *)&cq[params.cq_off.head];
+  ring->cqTail = (uint32_t *)&cq[params.cq_off.tail];
+  ring->cqMask = *(uint32_t *)&cq[params.cq_off.ring_mask];
+  ring->cqes = (struct io_uring_cqe *)&cq[params.cq_off.cqes];
+  return PBM_OK;
+}
+
+static void uringClose(uringRing *ring) {
+  if (NULL != ring->sqes) {
+    munmap(ring->sqes, ring->sqesSize);
+  }
+  if (NULL != ring->cqMapping && ring->cqMapping != ring->sqMapping) {
+    munmap(ring->cqMapping, ring->cqMappingSize);
+  }
+  if (NULL != ring->sqMapping) {
+    munmap(ring->sqMapping, ring->sqMappingSize);
+  }
+  if (ring->fd >= 0) {
+    close(ring->fd);
+  }
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+static void uringQueue(uringRing *ring, uint8_t opcode, int fd,
+                       const void *address, uint32_t length, uint64_t offset,
+                       uint32_t flags, uint32_t slot) {
+  // Only this thread writes the tail, the kernel reads it on enter
+  uint32_t tail = *ring->sqTail;
+  uint32_t index = tail & ring->sqMask;
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)address;
+  sqe->len = length;
+  sqe->off = offset;
+  sqe->open_flags = flags;
+  sqe->user_data = slot;
+  ring->sqArray[index] = index;
+  __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring->unsubmitted++;
+}
+
+static pbm_return uringEnter(uringRing *ring, uint32_t minimum) {
+  for (;;) {
+    long submitted =
+        syscall(__NR_io_uring_enter, ring->fd, ring->unsubmitted, minimum,
+                (0 != minimum) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (submitted >= 0) {
+      ring->unsubmitted -= (uint32_t)submitted;
+      return PBM_OK;
+    }
+    if (EINTR != errno) {
+      return PBM_ERROR;
+    }
+  }
+}
+
+static void uringFill(batchState *state) {
+  for (uint32_t i = 0; i < state->depth && 0 != state->pending.count; i++) {
+    batchSlot *slot = &state->slots[i];
+    if (NULL != slot->request) {
+      continue;
+    }
+    slot->request = queuePop(&state->pending);
+    slot->done = 0;
+    slot->stage = STAGE_OPEN;
+    if (PBM_BATCH_SAVE == slot->request->operation) {
+      slot->result = prepareSave(slot);
+    } else {
+      slot->result = reserveBuffer(slot, BATCH_BUFFER_SIZE);
+    }
+    if (PBM_OK != slot->result) {
+      finishSlot(state, slot);
+      continue;
+    }
+    state->active++;
+    uringStep(state, i);
+  }
+}
+
+static void uringStep(batchState *state, uint32_t index) {
+  batchSlot *slot = &state->slots[index];
+  size_t length;
+  switch (slot->stage) {
+  case STAGE_OPEN:
+    if (PBM_BATCH_SAVE == slot->request->operation) {
+      uringQueue(&state->ring, IORING_OP_OPENAT, AT_FDCWD,
+                 slot->request->path, 0666, 0,
+                 O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, index);
+    } else {
+      uringQueue(&state->ring, IORING_OP_OPENAT, AT_FDCWD,
+                 slot->request->path, 0, 0, O_RDONLY | O_CLOEXEC, index);
+    }
+    break;
+  case STAGE_READ:
+    length = slot->capacity - slot->done;
+    uringQueue(&state->ring, IORING_OP_READ, slot->fd,
+               &slot->buffer[slot->done],
+               (length < BATCH_MAX_TRANSFER) ? (uint32_t)length
+                                             : BATCH_MAX_TRANSFER,
+               slot->done, 0, index);
+    break;
+  case STAGE_WRITE:
+    length = slot->size - slot->done;
+    uringQueue(&state->ring, IORING_OP_WRITE, slot->fd,
+               &slot->buffer[slot->done],
+               (length < BATCH_MAX_TRANSFER) ? (uint32_t)length
+                                             : BATCH_MAX_TRANSFER,
+               slot->done, 0, index);
+    break;
+  default:
+    uringQueue(&state->ring, IORING_OP_CLOSE, slot->fd, NULL, 0, 0, 0,
+               index);
+    break;
+  }
+}
+
+static void uringComplete(batchState *state, uint32_t index, int32_t result) {
+  batchSlot *slot = &state->slots[index];
+  uint8_t finished = 0;
+  switch (slot->stage) {
+  case STAGE_OPEN:
+    if (result < 0) {
+      slot->result = PBM_ERROR;
+      state->active--;
+      finishSlot(state, slot);
+      return;
+    }
+    slot->fd = result;
+    slot->stage = (PBM_BATCH_SAVE == slot->request->operation) ? STAGE_WRITE
+                                                               : STAGE_READ;
+    break;
+  case STAGE_READ:
+    if (result < 0) {
+      slot->result = PBM_ERROR;
+    } else {
+      slot->result = readProgress(slot, (size_t)result, &finished);
+    }
+    if (PBM_OK != slot->result || finished) {
+      slot->stage = STAGE_CLOSE;
+    }
+    break;
+  case STAGE_WRITE:
+    if (result <= 0) {
+      slot->result = PBM_ERROR;
+    } else {
+      slot->done += (size_t)result;
+    }
+    if (PBM_OK != slot->result || slot->done == slot->size) {
+      slot->stage = STAGE_CLOSE;
+    }
+    break;
+  default:
+    if (result < 0 && PBM_OK == slot->result) {
+      slot->result = PBM_ERROR;
+    }
+    state->active--;
+    decodeSlot(slot);
+    finishSlot(state, slot);
+    return;
+  }
+  uringStep(state, index);
+}
+
+static pbm_return uringProgress(batchState *state, uint8_t wait) {
+  uringRing *ring = &state->ring;
+  for (;;) {
+    uringFill(state);
+    uint32_t minimum =
+        (wait && 0 == state->completed.count && 0 != state->active) ? 1 : 0;
+    if (0 != ring->unsubmitted || 0 != minimum) {
+      if (PBM_OK != uringEnter(ring, minimum)) {
+        return PBM_ERROR;
+      }
+    }
+    // Only this thread moves the head, the kernel moves the tail
+    uint32_t head = *ring->cqHead;
+    uint32_t tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      return PBM_OK;
+    }
+    for (; head != tail; head++) {
+      const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+      uringComplete(state, (uint32_t)cqe->user_data, cqe->res);
+    }
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    // Submit the next steps without waiting
+    wait = 0;
+  }
+}
+#endif
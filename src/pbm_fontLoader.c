@@ -0,0 +1,748 @@
+/**
+ * @file pbm_fontLoader.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Load BDF and PSF fonts at runtime as pbm_font
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pbm_fontLoader.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PSF1_HEADER_SIZE (4)      ///< Size of the PSF1 header
+#define PSF1_MODE_512 (0x01)      ///< PSF1 font with 512 glyphs
+#define PSF1_MODE_TABLE (0x06)    ///< PSF1 font with unicode table
+#define PSF1_SEPARATOR (0xFFFF)   ///< PSF1 end of the glyph unicode entries
+#define PSF1_SEQUENCE (0xFFFE)    ///< PSF1 start of unicode sequences
+#define PSF2_HEADER_SIZE (32)     ///< Minimal size of the PSF2 header
+#define PSF2_FLAG_TABLE (0x01)    ///< PSF2 font with unicode table
+#define PSF2_SEPARATOR (0xFF)     ///< PSF2 end of the glyph unicode entries
+#define PSF2_SEQUENCE (0xFE)      ///< PSF2 start of unicode sequences
+#define BDF_LINE_SIZE (256)       ///< Maximal handled BDF line length
+#define FONT_GLYPHS_8BIT (256)    ///< Glyphs of a font for 8 bit strings
+#define FONT_MAX_SIZE (UINT8_MAX) ///< Maximal font width and height
+#define MEMORY_ALIGNMENT (8)      ///< Alignment of the tables in the memory
+#define REPLACEMENT_CHARACTER (0xFFFD) ///< Unicode replacement character
+
+/**
+ * @brief Codepoint of a glyph for building the glyph map
+ *
+ */
+typedef struct {
+  uint32_t codepoint; ///< Unicode codepoint
+  uint16_t glyph;     ///< Glyph index of the codepoint
+} codepointEntry;
+
+/**
+ * @brief Map a file read only into the memory
+ *
+ * @param fontPath the path to the file
+ * @param data the mapped data
+ * @param size the size of the file
+ * @return pbm_return state of the function
+ */
+static pbm_return mapFile(const char *fontPath, const uint8_t **data,
+                          size_t *size);
+
+/**
+ * @brief Allocate the memory of a converted font
+ *
+ * The glyphs are placed first, followed by the metrics and the glyph map.
+ *
+ * @param loadedFont the font to set the tables
+ * @param dataSize size of the glyph data in bytes
+ * @param glyphs number of glyphs
+ * @param withMetrics allocate the glyph metrics
+ * @param mapCount number of glyph map ranges
+ * @return pbm_return state of the function
+ */
+static pbm_return allocateFont(pbm_loadedFont *loadedFont, size_t dataSize,
+                               uint32_t glyphs, uint8_t withMetrics,
+                               uint32_t mapCount);
+
+/**
+ * @brief Store a glyph line in the font format
+ *
+ * @param pixels the line with the first pixel in the MSB of the first byte
+ * @param width number of pixels
+ * @param alignment the font alignment
+ * @param fontRow the font line to write (zero initialized)
+ */
+static void storeFontRow(const uint8_t *pixels, uint32_t width,
+                         pbm_data_alignment alignment, uint8_t *fontRow);
+
+/**
+ * @brief Compare two codepoint entries for sorting
+ *
+ * @param first first entry
+ * @param second second entry
+ * @return int order of the entries
+ */
+static int compareCodepoints(const void *first, const void *second);
+
+/**
+ * @brief Combine sorted codepoints into glyph map ranges
+ *
+ * Duplicated codepoints keep the first glyph.
+ *
+ * @param entries sorted codepoints
+ * @param count number of codepoints
+ * @param ranges output ranges with count elements or NULL to only count
+ * @return uint32_t number of ranges
+ */
+static uint32_t buildGlyphMap(const codepointEntry *entries, uint32_t count,
+                              pbm_glyphRange *ranges);
+
+/**
+ * @brief Select the default glyph of a font with a glyph map
+ *
+ * @param entries sorted codepoints
+ * @param count number of codepoints
+ * @return uint16_t glyph of the replacement character, '?' or 0
+ */
+static uint16_t defaultGlyph(const codepointEntry *entries, uint32_t count);
+
+/**
+ * @brief Read the PSF unicode table
+ *
+ * @param table the table data
+ * @param size the size of the table
+ * @param glyphs number of glyphs in the font
+ * @param psf2 the table is PSF2 (UTF-8) or PSF1 (UCS-2)
+ * @param entries output codepoints with size elements
+ * @return uint32_t number of codepoints
+ */
+static uint32_t readUnicodeTable(const uint8_t *table, size_t size,
+                                 uint32_t glyphs, uint8_t psf2,
+                                 codepointEntry *entries);
+
+/**
+ * @brief Read a little endian 32 bit value
+ *
+ * @param data the data
+ * @return uint32_t the value
+ */
+static uint32_t readLittleEndian(const uint8_t *data);
+
+/**
+ * @brief Copy the next line of a BDF file
+ *
+ * @param position the read position, moved to the next line
+ * @param end the end of the file
+ * @param line output line, terminated with '\0'
+ * @return int 1 if a line was read, 0 at the end of the file
+ */
+static int nextLine(const char **position, const char *end, char *line);
+
+/**
+ * @brief Check the keyword at the beginning of a BDF line
+ *
+ * @param line the line
+ * @param keyword the keyword
+ * @return int 1 if the line starts with the keyword
+ */
+static int isKeyword(const char *line, const char *keyword);
+
+/**
+ * @brief Convert a hexadecimal character
+ *
+ * @param character the character
+ * @return uint8_t the value, 0 for invalid characters
+ */
+static uint8_t hexValue(char character);
+
+pbm_return pbm_loadFontPSF(const char *fontPath,
+                           pbm_data_alignment alignment,
+                           pbm_loadedFont *loadedFont) {
+  if (NULL == fontPath || NULL == loadedFont) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_DATA_HORIZONTAL_MSB != alignment &&
+      PBM_DATA_HORIZONTAL_LSB != alignment) {
+    return PBM_ARGUMENTS;
+  }
+  memset(loadedFont, 0, sizeof(*loadedFont));
+
+  const uint8_t *data = NULL;
+  size_t size = 0;
+  pbm_return ret = mapFile(fontPath, &data, &size);
+  if (PBM_OK != ret) {
+    return ret;
+  }
+  loadedFont->mapping = (void *)data;
+  loadedFont->mappingSize = size;
+
+  uint32_t headerSize = 0;
+  uint32_t glyphs = 0;
+  uint32_t glyphSize = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint8_t hasTable = 0;
+  uint8_t psf2 = 0;
+  if (size >= PSF1_HEADER_SIZE && 0x36 == data[0] && 0x04 == data[1]) {
+    headerSize = PSF1_HEADER_SIZE;
+    glyphs = (data[2] & PSF1_MODE_512) ? 512 : 256;
+    hasTable = (0 != (data[2] & PSF1_MODE_TABLE));
+    glyphSize = data[3];
+    width = 8;
+    height = data[3];
+  } else if (size >= PSF2_HEADER_SIZE && 0x72 == data[0] && 0xB5 == data[1] &&
+             0x4A == data[2] && 0x86 == data[3]) {
+    psf2 = 1;
+    headerSize = readLittleEndian(&data[8]);
+    hasTable = (0 != (readLittleEndian(&data[12]) & PSF2_FLAG_TABLE));
+    glyphs = readLittleEndian(&data[16]);
+    glyphSize = readLittleEndian(&data[20]);
+    height = readLittleEndian(&data[24]);
+    width = readLittleEndian(&data[28]);
+  } else {
+    pbm_unloadFont(loadedFont);
+    return PBM_ERROR;
+  }
+
+  uint32_t rowBytes = (width + 7) / 8;
+  if (0 == width || width > FONT_MAX_SIZE || 0 == height ||
+      height > FONT_MAX_SIZE || glyphSize != rowBytes * height ||
+      0 == glyphs || glyphs > UINT16_MAX || headerSize < PSF1_HEADER_SIZE ||
+      headerSize > size || (size - headerSize) / glyphSize < glyphs) {
+    pbm_unloadFont(loadedFont);
+    return PBM_SIZE;
+  }
+  const uint8_t *glyphData = &data[headerSize];
+  const uint8_t *table = &glyphData[(size_t)glyphs * glyphSize];
+  size_t tableSize = hasTable ? (size_t)(&data[size] - table) : 0;
+
+  // Codepoints of the glyphs for the glyph map
+  codepointEntry *entries = NULL;
+  uint32_t entryCount = 0;
+  if (tableSize > 0) {
+    entries = malloc(tableSize * sizeof(codepointEntry));
+    if (NULL == entries) {
+      pbm_unloadFont(loadedFont);
+      return PBM_ERROR;
+    }
+    entryCount = readUnicodeTable(table, tableSize, glyphs, psf2, entries);
+    qsort(entries, entryCount, sizeof(codepointEntry), compareCodepoints);
+  }
+  uint32_t mapCount = buildGlyphMap(entries, entryCount, NULL);
+  if (0 == entryCount && glyphs > FONT_GLYPHS_8BIT) {
+    // Glyphs beyond 8 bit are only reachable with a glyph map
+    mapCount = 1;
+  }
+  if (mapCount > UINT16_MAX) {
+    free(entries);
+    pbm_unloadFont(loadedFont);
+    return PBM_SIZE;
+  }
+
+  // Without a glyph map every 8 bit character indexes the glyphs directly,
+  // missing glyphs are padded with empty glyphs like in BDF fonts
+  uint32_t fontGlyphs =
+      (0 == mapCount && glyphs < FONT_GLYPHS_8BIT) ? FONT_GLYPHS_8BIT : glyphs;
+  uint8_t zeroCopy = (8 == width && PBM_DATA_HORIZONTAL_MSB == alignment &&
+                      fontGlyphs == glyphs);
+  ret = allocateFont(loadedFont, zeroCopy ? 0 : (size_t)fontGlyphs * glyphSize,
+                     fontGlyphs, 0, mapCount);
+  if (PBM_OK != ret) {
+    free(entries);
+    pbm_unloadFont(loadedFont);
+    return ret;
+  }
+  pbm_font *font = &loadedFont->font;
+  font->width = (uint8_t)width;
+  font->height = (uint8_t)height;
+  font->alignment = alignment;
+
+  if (zeroCopy) {
+    // The PSF lines are equal to the font lines
+    font->fontData = glyphData;
+  } else {
+    uint8_t *fontData = (uint8_t *)font->fontData;
+    for (uint32_t line = 0; line < glyphs * height; line++) {
+      storeFontRow(&glyphData[line * rowBytes], width, alignment,
+                   &fontData[line * rowBytes]);
+    }
+  }
+
+  if (mapCount > 0) {
+    pbm_glyphRange *map = (pbm_glyphRange *)font->glyphMap;
+    if (entryCount > 0) {
+      buildGlyphMap(entries, entryCount, map);
+      font->defaultGlyph = defaultGlyph(entries, entryCount);
+    } else {
+      map[0].first = 0;
+      map[0].count = (uint16_t)glyphs;
+      map[0].glyph = 0;
+    }
+  }
+  free(entries);
+
+  if (!zeroCopy) {
+    munmap(loadedFont->mapping, loadedFont->mappingSize);
+    loadedFont->mapping = NULL;
+    loadedFont->mappingSize = 0;
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_loadFontBDF(const char *fontPath,
+                           pbm_data_alignment alignment,
+                           pbm_loadedFont *loadedFont) {
+  if (NULL == fontPath || NULL == loadedFont) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_DATA_HORIZONTAL_MSB != alignment &&
+      PBM_DATA_HORIZONTAL_LSB != alignment) {
+    return PBM_ARGUMENTS;
+  }
+  memset(loadedFont, 0, sizeof(*loadedFont));
+
+  const uint8_t *data = NULL;
+  size_t size = 0;
+  pbm_return ret = mapFile(fontPath, &data, &size);
+  if (PBM_OK != ret) {
+    return ret;
+  }
+  const char *start = (const char *)data;
+  const char *end = start + size;
+  const char *position = start;
+  char line[BDF_LINE_SIZE];
+
+  // First pass: font bounding box and encodings
+  int cellWidth = 0;
+  int cellHeight = 0;
+  int cellX = 0;
+  int cellY = 0;
+  uint32_t glyphs = 0;
+  int maxEncoding = -1;
+  uint8_t proportional = 0;
+  while (nextLine(&position, end, line)) {
+    if (isKeyword(line, "FONTBOUNDINGBOX")) {
+      sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &cellWidth, &cellHeight,
+             &cellX, &cellY);
+    } else if (isKeyword(line, "ENCODING")) {
+      int encoding = -1;
+      sscanf(line, "ENCODING %d", &encoding);
+      if (encoding >= 0) {
+        glyphs++;
+        maxEncoding = (encoding > maxEncoding) ? encoding : maxEncoding;
+      }
+    } else if (isKeyword(line, "DWIDTH")) {
+      int advance = 0;
+      sscanf(line, "DWIDTH %d", &advance);
+      proportional |= (advance != cellWidth);
+    }
+  }
+  if (cellWidth <= 0 || cellWidth > FONT_MAX_SIZE || cellHeight <= 0 ||
+      cellHeight > FONT_MAX_SIZE || 0 == glyphs || glyphs > UINT16_MAX) {
+    munmap((void *)data, size);
+    return PBM_SIZE;
+  }
+
+  // Encodings up to 255 are used as glyph index for 8 bit strings
+  uint8_t directIndex = (maxEncoding < FONT_GLYPHS_8BIT);
+  codepointEntry *entries = NULL;
+  if (directIndex) {
+    glyphs = FONT_GLYPHS_8BIT;
+  } else {
+    entries = malloc(glyphs * sizeof(codepointEntry));
+    if (NULL == entries) {
+      munmap((void *)data, size);
+      return PBM_ERROR;
+    }
+  }
+  uint32_t rowBytes = ((uint32_t)cellWidth + 7) / 8;
+
+  // Second pass: place the glyphs into the cells. The glyph map has to be
+  // known for the allocation, the glyphs are first collected in a buffer.
+  uint8_t *pixels = calloc((size_t)glyphs * cellHeight, rowBytes);
+  pbm_glyphMetrics *metrics =
+      proportional ? calloc(glyphs, sizeof(pbm_glyphMetrics)) : NULL;
+  if (NULL == pixels || (proportional && NULL == metrics)) {
+    free(pixels);
+    free(metrics);
+    free(entries);
+    munmap((void *)data, size);
+    return PBM_ERROR;
+  }
+  int originColumn = (-cellX > 0) ? -cellX : 0;
+  originColumn = (originColumn < cellWidth) ? originColumn : cellWidth - 1;
+  uint32_t glyphCount = 0;
+  uint32_t glyph = 0;
+  int encoding = -1;
+  int advance = cellWidth;
+  int boxWidth = 0;
+  int boxHeight = 0;
+  int boxX = 0;
+  int boxY = 0;
+  int bitmapLine = -1;
+  position = start;
+  while (nextLine(&position, end, line)) {
+    if (isKeyword(line, "STARTCHAR")) {
+      encoding = -1;
+      advance = cellWidth;
+      boxWidth = 0;
+      boxHeight = 0;
+      boxX = 0;
+      boxY = 0;
+      bitmapLine = -1;
+    } else if (isKeyword(line, "ENCODING")) {
+      sscanf(line, "ENCODING %d", &encoding);
+      if (encoding >= 0) {
+        glyph = directIndex ? (uint32_t)encoding : glyphCount;
+        if (!directIndex) {
+          entries[glyphCount].codepoint = (uint32_t)encoding;
+          entries[glyphCount].glyph = (uint16_t)glyphCount;
+        }
+        glyphCount++;
+        if (proportional) {
+          // Ink is measured from the origin while the bitmap is read
+          metrics[glyph].leftBearing = (uint8_t)originColumn;
+        }
+      }
+    } else if (isKeyword(line, "DWIDTH")) {
+      sscanf(line, "DWIDTH %d", &advance);
+    } else if (isKeyword(line, "BBX")) {
+      sscanf(line, "BBX %d %d %d %d", &boxWidth, &boxHeight, &boxX, &boxY);
+    } else if (isKeyword(line, "BITMAP")) {
+      bitmapLine = 0;
+    } else if (isKeyword(line, "ENDCHAR")) {
+      if (encoding >= 0 && proportional) {
+        // Draw the columns of the device width from the glyph origin
+        pbm_glyphMetrics *metric = &metrics[glyph];
+        int drawn = cellWidth - originColumn;
+        metric->advance = (uint8_t)((advance < 0) ? 0
+                                    : (advance < drawn) ? advance
+                                                        : drawn);
+        if (metric->inkWidth > metric->advance) {
+          metric->inkWidth = metric->advance;
+        }
+      }
+      bitmapLine = -1;
+    } else if (bitmapLine >= 0 && encoding >= 0) {
+      // Bitmap line with the first pixel in the MSB
+      int row = (cellHeight + cellY) - (boxY + boxHeight) + bitmapLine;
+      int column = boxX - cellX;
+      bitmapLine++;
+      if (row < 0 || row >= cellHeight) {
+        continue;
+      }
+      uint8_t *cellRow = &pixels[((size_t)glyph * cellHeight + row) * rowBytes];
+      for (int i = 0; i < boxWidth && '\0' != line[i / 4]; i++) {
+        uint8_t nibble = hexValue(line[i / 4]);
+        int x = column + i;
+        if (0 == (nibble & (0x08 >> (i % 4))) || x < 0 || x >= cellWidth) {
+          continue;
+        }
+        cellRow[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+        if (proportional && x >= metrics[glyph].leftBearing &&
+            x - metrics[glyph].leftBearing + 1 > metrics[glyph].inkWidth) {
+          metrics[glyph].inkWidth =
+              (uint8_t)(x - metrics[glyph].leftBearing + 1);
+        }
+      }
+    }
+  }
+  munmap((void *)data, size);
+
+  uint32_t mapCount = 0;
+  if (!directIndex) {
+    qsort(entries, glyphCount, sizeof(codepointEntry), compareCodepoints);
+    mapCount = buildGlyphMap(entries, glyphCount, NULL);
+  }
+  ret = allocateFont(loadedFont, (size_t)glyphs * cellHeight * rowBytes,
+                     glyphs, proportional, mapCount);
+  if (PBM_OK != ret) {
+    free(pixels);
+    free(metrics);
+    free(entries);
+    return ret;
+  }
+  pbm_font *font = &loadedFont->font;
+  font->width = (uint8_t)cellWidth;
+  font->height = (uint8_t)cellHeight;
+  font->alignment = alignment;
+  uint8_t *fontData = (uint8_t *)font->fontData;
+  for (uint32_t i = 0; i < glyphs * (uint32_t)cellHeight; i++) {
+    storeFontRow(&pixels[i * rowBytes], (uint32_t)cellWidth, alignment,
+                 &fontData[i * rowBytes]);
+  }
+  if (proportional) {
+    memcpy((void *)font->metrics, metrics, glyphs * sizeof(pbm_glyphMetrics));
+  }
+  if (directIndex) {
+    font->defaultGlyph = '?';
+  } else {
+    buildGlyphMap(entries, glyphCount, (pbm_glyphRange *)font->glyphMap);
+    font->defaultGlyph = defaultGlyph(entries, glyphCount);
+  }
+  free(pixels);
+  free(metrics);
+  free(entries);
+  return PBM_OK;
+}
+
+void pbm_unloadFont(pbm_loadedFont *loadedFont) {
+  if (NULL == loadedFont) {
+    return;
+  }
+  if (NULL != loadedFont->mapping) {
+    munmap(loadedFont->mapping, loadedFont->mappingSize);
+  }
+  free(loadedFont->memory);
+  memset(loadedFont, 0, sizeof(*loadedFont));
+}
+
+static pbm_return mapFile(const char *fontPath, const uint8_t **data,
+                          size_t *size) {
+  int file = open(fontPath, O_RDONLY);
+  if (file < 0) {
+    printf("ERROR, could not load %s\n", fontPath);
+    return PBM_ERROR;
+  }
+  struct stat status;
+  if (0 != fstat(file, &status) || status.st_size <= 0) {
+    close(file);
+    return PBM_ERROR;
+  }
+  void *mapping =
+      mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (MAP_FAILED == mapping) {
+    return PBM_ERROR;
+  }
+  *data = mapping;
+  *size = (size_t)status.st_size;
+  return PBM_OK;
+}
+
+static pbm_return allocateFont(pbm_loadedFont *loadedFont, size_t dataSize,
+                               uint32_t glyphs, uint8_t withMetrics,
+                               uint32_t mapCount) {
+  // Tables are placed aligned after the glyphs
+  size_t metricsOffset =
+      (dataSize + MEMORY_ALIGNMENT - 1) / MEMORY_ALIGNMENT * MEMORY_ALIGNMENT;
+  size_t metricsSize = withMetrics ? glyphs * sizeof(pbm_glyphMetrics) : 0;
+  size_t mapOffset = (metricsOffset + metricsSize + MEMORY_ALIGNMENT - 1) /
+                     MEMORY_ALIGNMENT * MEMORY_ALIGNMENT;
+  size_t memorySize = mapOffset + mapCount * sizeof(pbm_glyphRange);
+  if (0 == memorySize) {
+    return PBM_OK;
+  }
+  uint8_t *memory = calloc(1, memorySize);
+  if (NULL == memory) {
+    return PBM_ERROR;
+  }
+  loadedFont->memory = memory;
+  pbm_font *font = &loadedFont->font;
+  if (dataSize > 0) {
+    font->fontData = memory;
+  }
+  if (withMetrics) {
+    font->metrics = (const pbm_glyphMetrics *)&memory[metricsOffset];
+  }
+  if (mapCount > 0) {
+    font->glyphMap = (const pbm_glyphRange *)&memory[mapOffset];
+    font->glyphMapCount = (uint16_t)mapCount;
+  }
+  return PBM_OK;
+}
+
+static void storeFontRow(const uint8_t *pixels, uint32_t width,
+                         pbm_data_alignment alignment, uint8_t *fontRow) {
+  uint32_t rowBytes = (width + 7) / 8;
+  uint32_t padding = rowBytes * 8 - width;
+  for (uint32_t i = 0; i < width; i++) {
+    if (0 == (pixels[i / 8] & (0x80 >> (i % 8)))) {
+      continue;
+    }
+    // Font lines are little endian values of the line bytes
+    uint32_t bit =
+        (PBM_DATA_HORIZONTAL_MSB == alignment) ? width - 1 - i : i + padding;
+    fontRow[bit / 8] |= (uint8_t)(1 << (bit % 8));
+  }
+}
+
+static int compareCodepoints(const void *first, const void *second) {
+  const codepointEntry *a = first;
+  const codepointEntry *b = second;
+  if (a->codepoint != b->codepoint) {
+    return (a->codepoint < b->codepoint) ? -1 : 1;
+  }
+  return (int)a->glyph - (int)b->glyph;
+}
+
+static uint32_t buildGlyphMap(const codepointEntry *entries, uint32_t count,
+                              pbm_glyphRange *ranges) {
+  uint32_t rangeCount = 0;
+  pbm_glyphRange current = {0};
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t next = current.first + current.count;
+    if (rangeCount > 0 && entries[i].codepoint < next) {
+      // Duplicated codepoint
+      continue;
+    }
+    if (rangeCount > 0 && entries[i].codepoint == next &&
+        entries[i].glyph == current.glyph + current.count &&
+        current.count < UINT16_MAX) {
+      current.count++;
+    } else {
+      if (rangeCount > 0 && NULL != ranges) {
+        ranges[rangeCount - 1] = current;
+      }
+      current.first = entries[i].codepoint;
+      current.count = 1;
+      current.glyph = entries[i].glyph;
+      rangeCount++;
+    }
+  }
+  if (rangeCount > 0 && NULL != ranges) {
+    ranges[rangeCount - 1] = current;
+  }
+  return rangeCount;
+}
+
+static uint16_t defaultGlyph(const codepointEntry *entries, uint32_t count) {
+  uint16_t glyph = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (REPLACEMENT_CHARACTER == entries[i].codepoint) {
+      return entries[i].glyph;
+    }
+    if ('?' == entries[i].codepoint) {
+      glyph = entries[i].glyph;
+    }
+  }
+  return glyph;
+}
+
+static uint32_t readUnicodeTable(const uint8_t *table, size_t size,
+                                 uint32_t glyphs, uint8_t psf2,
+                                 codepointEntry *entries) {
+  uint32_t count = 0;
+  uint32_t glyph = 0;
+  uint8_t sequence = 0;
+  size_t i = 0;
+  while (i < size && glyph < glyphs) {
+    uint32_t codepoint = 0;
+    if (!psf2) {
+      if (i + 1 >= size) {
+        break;
+      }
+      codepoint = table[i] | ((uint32_t)table[i + 1] << 8);
+      i += 2;
+      if (PSF1_SEPARATOR == codepoint) {
+        glyph++;
+        sequence = 0;
+        continue;
+      }
+      if (PSF1_SEQUENCE == codepoint) {
+        sequence = 1;
+      }
+    } else {
+      uint8_t byte = table[i++];
+      if (PSF2_SEPARATOR == byte) {
+        glyph++;
+        sequence = 0;
+        continue;
+      }
+      if (PSF2_SEQUENCE == byte) {
+        sequence = 1;
+        continue;
+      }
+      // UTF-8 character
+      uint32_t following = 0;
+      if (byte < 0x80) {
+        codepoint = byte;
+      } else if (0xC0 == (byte & 0xE0)) {
+        codepoint = byte & 0x1F;
+        following = 1;
+      } else if (0xE0 == (byte & 0xF0)) {
+        codepoint = byte & 0x0F;
+        following = 2;
+      } else if (0xF0 == (byte & 0xF8)) {
+        codepoint = byte & 0x07;
+        following = 3;
+      } else {
+        continue;
+      }
+      for (; following > 0 && i < size && 0x80 == (table[i] & 0xC0);
+           following--) {
+        codepoint = (codepoint << 6) | (table[i++] & 0x3F);
+      }
+      if (following > 0) {
+        continue;
+      }
+    }
+    // Sequences of combined characters are not supported
+    if (!sequence) {
+      entries[count].codepoint = codepoint;
+      entries[count].glyph = (uint16_t)glyph;
+      count++;
+    }
+  }
+  return count;
+}
+
+static uint32_t readLittleEndian(const uint8_t *data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static int nextLine(const char **position, const char *end, char *line) {
+  if (*position >= end) {
+    return 0;
+  }
+  size_t length = 0;
+  while (*position < end && '\n' != **position) {
+    if (length < BDF_LINE_SIZE - 1 && '\r' != **position) {
+      line[length++] = **position;
+    }
+    (*position)++;
+  }
+  if (*position < end) {
+    (*position)++;
+  }
+  line[length] = '\0';
+  return 1;
+}
+
+static int isKeyword(const char *line, const char *keyword) {
+  size_t length = strlen(keyword);
+  return 0 == strncmp(line, keyword, length) &&
+         ('\0' == line[length] || ' ' == line[length]);
+}
+
+static uint8_t hexValue(char character) {
+  if (character >= '0' && character <= '9') {
+    return (uint8_t)(character - '0');
+  }
+  if (character >= 'A' && character <= 'F') {
+    return (uint8_t)(character - 'A' + 10);
+  }
+  if (character >= 'a' && character <= 'f') {
+    return (uint8_t)(character - 'a' + 10);
+  }
+  return 0;
+}
@@ -34,79 +34,638 @@
 #include <string.h>
 
 #define CHARACTER_GAP (1)         ///< Character gap for writing a string
+#define LINE_GAP (1)              ///< Line gap for writing a text box
 #define IMAGE_BUFFER_BIT_SIZE (8) ///< Image buffer bit size per element
 
+#define FONT_ROW_BUFFER_SIZE (32) ///< Bytes of a decoded font line (255 bit)
+#define SCALED_ROW_BUFFER_SIZE                                                 \
+  (FONT_ROW_BUFFER_SIZE * PBM_TEXT_SCALE_MAX) ///< Bytes of a scaled font line
+#define BYTE_VALUES (256) ///< Number of different byte values
+#ifdef PBM_IMAGE_ALIGNMENT
+#define IMAGE_ALIGNMENT(image)                                                 \
+  (PBM_IMAGE_ALIGNMENT) ///< Compile time alignment of all images
+#else
+#define IMAGE_ALIGNMENT(image) ((image)->alignment) ///< Alignment of an image
+#endif
+#define ITALIC_SLOPE (4)  ///< Glyph lines per pixel shift of italic text
+#define TEXT_EMPHASIS_MASK                                                     \
+  (PBM_TEXT_BOLD | PBM_TEXT_ITALIC | PBM_TEXT_UNDERLINE |                      \
+   PBM_TEXT_STRIKE) ///< All emphasis flags
+
+#if PBM_TEXT_SCALE_MAX > 8
+#error "The bit replication tables support scale factors up to 8"
+#endif
+#define SCALE_BIT(value, bit, factor)                                          \
+  ((uint64_t)(((value) >> (7 - (bit))) & 1)                                    \
+   << ((7 - (bit)) * (factor))) *                                              \
+      (((uint64_t)1 << (factor)) - 1) ///< Replicated bit of a byte value
+#define SCALE_ENTRY(value, factor)                                             \
+  (SCALE_BIT(value, 0, factor) | SCALE_BIT(value, 1, factor) |                 \
+   SCALE_BIT(value, 2, factor) | SCALE_BIT(value, 3, factor) |                 \
+   SCALE_BIT(value, 4, factor) | SCALE_BIT(value, 5, factor) |                 \
+   SCALE_BIT(value, 6, factor) |                                               \
+   SCALE_BIT(value, 7, factor)) ///< Replicated bits of a byte value
+#define SCALE_ENTRIES_4(value, factor)                                         \
+  SCALE_ENTRY((value), factor), SCALE_ENTRY((value) + 1, factor),              \
+      SCALE_ENTRY((value) + 2, factor),                                        \
+      SCALE_ENTRY((value) + 3, factor) ///< Replicated bits of 4 byte values
+#define SCALE_ENTRIES_16(value, factor)                                        \
+  SCALE_ENTRIES_4((value), factor), SCALE_ENTRIES_4((value) + 4, factor),      \
+      SCALE_ENTRIES_4((value) + 8, factor),                                    \
+      SCALE_ENTRIES_4((value) + 12, factor) ///< Replicated bits of 16 values
+#define SCALE_ENTRIES_64(value, factor)                                        \
+  SCALE_ENTRIES_16((value), factor), SCALE_ENTRIES_16((value) + 16, factor),   \
+      SCALE_ENTRIES_16((value) + 32, factor),                                  \
+      SCALE_ENTRIES_16((value) + 48, factor) ///< Replicated bits of 64 values
+#define SCALE_TABLE(factor)                                                    \
+  {SCALE_ENTRIES_64(0, factor), SCALE_ENTRIES_64(64, factor),                  \
+   SCALE_ENTRIES_64(128, factor),                                              \
+   SCALE_ENTRIES_64(192, factor)} ///< Replicated bits of all byte values
+
 /**
- * @brief function pointer to set offsets for bytes and bites
+ * @brief Bit replication tables of all scale factors from 2 up to
+ * PBM_TEXT_SCALE_MAX, built at compile time
  *
- * @param uint32_t index the current line index
- * @param pbm_font font handler to get the width or height
+ * Every byte value expands to factor bytes, stored in the low bytes of the
+ * entry with the first byte as most significant byte.
  */
-typedef uint32_t (*offsetCalculation)(uint32_t, const pbm_font *);
+static const uint64_t bitScaleTables[][BYTE_VALUES] = {
+    SCALE_TABLE(2), SCALE_TABLE(3), SCALE_TABLE(4), SCALE_TABLE(5),
+    SCALE_TABLE(6), SCALE_TABLE(7), SCALE_TABLE(8)};
 
 /**
- * @brief byte offset calculation for horizontal MSB data
+ * @brief Empty font line to draw the background of packed glyphs
  *
- * @param index current horizontal data index
- * @param font the current used font
- * @return uint32_t the calculated byte offset
  */
-uint32_t byteOffset_horizontalMSB(uint32_t index, const pbm_font *font);
+static const uint8_t emptyFontRow[FONT_ROW_BUFFER_SIZE] = {0};
 
 /**
- * @brief byte offset calculation for horizontal LSB data
+ * @brief Position of the line by line decoding of a packed glyph
  *
- * @param index current horizontal data index
- * @param font the current used font
- * @return uint32_t the calculated byte offset
+ * A zero initialized cursor starts at the first line record of the glyph.
  */
-uint32_t byteOffset_horizontalLSB(uint32_t index, const pbm_font *font);
+typedef struct {
+  uint32_t nextLine; ///< Next line record to read
+  uint32_t bit;      ///< Bit position of the next line record
+  uint32_t rowBit;   ///< Bit position of the pixels of the last read line
+} fontRowCursor;
 
 /**
- * @brief bit offset calculation for horizontal MSB data
+ * @brief Check if the font can be used to write text
  *
- * @param index current horizontal data index
- * @param font the current used font
- * @return uint32_t the calculated byte offset
+ * @param font the font to check
+ * @return pbm_return PBM_OK for a valid font
  */
-uint32_t bitOffset_horizontalMSB(uint32_t index, const pbm_font *font);
+static pbm_return checkFont(const pbm_font *font);
 
 /**
- * @brief bit offset calculation for horizontal LSB data
+ * @brief Check if the text style is valid for the font
  *
- * @param index current horizontal data index
- * @param font the current used font
- * @return uint32_t the calculated byte offset
+ * @param font the font to write
+ * @param style the style to check or NULL
+ * @return pbm_return PBM_OK for a valid style
  */
-uint32_t bitOffset_horizontalLSB(uint32_t index, const pbm_font *font);
+static pbm_return checkStyle(const pbm_font *font, const pbm_textStyle *style);
 
-pbm_return pbm_fill(pbm_image *imageHandler, pbm_colors color) {
-  if (NULL == imageHandler || color > PBM_BLACK) {
-    return PBM_ARGUMENTS;
-  }
+/**
+ * @brief Get the size of the box around a rotated line
+ *
+ * @param style the text style or NULL
+ * @param lineWidth the width of the upright line
+ * @param lineHeight the height of the upright line
+ * @param boxWidth output width of the rotated line
+ * @param boxHeight output height of the rotated line
+ */
+static void lineBox(const pbm_textStyle *style, uint32_t lineWidth,
+                    uint32_t lineHeight, uint32_t *boxWidth,
+                    uint32_t *boxHeight);
+
+/**
+ * @brief Get the scale factor of a text style
+ *
+ * @param style the text style or NULL
+ * @return uint32_t the scale factor, at least 1
+ */
+static uint32_t textScale(const pbm_textStyle *style);
+
+/**
+ * @brief Scale a font line with the first pixel in the MSB horizontally
+ *
+ * @param src the line to scale
+ * @param bits number of pixels of the line
+ * @param factor the scale factor (1 - PBM_TEXT_SCALE_MAX)
+ * @param dst the scaled line with bits * factor pixels
+ */
+static void scaleRow(const uint8_t *src, uint32_t bits, uint32_t factor,
+                     uint8_t *dst);
+
+/**
+ * @brief Double a font line with the Scale2x (EPX) rules
+ *
+ * @param previous the line above or an empty line
+ * @param current the line to double
+ * @param next the line below or an empty line
+ * @param width number of pixels of the line
+ * @param top output upper line with 2 * width pixels
+ * @param bottom output lower line with 2 * width pixels
+ */
+static void smoothRow(const uint8_t *previous, const uint8_t *current,
+                      const uint8_t *next, uint32_t width, uint8_t *top,
+                      uint8_t *bottom);
+
+/**
+ * @brief Reverse the bit order of a byte
+ *
+ * @param value the byte to reverse
+ * @return uint8_t the reversed byte
+ */
+static uint8_t reverseByte(uint8_t value);
+
+/**
+ * @brief Read up to 8 bits from a MSB first packed bit stream
+ *
+ * @param src the bit stream
+ * @param bitIndex index of the first bit to read
+ * @param count number of bits to read (1 - 8)
+ * @return uint8_t the bits right aligned
+ */
+static uint8_t readBits(const uint8_t *src, uint32_t bitIndex, uint32_t count);
+
+/**
+ * @brief Read one pixel of an image in its own data alignment
+ *
+ * @param image the image to read
+ * @param x position in x, must be inside the image
+ * @param y position in y, must be inside the image
+ * @return uint8_t 1 if the pixel is set, 0 otherwise
+ */
+static uint8_t bitmapPixel(const pbm_image *image, uint32_t x, uint32_t y);
+
+/**
+ * @brief Write a line of pixels from a MSB first packed bit stream into the
+ * image
+ *
+ * The line must be inside the image. Set bits are written in the color, unset
+ * bits with the inverted color or, if transparent, not at all.
+ *
+ * @param imageHandler the image to write
+ * @param x start position in x
+ * @param y position in y
+ * @param src the bit stream with the pixels
+ * @param srcBit index of the first bit in the stream
+ * @param count number of pixels
+ * @param color the desired color
+ * @param transparent only write the set bits
+ */
+static void writeSpan(pbm_image *imageHandler, uint32_t x, uint32_t y,
+                      const uint8_t *src, uint32_t srcBit, uint32_t count,
+                      pbm_colors color, uint8_t transparent);
+
+/**
+ * @brief Clip a line of pixels to the image and write it with writeSpan
+ *
+ * Positions left or above of the image are given as wrapped around unsigned
+ * values, the same way as pbm_setPixel receives them.
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x start position in x
+ * @param y position in y
+ * @param src the bit stream with the pixels
+ * @param srcBit index of the first bit in the stream
+ * @param count number of pixels
+ * @param color the desired color
+ * @param transparent only write the set bits
+ */
+static void blitRow(pbm_image *imageHandler, const pbm_rect *clip, uint32_t x,
+                    uint32_t y, const uint8_t *src, uint32_t srcBit,
+                    uint32_t count, pbm_colors color, uint8_t transparent);
+
+/**
+ * @brief Clip a vertical bitmap to the image and write it page by page
+ *
+ * The bitmap must have the vertical alignment of the image. Every byte of the
+ * bitmap is shifted to the line of the position and written into the two
+ * covered bytes of the image. Positions left or above of the image are given
+ * as wrapped around unsigned values.
+ *
+ * @param imageHandler the image to write
+ * @param x start position in x
+ * @param y start position in y
+ * @param bitmap the bitmap with the pixels
+ * @param color the desired color
+ * @param transparent only write the set bits
+ */
+static void blitPages(pbm_image *imageHandler, uint32_t x, uint32_t y,
+                      const pbm_image *bitmap, pbm_colors color,
+                      uint8_t transparent);
+
+/**
+ * @brief Get the bits of a byte in a line of pixels inside a pixel range
+ *
+ * @param byte index of the byte in the line
+ * @param start first pixel of the range
+ * @param end pixel after the range
+ * @param msb first pixel of a byte in the most significant bit
+ * @return uint8_t the bit mask
+ */
+static uint8_t rangeMask(uint32_t byte, uint32_t start, uint32_t end,
+                         uint8_t msb);
+
+/**
+ * @brief Set a pixel range of a line to a color
+ *
+ * The line is a row of a horizontal or a column of a vertical image, the
+ * bytes of the line are step bytes apart.
+ *
+ * @param line the first byte of the line
+ * @param step distance between two bytes of the line
+ * @param msb first pixel of a byte in the most significant bit
+ * @param start first pixel of the range
+ * @param length number of pixels
+ * @param color the desired color
+ */
+static void fillLine(uint8_t *line, uint32_t step, uint8_t msb,
+                     uint32_t start, uint32_t length, pbm_colors color);
+
+/**
+ * @brief Shift a pixel range along a line with funnel shifts of byte pairs
+ *
+ * @param line the first byte of the line
+ * @param step distance between two bytes of the line
+ * @param msb first pixel of a byte in the most significant bit
+ * @param start first pixel of the range
+ * @param length number of pixels, larger than the shift
+ * @param shift distance to higher pixel positions, negative to lower
+ * @param fill the color of the uncovered pixels
+ */
+static void shiftLine(uint8_t *line, uint32_t step, uint8_t msb,
+                      uint32_t start, uint32_t length, int32_t shift,
+                      pbm_colors fill);
+
+/**
+ * @brief Copy the bytes of a pixel range between two lines, only the bits of
+ * the mask are changed in the first and last byte
+ *
+ * @param dst the first byte of the range in the destination line
+ * @param src the first byte of the range in the source line
+ * @param bytes number of bytes
+ * @param firstMask bits of the range in the first byte
+ * @param lastMask bits of the range in the last byte
+ */
+static void copyRange(uint8_t *dst, const uint8_t *src, uint32_t bytes,
+                      uint8_t firstMask, uint8_t lastMask);
+
+/**
+ * @brief Decode one line of a glyph into a MSB first packed bit stream
+ *
+ * The line records of a packed glyph are only read forward from the cursor,
+ * decoding the lines in ascending order reads every record once.
+ *
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @param line the line of the glyph
+ * @param cursor decoding position in the glyph or NULL for a single line
+ * @param row output buffer with a size of FONT_ROW_BUFFER_SIZE
+ */
+static void decodeFontRow(const pbm_font *font, uint32_t glyph, uint32_t line,
+                          fontRowCursor *cursor, uint8_t *row);
+
+/**
+ * @brief Decode one line of a glyph and apply the emphasis of the style
+ *
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @param line the line of the glyph
+ * @param style the text style or NULL
+ * @param cursor decoding position in the glyph or NULL for a single line
+ * @param row output buffer with a size of FONT_ROW_BUFFER_SIZE
+ */
+static void decodeStyledRow(const pbm_font *font, uint32_t glyph,
+                            uint32_t line, const pbm_textStyle *style,
+                            fontRowCursor *cursor, uint8_t *row);
+
+/**
+ * @brief Fill the underline and strike lines in the gap between two glyphs
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x start position of the gap in x
+ * @param y top position of the line in y
+ * @param width scaled width of the gap
+ * @param color the desired color
+ * @param font the font of the line
+ * @param style the text style
+ */
+static void drawEmphasisGap(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, uint32_t width,
+                            pbm_colors color, const pbm_font *font,
+                            const pbm_textStyle *style);
+
+/**
+ * @brief Find the first and last set pixel of a MSB first packed line
+ *
+ * @param row the line
+ * @param rowBytes number of bytes of the line
+ * @param first output first set pixel
+ * @param last output last set pixel
+ * @return uint8_t 0 if no pixel is set
+ */
+static uint8_t rowInk(const uint8_t *row, uint32_t rowBytes, uint32_t *first,
+                      uint32_t *last);
+
+/**
+ * @brief Compute the ink bounding box of a glyph
+ *
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @param box output ink box, xMin > xMax for an empty glyph
+ */
+static void computeInkBox(const pbm_font *font, uint32_t glyph,
+                          pbm_glyphBox *box);
+
+/**
+ * @brief Decode the next codepoint of an UTF-8 string
+ *
+ * Invalid or truncated sequences, overlong forms, surrogates and codepoints
+ * above U+10FFFF are decoded as U+FFFD.
+ *
+ * @param text pointer to the current position, moved behind the codepoint
+ * @param end end of the string or NULL for a terminated C string
+ * @return uint32_t the decoded codepoint
+ */
+static uint32_t decodeUtf8(const uint8_t **text, const uint8_t *end);
+
+/**
+ * @brief Map a codepoint to the glyph index of the font
+ *
+ * The first range of the glyph map is checked directly, the others with a
+ * binary search.
+ *
+ * @param font the font with the optional glyph map
+ * @param codepoint the codepoint to map
+ * @return uint32_t the glyph index or the default glyph of the font
+ */
+static uint32_t lookupGlyph(const pbm_font *font, uint32_t codepoint);
+
+/**
+ * @brief Get the glyph index of the next character of a string
+ *
+ * Fonts without glyph map use one byte per character, fonts with glyph map
+ * are written with UTF-8 strings.
+ *
+ * @param font the font to write the string
+ * @param text pointer to the current position, moved behind the character
+ * @param end end of the string or NULL for a terminated C string
+ * @return uint32_t the glyph index
+ */
+static uint32_t nextGlyph(const pbm_font *font, const uint8_t **text,
+                          const uint8_t *end);
+
+/**
+ * @brief Get the drawn columns of a glyph
+ *
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @return uint32_t width of the glyph in pixel
+ */
+static uint32_t glyphColumns(const pbm_font *font, uint32_t glyph);
+
+/**
+ * @brief Look up the kerning correction of two glyphs with a binary search
+ *
+ * @param font the font with the kerning table
+ * @param left the first glyph index
+ * @param right the following glyph index
+ * @return int32_t additional pen movement in pixel
+ */
+static int32_t kerningOffset(const pbm_font *font, uint32_t left,
+                             uint32_t right);
+
+/**
+ * @brief Measure the width and the length of a string on one line
+ *
+ * @param font the font to write the string
+ * @param msg the C string
+ * @param length output number of bytes in the string
+ * @return uint32_t width of the string in pixel
+ */
+static uint32_t measureLine(const pbm_font *font, const char *msg,
+                            uint32_t *length);
+
+/**
+ * @brief Measure the ink bounds of a string on one line
+ *
+ * @param font the font to write the string
+ * @param msg the characters of the string
+ * @param length number of bytes
+ * @param extent output extent, only the ink members are set
+ */
+static void measureInk(const pbm_font *font, const uint8_t *msg,
+                       uint32_t length, pbm_textExtent *extent);
+
+/**
+ * @brief Measure the full extent of a string on one line
+ *
+ * @param font the checked font to write the string
+ * @param msg the C string
+ * @param extent output extent of the string
+ * @return uint32_t number of bytes in the string
+ */
+static uint32_t measureExtent(const pbm_font *font, const char *msg,
+                              pbm_textExtent *extent);
+
+/**
+ * @brief Break a text into the lines of a text box
+ *
+ * @param cache output line breaks, the key members have to be set
+ * @param text the C string
+ */
+static void layoutTextBox(pbm_textBoxCache *cache, const char *text);
+
+/**
+ * @brief Calculate the offset of a text block to its aligned position
+ *
+ * @param textAlignment alignment of the text to the position
+ * @param width width of the text block
+ * @param height height of the text block
+ * @param xOffset output offset to the left
+ * @param yOffset output offset to the top
+ */
+static void alignmentOffset(pbm_stringAlignment textAlignment, uint32_t width,
+                            uint32_t height, uint32_t *xOffset,
+                            uint32_t *yOffset);
+
+/**
+ * @brief Draw the characters of a measured line into the image
+ *
+ * For justified lines, the additional pixels are distributed over the spaces
+ * of the line.
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x start position on the top left corner in x
+ * @param y start position on the top left corner in y
+ * @param lineWidth scaled width of the line, only used for rotated text
+ * @param color the desired color
+ * @param font the font to write the line
+ * @param msg the characters of the line
+ * @param length number of bytes
+ * @param style the text style
+ * @param justifyPixels additional pixels to distribute over the spaces
+ * @param justifySpaces number of spaces in the line
+ */
+static void drawLine(pbm_image *imageHandler, const pbm_rect *clip,
+                     uint32_t x, uint32_t y, uint32_t lineWidth,
+                     pbm_colors color, const pbm_font *font,
+                     const uint8_t *msg, uint32_t length,
+                     const pbm_textStyle *style, uint32_t justifyPixels,
+                     uint32_t justifySpaces);
+
+/**
+ * @brief Draw the columns of a packed glyph into the image
+ *
+ * The glyph lines are streamed from the packed data directly into the image.
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x position of the origin column in x
+ * @param y start position on the top left corner in y
+ * @param color the desired color
+ * @param font the packed font with the glyph
+ * @param glyph the glyph index
+ * @param firstColumn first drawn column of the glyph cell
+ * @param lastColumn last drawn column of the glyph cell
+ * @param transparent only write the set bits
+ */
+static void drawPackedGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, pbm_colors color,
+                            const pbm_font *font, uint32_t glyph,
+                            uint32_t firstColumn, uint32_t lastColumn,
+                            uint8_t transparent);
+
+/**
+ * @brief Draw a part of a scaled glyph into the image
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x position of the first glyph cell column in x
+ * @param y position of the first glyph cell line in y
+ * @param color the desired color
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @param firstColumn first drawn column of the glyph cell
+ * @param lastColumn last drawn column of the glyph cell
+ * @param firstLine first drawn line of the glyph cell
+ * @param lastLine last drawn line of the glyph cell
+ * @param style the text style
+ */
+static void drawScaledGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, pbm_colors color,
+                            const pbm_font *font, uint32_t glyph,
+                            uint32_t firstColumn, uint32_t lastColumn,
+                            uint32_t firstLine, uint32_t lastLine,
+                            const pbm_textStyle *style);
+
+/**
+ * @brief Reduce the drawn part of a glyph cell to the ink box of the glyph
+ *
+ * @param font the font with the glyph boxes
+ * @param glyph the glyph index
+ * @param firstColumn first drawn column, reduced to the ink
+ * @param lastColumn last drawn column, reduced to the ink
+ * @param firstLine first drawn line, reduced to the ink
+ * @param lastLine last drawn line, reduced to the ink
+ * @return uint8_t 0 if no ink is inside the drawn columns
+ */
+static uint8_t cropToInk(const pbm_font *font, uint32_t glyph,
+                         uint32_t *firstColumn, uint32_t *lastColumn,
+                         uint32_t *firstLine, uint32_t *lastLine);
+
+/**
+ * @brief Draw a glyph of a rotated line with the pre-rotated font
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x position of the rotated line box in x
+ * @param y position of the rotated line box in y
+ * @param cellX position of the upright glyph cell in the upright line
+ * @param lineWidth scaled width of the upright line
+ * @param color the desired color
+ * @param font the upright font
+ * @param glyph the glyph index
+ * @param firstColumn first drawn column of the upright glyph cell
+ * @param lastColumn last drawn column of the upright glyph cell
+ * @param style the text style with the rotation
+ */
+static void drawRotatedGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                             uint32_t x, uint32_t y, uint32_t cellX,
+                             uint32_t lineWidth, pbm_colors color,
+                             const pbm_font *font, uint32_t glyph,
+                             uint32_t firstColumn, uint32_t lastColumn,
+                             const pbm_textStyle *style);
 
-  uint32_t imageDataSize = 0;
+/**
+ * @brief Draw a glyph of the font into the image
+ *
+ * @param imageHandler the image to write
+ * @param clip optional clipping rectangle inside the image or NULL
+ * @param x start position of the line on the top left corner in x
+ * @param y start position of the line on the top left corner in y
+ * @param pen scaled pen position of the glyph in the line
+ * @param lineWidth scaled width of the line, only used for rotated text
+ * @param color the desired color
+ * @param font the font with the glyph
+ * @param glyph the glyph index
+ * @param style the text style
+ */
+static void drawGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                      uint32_t x, uint32_t y, uint32_t pen, uint32_t lineWidth,
+                      pbm_colors color, const pbm_font *font, uint32_t glyph,
+                      const pbm_textStyle *style);
 
-  switch (imageHandler->alignment) {
+pbm_return pbm_imageDataSize(const pbm_image *imageHandler, size_t *size) {
+  if (NULL == imageHandler || NULL == size) {
+    return PBM_ARGUMENTS;
+  }
+  size_t lineBytes;
+  size_t lines;
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
   case PBM_DATA_VERTICAL_LSB:
   case PBM_DATA_VERTICAL_MSB:
-    imageDataSize = ((imageHandler->height - 1) / IMAGE_BUFFER_BIT_SIZE + 1) *
-                    imageHandler->width;
+    lineBytes = imageHandler->width;
+    lines = (imageHandler->height + (size_t)IMAGE_BUFFER_BIT_SIZE - 1) /
+            IMAGE_BUFFER_BIT_SIZE;
     break;
   case PBM_DATA_HORIZONTAL_LSB:
   case PBM_DATA_HORIZONTAL_MSB:
-    imageDataSize = ((imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1) *
-                    imageHandler->height;
+    lineBytes = (imageHandler->width + (size_t)IMAGE_BUFFER_BIT_SIZE - 1) /
+                IMAGE_BUFFER_BIT_SIZE;
+    lines = imageHandler->height;
     break;
   default:
     return PBM_ERROR;
   }
+  if (0 != lines && lineBytes > SIZE_MAX / lines) {
+    return PBM_SIZE;
+  }
+  *size = lineBytes * lines;
+  return PBM_OK;
+}
 
-  uint8_t fillValue = UINT8_MAX * (uint8_t)color;
+pbm_return pbm_fill(pbm_image *imageHandler, pbm_colors color) {
+  if (NULL == imageHandler || color > PBM_BLACK) {
+    return PBM_ARGUMENTS;
+  }
 
-  for (uint32_t i = 0; i < imageDataSize; i++) {
-    imageHandler->data[i] = fillValue;
+  size_t imageDataSize;
+  pbm_return retVal = pbm_imageDataSize(imageHandler, &imageDataSize);
+  if (PBM_OK != retVal) {
+    return retVal;
   }
+
+  uint8_t fillValue = UINT8_MAX * (uint8_t)color;
+  memset(imageHandler->data, fillValue, imageDataSize);
   return PBM_OK;
 }
 
@@ -116,24 +675,13 @@ pbm_return pbm_invertColor(pbm_image *imageHandler) {
     return PBM_ARGUMENTS;
   }
 
-  uint32_t imageDataSize = 0;
-
-  switch (imageHandler->alignment) {
-  case PBM_DATA_VERTICAL_LSB:
-  case PBM_DATA_VERTICAL_MSB:
-    imageDataSize = ((imageHandler->height - 1) / IMAGE_BUFFER_BIT_SIZE + 1) *
-                    imageHandler->width;
-    break;
-  case PBM_DATA_HORIZONTAL_LSB:
-  case PBM_DATA_HORIZONTAL_MSB:
-    imageDataSize = ((imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1) *
-                    imageHandler->height;
-    break;
-  default:
-    return PBM_ERROR;
+  size_t imageDataSize;
+  pbm_return retVal = pbm_imageDataSize(imageHandler, &imageDataSize);
+  if (PBM_OK != retVal) {
+    return retVal;
   }
 
-  for (uint32_t i = 0; i < imageDataSize; i++) {
+  for (size_t i = 0; i < imageDataSize; i++) {
     imageHandler->data[i] = ~imageHandler->data[i];
   }
   return PBM_OK;
@@ -157,24 +705,30 @@ pbm_return pbm_setPixel(pbm_image *imageHandler, uint32_t x, uint32_t y,
     return PBM_OUT_OF_RANGE;
   }
   uint8_t pattern;
-  uint32_t bytePosition;
+  size_t bytePosition;
 
-  switch (imageHandler->alignment) {
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
   case PBM_DATA_HORIZONTAL_MSB:
     pattern = MSB_BIT >> (x % IMAGE_BUFFER_BIT_SIZE);
-    bytePosition = (y * imageHandler->width + x) / IMAGE_BUFFER_BIT_SIZE;
+    bytePosition =
+        (size_t)y * ((imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1) +
+        x / IMAGE_BUFFER_BIT_SIZE;
     break;
   case PBM_DATA_HORIZONTAL_LSB:
     pattern = LSB_BIT << (x % IMAGE_BUFFER_BIT_SIZE);
-    bytePosition = (y * imageHandler->width + x) / IMAGE_BUFFER_BIT_SIZE;
+    bytePosition =
+        (size_t)y * ((imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1) +
+        x / IMAGE_BUFFER_BIT_SIZE;
     break;
   case PBM_DATA_VERTICAL_MSB:
     pattern = MSB_BIT >> (y % IMAGE_BUFFER_BIT_SIZE);
-    bytePosition = y / IMAGE_BUFFER_BIT_SIZE * imageHandler->width + x;
+    bytePosition =
+        (size_t)(y / IMAGE_BUFFER_BIT_SIZE) * imageHandler->width + x;
     break;
   case PBM_DATA_VERTICAL_LSB:
     pattern = LSB_BIT << (y % IMAGE_BUFFER_BIT_SIZE);
-    bytePosition = y / IMAGE_BUFFER_BIT_SIZE * imageHandler->width + x;
+    bytePosition =
+        (size_t)(y / IMAGE_BUFFER_BIT_SIZE) * imageHandler->width + x;
     break;
   default:
     return PBM_ERROR;
@@ -188,6 +742,145 @@ pbm_return pbm_setPixel(pbm_image *imageHandler, uint32_t x, uint32_t y,
   return PBM_OK;
 }
 
+pbm_return pbm_setPixels(pbm_image *imageHandler, const pbm_point *points,
+                         uint32_t count, pbm_colors color) {
+  if (NULL == imageHandler || (NULL == points && 0 != count)) {
+    return PBM_ARGUMENTS;
+  }
+  uint8_t msb;
+  uint8_t vertical;
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
+  case PBM_DATA_HORIZONTAL_MSB:
+    msb = 1;
+    vertical = 0;
+    break;
+  case PBM_DATA_HORIZONTAL_LSB:
+    msb = 0;
+    vertical = 0;
+    break;
+  case PBM_DATA_VERTICAL_MSB:
+    msb = 1;
+    vertical = 1;
+    break;
+  case PBM_DATA_VERTICAL_LSB:
+    msb = 0;
+    vertical = 1;
+    break;
+  default:
+    return PBM_ERROR;
+  }
+
+  const uint32_t width = imageHandler->width;
+  const uint32_t height = imageHandler->height;
+  const uint32_t lineBytes = (width - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
+  uint8_t *const data = imageHandler->data;
+  pbm_return retVal = PBM_OK;
+  size_t currentByte = 0;
+  uint8_t currentPattern = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t x = (PBM_IMAGE_END == points[i].x) ? width - 1 : points[i].x;
+    uint32_t y = (PBM_IMAGE_END == points[i].y) ? height - 1 : points[i].y;
+    if (x >= width || y >= height) {
+      retVal = PBM_OUT_OF_RANGE;
+      continue;
+    }
+    size_t bytePosition;
+    uint32_t bit;
+    if (vertical) {
+      bytePosition = (size_t)(y / IMAGE_BUFFER_BIT_SIZE) * width + x;
+      bit = y % IMAGE_BUFFER_BIT_SIZE;
+    } else {
+      bytePosition = (size_t)y * lineBytes + x / IMAGE_BUFFER_BIT_SIZE;
+      bit = x % IMAGE_BUFFER_BIT_SIZE;
+    }
+    uint8_t pattern = msb ? (MSB_BIT >> bit) : (LSB_BIT << bit);
+
+    // Merge all points of the same byte into one read-modify-write
+    if (0 != currentPattern && bytePosition != currentByte) {
+      if (PBM_BLACK == color) {
+        data[currentByte] |= currentPattern;
+      } else {
+        data[currentByte] &= ~currentPattern;
+      }
+      currentPattern = 0;
+    }
+    currentByte = bytePosition;
+    currentPattern |= pattern;
+  }
+  if (0 != currentPattern) {
+    if (PBM_BLACK == color) {
+      data[currentByte] |= currentPattern;
+    } else {
+      data[currentByte] &= ~currentPattern;
+    }
+  }
+  return retVal;
+}
+
+/**
+ * @brief compare two points in the byte order of horizontal images
+ *
+ * @param a first point
+ * @param b second point
+ * @return int comparison result for qsort
+ */
+static int comparePoints_horizontal(const void *a, const void *b) {
+  const pbm_point *pa = (const pbm_point *)a;
+  const pbm_point *pb = (const pbm_point *)b;
+  if (pa->y != pb->y) {
+    return (pa->y < pb->y) ? -1 : 1;
+  }
+  return (pa->x < pb->x) ? -1 : (pa->x > pb->x);
+}
+
+/**
+ * @brief compare two points in the byte order of vertical images
+ *
+ * @param a first point
+ * @param b second point
+ * @return int comparison result for qsort
+ */
+static int comparePoints_vertical(const void *a, const void *b) {
+  const pbm_point *pa = (const pbm_point *)a;
+  const pbm_point *pb = (const pbm_point *)b;
+  uint32_t pageA = pa->y / IMAGE_BUFFER_BIT_SIZE;
+  uint32_t pageB = pb->y / IMAGE_BUFFER_BIT_SIZE;
+  if (pageA != pageB) {
+    return (pageA < pageB) ? -1 : 1;
+  }
+  return (pa->x < pb->x) ? -1 : (pa->x > pb->x);
+}
+
+pbm_return pbm_sortPoints(const pbm_image *imageHandler, pbm_point *points,
+                          uint32_t count) {
+  if (NULL == imageHandler || (NULL == points && 0 != count)) {
+    return PBM_ARGUMENTS;
+  }
+  // The image end is sorted next to the points of its byte
+  for (uint32_t i = 0; i < count; i++) {
+    if (PBM_IMAGE_END == points[i].x) {
+      points[i].x = imageHandler->width - 1;
+    }
+    if (PBM_IMAGE_END == points[i].y) {
+      points[i].y = imageHandler->height - 1;
+    }
+  }
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
+  case PBM_DATA_HORIZONTAL_MSB:
+  case PBM_DATA_HORIZONTAL_LSB:
+    qsort(points, count, sizeof(pbm_point), comparePoints_horizontal);
+    break;
+  case PBM_DATA_VERTICAL_MSB:
+  case PBM_DATA_VERTICAL_LSB:
+    qsort(points, count, sizeof(pbm_point), comparePoints_vertical);
+    break;
+  default:
+    return PBM_ERROR;
+  }
+  return PBM_OK;
+}
+
 pbm_return pbm_drawLine(pbm_image *imageHandler, uint32_t xStart,
                         uint32_t yStart, uint32_t xEnd, uint32_t yEnd,
                         pbm_colors color) {
@@ -280,81 +973,1755 @@ pbm_return pbm_drawCircle(pbm_image *imageHandler, uint32_t xCenter,
   return PBM_OK;
 }
 
-pbm_return pbm_writeChar(pbm_image *const imageHandler, const uint32_t x,
-                         const uint32_t y, pbm_colors color,
-                         const pbm_font *font, const uint8_t character) {
-
-  if (NULL == imageHandler || NULL == font) {
+pbm_return pbm_scroll(pbm_image *imageHandler, const pbm_rect *rect,
+                      int32_t dx, int32_t dy, pbm_colors fill) {
+  if (NULL == imageHandler || NULL == imageHandler->data) {
     return PBM_ARGUMENTS;
   }
-  // Check first the correct alignment
-  offsetCalculation byteOffset;
-  offsetCalculation bitOffset;
-  switch (font->alignment) {
+  uint8_t msb;
+  uint8_t horizontal;
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
+  case PBM_DATA_HORIZONTAL_MSB:
   case PBM_DATA_HORIZONTAL_LSB:
-    byteOffset = byteOffset_horizontalLSB;
-    bitOffset = bitOffset_horizontalLSB;
+    horizontal = 1;
+    msb = (PBM_DATA_HORIZONTAL_MSB == IMAGE_ALIGNMENT(imageHandler));
     break;
-  case PBM_DATA_HORIZONTAL_MSB:
-    byteOffset = byteOffset_horizontalMSB;
-    bitOffset = bitOffset_horizontalMSB;
+  case PBM_DATA_VERTICAL_MSB:
+  case PBM_DATA_VERTICAL_LSB:
+    horizontal = 0;
+    msb = (PBM_DATA_VERTICAL_MSB == IMAGE_ALIGNMENT(imageHandler));
     break;
   default:
     return PBM_ARGUMENTS;
   }
-  // Set horizontal alignment
-  // Set the correct size
-  uint32_t bytePerLine = (font->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
-  uint32_t startFontIndex = (uint32_t)character * font->height * bytePerLine;
-  for (uint32_t line = 0; line < font->height; line++) {
-    for (uint32_t i = 0; i < font->width; i++) {
-      uint32_t currentByte =
-          startFontIndex + line * bytePerLine + byteOffset(i, font);
-      uint32_t currentBit = bitOffset(i, font);
-      if (font->fontData[currentByte] & currentBit) {
-        pbm_setPixel(imageHandler, x + i, y + line, color);
+  uint32_t left = 0;
+  uint32_t top = 0;
+  uint32_t right = imageHandler->width;
+  uint32_t bottom = imageHandler->height;
+  if (NULL != rect) {
+    left = (rect->x < right) ? rect->x : right;
+    top = (rect->y < bottom) ? rect->y : bottom;
+    if ((uint64_t)rect->x + rect->width < right) {
+      right = rect->x + rect->width;
+    }
+    if ((uint64_t)rect->y + rect->height < bottom) {
+      bottom = rect->y + rect->height;
+    }
+  }
+  if (left >= right || top >= bottom) {
+    return PBM_OK;
+  }
+  const uint32_t width = right - left;
+  const uint32_t height = bottom - top;
+  const uint64_t distanceX = (dx < 0) ? -(int64_t)dx : dx;
+  const uint64_t distanceY = (dy < 0) ? -(int64_t)dy : dy;
+  uint8_t *data = imageHandler->data;
+  const size_t stride = (imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
+
+  if (distanceX >= width || distanceY >= height) {
+    // Nothing stays in the rectangle
+    const uint32_t last = horizontal ? bottom : right;
+    for (uint32_t i = horizontal ? top : left; i < last; i++) {
+      if (horizontal) {
+        fillLine(&data[i * stride], 1, msb, left, width, fill);
       } else {
-        pbm_setPixel(imageHandler, x + i, y + line, !color);
+        fillLine(&data[i], imageHandler->width, msb, top, height, fill);
       }
     }
+    return PBM_OK;
   }
-  return PBM_OK;
-}
 
-pbm_return pbm_writeString(pbm_image *const imageHandler, const uint32_t x,
-                           const uint32_t y, pbm_colors color,
-                           const pbm_font *font,
-                           pbm_stringAlignment textAlignment, const char *msg) {
-  if (NULL == imageHandler || NULL == font || NULL == msg) {
-    return PBM_ARGUMENTS;
-  }
-  uint32_t stringLen = strlen(msg);
-  if (0 == stringLen) {
+  if (horizontal) {
+    // Whole rows are moved for vertical scrolling
+    if (0 != dy) {
+      uint32_t firstByte = left / IMAGE_BUFFER_BIT_SIZE;
+      uint32_t bytes = (right - 1) / IMAGE_BUFFER_BIT_SIZE - firstByte + 1;
+      uint8_t firstMask = rangeMask(firstByte, left, right, msb);
+      uint8_t lastMask =
+          rangeMask(firstByte + bytes - 1, left, right, msb);
+      uint32_t rows = height - (uint32_t)distanceY;
+      uint32_t srcRow = (dy > 0) ? top : top + (uint32_t)distanceY;
+      uint32_t dstRow = (dy > 0) ? top + (uint32_t)distanceY : top;
+      if (0 == left && imageHandler->width == right) {
+        // Complete lines are one continuous block
+        memmove(&data[dstRow * stride], &data[srcRow * stride],
+                (size_t)rows * stride);
+      } else {
+        for (uint32_t i = 0; i < rows; i++) {
+          uint32_t row = (dy > 0) ? rows - 1 - i : i;
+          copyRange(&data[(dstRow + row) * stride + firstByte],
+                    &data[(srcRow + row) * stride + firstByte], bytes,
+                    firstMask, lastMask);
+        }
+      }
+    }
+    for (uint32_t row = top; row < bottom; row++) {
+      uint8_t uncovered = (dy > 0) ? (row < top + distanceY)
+                                   : (row >= bottom - distanceY);
+      if (0 != dy && uncovered) {
+        fillLine(&data[row * stride], 1, msb, left, width, fill);
+      } else if (0 != dx) {
+        shiftLine(&data[row * stride], 1, msb, left, width, dx, fill);
+      }
+    }
+    return PBM_OK;
+  }
+
+  // Vertical alignment, whole columns are moved for horizontal scrolling
+  if (0 != dx) {
+    uint32_t columns = width - (uint32_t)distanceX;
+    uint32_t srcColumn = (dx > 0) ? left : left + (uint32_t)distanceX;
+    uint32_t dstColumn = (dx > 0) ? left + (uint32_t)distanceX : left;
+    for (uint32_t page = top / IMAGE_BUFFER_BIT_SIZE;
+         page <= (bottom - 1) / IMAGE_BUFFER_BIT_SIZE; page++) {
+      uint8_t mask = rangeMask(page, top, bottom, msb);
+      uint8_t *pageData = &data[(size_t)page * imageHandler->width];
+      if (UINT8_MAX == mask) {
+        memmove(&pageData[dstColumn], &pageData[srcColumn], columns);
+        continue;
+      }
+      for (uint32_t i = 0; i < columns; i++) {
+        uint32_t column = (dx > 0) ? columns - 1 - i : i;
+        uint8_t *dst = &pageData[dstColumn + column];
+        *dst = (uint8_t)((*dst & ~mask) |
+                         (pageData[srcColumn + column] & mask));
+      }
+    }
+  }
+  for (uint32_t column = left; column < right; column++) {
+    uint8_t uncovered = (dx > 0) ? (column < left + distanceX)
+                                 : (column >= right - distanceX);
+    if (0 != dx && uncovered) {
+      fillLine(&data[column], imageHandler->width, msb, top, height, fill);
+    } else if (0 != dy) {
+      shiftLine(&data[column], imageHandler->width, msb, top, height, dy,
+                fill);
+    }
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_drawBitmap(pbm_image *const imageHandler, const uint32_t x,
+                          const uint32_t y, pbm_colors color,
+                          pbm_stringAlignment alignment,
+                          const pbm_image *bitmap, pbm_textMode mode) {
+  if (NULL == imageHandler || NULL == bitmap || NULL == bitmap->data) {
     return PBM_ARGUMENTS;
   }
-  uint32_t msgBitLen =
-      (stringLen - 1) * (font->width + CHARACTER_GAP) + font->width;
+  if (PBM_DATA_MAX_ALIGNMENTS <= bitmap->alignment) {
+    return PBM_ARGUMENTS;
+  }
+  if (0 == bitmap->width || 0 == bitmap->height) {
+    return PBM_OK;
+  }
   uint32_t xOffset;
   uint32_t yOffset;
+  alignmentOffset(alignment, bitmap->width, bitmap->height, &xOffset,
+                  &yOffset);
+  uint32_t currentX =
+      ((x == PBM_IMAGE_END) ? imageHandler->width : x) - xOffset;
+  uint32_t currentY =
+      ((y == PBM_IMAGE_END) ? imageHandler->height : y) - yOffset;
+
+  const uint8_t transparent = (PBM_TEXT_TRANSPARENT == mode);
+  const size_t stride = (bitmap->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
+  if (PBM_DATA_HORIZONTAL_MSB == bitmap->alignment) {
+    for (uint32_t line = 0; line < bitmap->height; line++) {
+      blitRow(imageHandler, NULL, currentX, currentY + line,
+              &bitmap->data[line * stride], 0, bitmap->width, color,
+              transparent);
+    }
+    return PBM_OK;
+  }
+  if ((PBM_DATA_VERTICAL_MSB == bitmap->alignment ||
+       PBM_DATA_VERTICAL_LSB == bitmap->alignment) &&
+      IMAGE_ALIGNMENT(imageHandler) == bitmap->alignment) {
+    blitPages(imageHandler, currentX, currentY, bitmap, color, transparent);
+    return PBM_OK;
+  }
+  // Other alignments are gathered into MSB rows in chunks of the row buffer,
+  // LSB lines byte by byte and vertical bitmaps pixel by pixel
+  uint8_t row[FONT_ROW_BUFFER_SIZE];
+  const uint32_t chunkBits = FONT_ROW_BUFFER_SIZE * IMAGE_BUFFER_BIT_SIZE;
+  for (uint32_t line = 0; line < bitmap->height; line++) {
+    for (uint32_t start = 0; start < bitmap->width; start += chunkBits) {
+      uint32_t count = bitmap->width - start;
+      if (count > chunkBits) {
+        count = chunkBits;
+      }
+      if (PBM_DATA_HORIZONTAL_LSB == bitmap->alignment) {
+        const uint8_t *src =
+            &bitmap->data[line * stride + start / IMAGE_BUFFER_BIT_SIZE];
+        for (uint32_t i = 0; i < (count - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
+             i++) {
+          row[i] = reverseByte(src[i]);
+        }
+        blitRow(imageHandler, NULL, currentX + start, currentY + line, row, 0,
+                count, color, transparent);
+        continue;
+      }
+      memset(row, 0, sizeof(row));
+      for (uint32_t i = 0; i < count; i++) {
+        if (bitmapPixel(bitmap, start + i, line)) {
+          row[i / IMAGE_BUFFER_BIT_SIZE] |=
+              MSB_BIT >> (i % IMAGE_BUFFER_BIT_SIZE);
+        }
+      }
+      blitRow(imageHandler, NULL, currentX + start, currentY + line, row, 0,
+              count, color, transparent);
+    }
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_writeChar(pbm_image *const imageHandler, const uint32_t x,
+                         const uint32_t y, pbm_colors color,
+                         const pbm_font *font, const uint8_t character) {
+  return pbm_writeCharStyled(imageHandler, x, y, color, font, NULL, character);
+}
+
+pbm_return pbm_writeCharStyled(pbm_image *const imageHandler, const uint32_t x,
+                               const uint32_t y, pbm_colors color,
+                               const pbm_font *font, const pbm_textStyle *style,
+                               const uint8_t character) {
+  if (NULL == imageHandler || NULL == font) {
+    return PBM_ARGUMENTS;
+  }
+  // Check first the correct alignment
+  if (PBM_OK != checkFont(font) || PBM_OK != checkStyle(font, style)) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t glyph = lookupGlyph(font, character);
+  drawGlyph(imageHandler, NULL, x, y, 0,
+            glyphColumns(font, glyph) * textScale(style), color, font, glyph,
+            style);
+  return PBM_OK;
+}
+
+pbm_return pbm_writeCodepoint(pbm_image *const imageHandler, const uint32_t x,
+                              const uint32_t y, pbm_colors color,
+                              const pbm_font *font,
+                              const pbm_textStyle *style,
+                              const uint32_t codepoint) {
+  if (NULL == imageHandler || NULL == font) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font) || PBM_OK != checkStyle(font, style)) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t glyph = lookupGlyph(font, codepoint);
+  drawGlyph(imageHandler, NULL, x, y, 0,
+            glyphColumns(font, glyph) * textScale(style), color, font, glyph,
+            style);
+  return PBM_OK;
+}
+
+pbm_return pbm_writeString(pbm_image *const imageHandler, const uint32_t x,
+                           const uint32_t y, pbm_colors color,
+                           const pbm_font *font,
+                           pbm_stringAlignment textAlignment, const char *msg) {
+  return pbm_writeStringStyled(imageHandler, x, y, color, font, textAlignment,
+                               NULL, msg);
+}
+
+pbm_return pbm_writeStringStyled(pbm_image *const imageHandler,
+                                 const uint32_t x, const uint32_t y,
+                                 pbm_colors color, const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 const pbm_textStyle *style, const char *msg) {
+  if (NULL == imageHandler || NULL == font || NULL == msg) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font) || PBM_OK != checkStyle(font, style)) {
+    return PBM_ARGUMENTS;
+  }
+  if ('\0' == *msg) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t scale = textScale(style);
+  uint32_t length;
+  uint32_t lineWidth = measureLine(font, msg, &length) * scale;
+  uint32_t boxWidth;
+  uint32_t boxHeight;
+  lineBox(style, lineWidth, font->height * scale, &boxWidth, &boxHeight);
+  uint32_t xOffset;
+  uint32_t yOffset;
+  alignmentOffset(textAlignment, boxWidth, boxHeight, &xOffset, &yOffset);
+
+  uint32_t currentX =
+      ((x == PBM_IMAGE_END) ? imageHandler->width : x) - xOffset;
+  uint32_t currentY =
+      ((y == PBM_IMAGE_END) ? imageHandler->height : y) - yOffset;
+
+  drawLine(imageHandler, NULL, currentX, currentY, lineWidth, color, font,
+           (const uint8_t *)msg, length, style, 0, 0);
+  return PBM_OK;
+}
+
+pbm_return pbm_writeCharScaled(pbm_image *const imageHandler, const uint32_t x,
+                               const uint32_t y, pbm_colors color,
+                               const pbm_font *font, uint8_t scale,
+                               const uint8_t character) {
+  pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE, .scale = scale};
+  return pbm_writeCharStyled(imageHandler, x, y, color, font, &style,
+                             character);
+}
+
+pbm_return pbm_writeStringScaled(pbm_image *const imageHandler,
+                                 const uint32_t x, const uint32_t y,
+                                 pbm_colors color, const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 uint8_t scale, const char *msg) {
+  pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE, .scale = scale};
+  return pbm_writeStringStyled(imageHandler, x, y, color, font, textAlignment,
+                               &style, msg);
+}
+
+pbm_return pbm_writeTextBox(pbm_image *const imageHandler, const pbm_rect *box,
+                            pbm_colors color, const pbm_font *font,
+                            pbm_stringAlignment textAlignment,
+                            pbm_wrapMode wrapMode, const pbm_textStyle *style,
+                            const char *text, pbm_textBoxCache *cache) {
+  if (NULL == imageHandler || NULL == box || NULL == font || NULL == text) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font) || PBM_OK != checkStyle(font, style)) {
+    return PBM_ARGUMENTS;
+  }
+  if (NULL != style && PBM_ROTATE_0 != style->rotation) {
+    return PBM_ARGUMENTS;
+  }
+
+  pbm_textBoxCache localCache;
+  if (NULL == cache) {
+    cache = &localCache;
+    cache->text = NULL;
+    cache->skipTextHash = 0;
+  }
+  // The text is laid out in unscaled font pixels
+  uint32_t scale = textScale(style);
+  uint32_t boxWidth = box->width / scale;
+  uint32_t boxHeight = box->height / scale;
+  // The cheap keys first, the text is only hashed if they are equal
+  uint8_t changed = (cache->text != text || cache->font != font ||
+                     cache->boxWidth != boxWidth ||
+                     cache->boxHeight != boxHeight ||
+                     cache->wrapMode != wrapMode);
+  uint32_t textHash = cache->textHash;
+  if (changed || !cache->skipTextHash) {
+    textHash = pbm_hashString(text);
+    changed |= (cache->textHash != textHash);
+  }
+  if (changed) {
+    cache->text = text;
+    cache->textHash = textHash;
+    cache->font = font;
+    cache->boxWidth = boxWidth;
+    cache->boxHeight = boxHeight;
+    cache->wrapMode = wrapMode;
+    layoutTextBox(cache, text);
+  }
+  if (0 == cache->lineCount) {
+    return PBM_OK;
+  }
+
+  uint32_t blockHeight =
+      (cache->lineCount * (font->height + LINE_GAP) - LINE_GAP) * scale;
+  uint32_t xOffset;
+  uint32_t yOffset;
+  alignmentOffset(textAlignment, 0, box->height - blockHeight, &xOffset,
+                  &yOffset);
+  uint8_t justify = (PBM_STRING_JUSTIFY_TOP == textAlignment ||
+                     PBM_STRING_JUSTIFY_CENTER == textAlignment ||
+                     PBM_STRING_JUSTIFY_BOTTOM == textAlignment);
+  uint32_t currentY = box->y + yOffset;
+
+  for (uint32_t i = 0; i < cache->lineCount; i++) {
+    const pbm_textLine *line = &cache->lines[i];
+    uint32_t lineWidth = line->width * scale;
+    uint32_t freePixels =
+        (lineWidth < box->width) ? box->width - lineWidth : 0;
+    alignmentOffset(textAlignment, freePixels, 0, &xOffset, &yOffset);
+    uint32_t justifyPixels = 0;
+    if (justify && !line->lastLine && 0 != line->spaces) {
+      justifyPixels = freePixels;
+    }
+    drawLine(imageHandler, box, box->x + xOffset, currentY, 0, color, font,
+             (const uint8_t *)&text[line->start], line->length, style,
+             justifyPixels, line->spaces);
+    currentY += (font->height + LINE_GAP) * scale;
+  }
+  return PBM_OK;
+}
+
+void pbm_invalidateTextBox(pbm_textBoxCache *cache) {
+  if (NULL != cache) {
+    cache->text = NULL;
+  }
+}
+
+uint32_t pbm_hashString(const char *text) {
+  uint32_t hash = 2166136261u;
+  if (NULL == text) {
+    return hash;
+  }
+  while ('\0' != *text) {
+    hash = (hash ^ (uint8_t)*text++) * 16777619u;
+  }
+  return hash;
+}
+
+pbm_return pbm_measureString(const pbm_font *font, const char *msg,
+                             pbm_textExtent *extent) {
+  if (NULL == font || NULL == msg || NULL == extent) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font)) {
+    return PBM_ARGUMENTS;
+  }
+  measureExtent(font, msg, extent);
+  return PBM_OK;
+}
+
+pbm_return pbm_layoutString(pbm_textLayout *layout, const pbm_font *font,
+                            const char *msg) {
+  if (NULL == layout || NULL == font || NULL == msg) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font)) {
+    return PBM_ARGUMENTS;
+  }
+  layout->font = font;
+  layout->msg = msg;
+  layout->length = measureExtent(font, msg, &layout->extent);
+  return PBM_OK;
+}
+
+pbm_return pbm_drawLayout(pbm_image *const imageHandler,
+                          const pbm_textLayout *layout, const uint32_t x,
+                          const uint32_t y, pbm_colors color,
+                          pbm_stringAlignment textAlignment,
+                          const pbm_textStyle *style) {
+  if (NULL == imageHandler || NULL == layout || NULL == layout->font ||
+      NULL == layout->msg || PBM_OK != checkStyle(layout->font, style)) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t scale = textScale(style);
+  uint32_t boxWidth;
+  uint32_t boxHeight;
+  lineBox(style, layout->extent.width * scale, layout->extent.height * scale,
+          &boxWidth, &boxHeight);
+  uint32_t xOffset;
+  uint32_t yOffset;
+  alignmentOffset(textAlignment, boxWidth, boxHeight, &xOffset, &yOffset);
+  uint32_t currentX =
+      ((x == PBM_IMAGE_END) ? imageHandler->width : x) - xOffset;
+  uint32_t currentY =
+      ((y == PBM_IMAGE_END) ? imageHandler->height : y) - yOffset;
+
+  drawLine(imageHandler, NULL, currentX, currentY,
+           layout->extent.width * scale, color, layout->font,
+           (const uint8_t *)layout->msg, layout->length, style, 0, 0);
+  return PBM_OK;
+}
+
+pbm_return pbm_computeGlyphBoxes(const pbm_font *font, pbm_glyphBox *boxes,
+                                 uint32_t count) {
+  if (NULL == font || NULL == font->fontData || NULL == boxes) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font)) {
+    return PBM_ARGUMENTS;
+  }
+  for (uint32_t glyph = 0; glyph < count; glyph++) {
+    computeInkBox(font, glyph, &boxes[glyph]);
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_computeGlyphMetrics(const pbm_font *font,
+                                   pbm_glyphMetrics *metrics, uint32_t count) {
+  if (NULL == font || NULL == font->fontData || NULL == metrics) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font)) {
+    return PBM_ARGUMENTS;
+  }
+  for (uint32_t glyph = 0; glyph < count; glyph++) {
+    pbm_glyphBox box;
+    computeInkBox(font, glyph, &box);
+    if (box.xMin > box.xMax) {
+      metrics[glyph].leftBearing = 0;
+      metrics[glyph].advance = font->width / 2;
+      metrics[glyph].inkWidth = 0;
+    } else {
+      metrics[glyph].leftBearing = box.xMin;
+      metrics[glyph].advance = box.xMax - box.xMin + 1;
+      metrics[glyph].inkWidth = metrics[glyph].advance;
+    }
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_packFont(const pbm_font *font, uint32_t count, uint8_t *data,
+                        uint32_t *dataSize, uint32_t *offsets,
+                        pbm_glyphBox *boxes) {
+  if (NULL == font || NULL == dataSize ||
+      (NULL != data && (NULL == offsets || NULL == boxes))) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font) || PBM_FONT_BITMAP != font->encoding) {
+    return PBM_ARGUMENTS;
+  }
+  // Only the set bits are written, the padding of the glyphs stays cleared
+  if (NULL != data) {
+    memset(data, 0, *dataSize);
+  }
+  uint32_t rowBytes =
+      (font->width + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  uint32_t bytes = 0;
+  for (uint32_t glyph = 0; glyph < count; glyph++) {
+    pbm_glyphBox box;
+    computeInkBox(font, glyph, &box);
+    if (NULL != data) {
+      offsets[glyph] = bytes;
+      boxes[glyph] = box;
+    }
+    if (box.xMin > box.xMax) {
+      continue;
+    }
+    // Line records: 1 bit repeat flag (0) or new line (1) with the box bits
+    uint32_t boxWidth = box.xMax - box.xMin + 1;
+    uint32_t bit = 0;
+    uint8_t previous[FONT_ROW_BUFFER_SIZE];
+    for (uint32_t line = box.yMin; line <= box.yMax; line++) {
+      uint8_t row[FONT_ROW_BUFFER_SIZE];
+      decodeFontRow(font, glyph, line, NULL, row);
+      if (line > box.yMin && 0 == memcmp(row, previous, rowBytes)) {
+        bit++;
+        continue;
+      }
+      memcpy(previous, row, rowBytes);
+      for (uint32_t i = 0; i <= boxWidth; i++, bit++) {
+        uint32_t byteIndex = bytes + bit / IMAGE_BUFFER_BIT_SIZE;
+        if (NULL == data || byteIndex >= *dataSize) {
+          continue;
+        }
+        uint8_t set = 1;
+        if (i > 0) {
+          uint32_t column = box.xMin + i - 1;
+          set = row[column / IMAGE_BUFFER_BIT_SIZE] &
+                (MSB_BIT >> (column % IMAGE_BUFFER_BIT_SIZE));
+        }
+        if (set) {
+          data[byteIndex] |= MSB_BIT >> (bit % IMAGE_BUFFER_BIT_SIZE);
+        }
+      }
+    }
+    bytes += (bit + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  }
+  if (NULL != data && bytes > *dataSize) {
+    *dataSize = bytes;
+    return PBM_SIZE;
+  }
+  *dataSize = bytes;
+  return PBM_OK;
+}
+
+pbm_return pbm_rotateFont(const pbm_font *font, uint32_t count,
+                          pbm_textRotation rotation, uint8_t *data,
+                          uint32_t *dataSize, pbm_font *rotatedFont) {
+  if (NULL == font || NULL == dataSize ||
+      (NULL != data && NULL == rotatedFont)) {
+    return PBM_ARGUMENTS;
+  }
+  if (PBM_OK != checkFont(font)) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t width = font->width;
+  uint32_t height = font->height;
+  switch (rotation) {
+  case PBM_ROTATE_90:
+  case PBM_ROTATE_270:
+    width = font->height;
+    height = font->width;
+    break;
+  case PBM_ROTATE_180:
+    break;
+  default:
+    return PBM_ARGUMENTS;
+  }
+  uint32_t rowBytes =
+      (width + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  uint32_t glyphBytes = rowBytes * height;
+  uint32_t bytes = count * glyphBytes;
+  if (NULL == data) {
+    *dataSize = bytes;
+    return PBM_OK;
+  }
+  if (bytes > *dataSize) {
+    *dataSize = bytes;
+    return PBM_SIZE;
+  }
+  *dataSize = bytes;
+  memset(data, 0, bytes);
+
+  for (uint32_t glyph = 0; glyph < count; glyph++) {
+    uint8_t *rotatedGlyph = &data[glyph * glyphBytes];
+    fontRowCursor cursor = {0, 0, 0};
+    for (uint32_t line = 0; line < font->height; line++) {
+      uint8_t row[FONT_ROW_BUFFER_SIZE];
+      decodeFontRow(font, glyph, line, &cursor, row);
+      for (uint32_t column = 0; column < font->width; column++) {
+        if (0 == (row[column / IMAGE_BUFFER_BIT_SIZE] &
+                  (MSB_BIT >> (column % IMAGE_BUFFER_BIT_SIZE)))) {
+          continue;
+        }
+        // Clockwise rotated position of the pixel
+        uint32_t x = font->width - 1 - column;
+        uint32_t y = font->height - 1 - line;
+        if (PBM_ROTATE_90 == rotation) {
+          x = font->height - 1 - line;
+          y = column;
+        } else if (PBM_ROTATE_270 == rotation) {
+          x = line;
+          y = font->width - 1 - column;
+        }
+        // MSB font lines are little endian values with the first pixel in
+        // the highest bit
+        uint32_t bit = width - 1 - x;
+        rotatedGlyph[y * rowBytes + bit / IMAGE_BUFFER_BIT_SIZE] |=
+            LSB_BIT << (bit % IMAGE_BUFFER_BIT_SIZE);
+      }
+    }
+  }
+
+  memset(rotatedFont, 0, sizeof(*rotatedFont));
+  rotatedFont->fontData = data;
+  rotatedFont->width = (uint8_t)width;
+  rotatedFont->height = (uint8_t)height;
+  rotatedFont->alignment = PBM_DATA_HORIZONTAL_MSB;
+  rotatedFont->encoding = PBM_FONT_BITMAP;
+  return PBM_OK;
+}
+
+pbm_return pbm_addFontRotations(pbm_font *font, uint32_t count, uint8_t *data,
+                                uint32_t *dataSize,
+                                pbm_fontRotations *rotations) {
+  if (NULL == font || NULL == dataSize ||
+      (NULL != data && NULL == rotations)) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t sizes[3];
+  uint32_t bytes = 0;
+  for (uint32_t i = 0; i < 3; i++) {
+    pbm_return retVal =
+        pbm_rotateFont(font, count, (pbm_textRotation)(PBM_ROTATE_90 + i),
+                       NULL, &sizes[i], NULL);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+    bytes += sizes[i];
+  }
+  if (NULL == data) {
+    *dataSize = bytes;
+    return PBM_OK;
+  }
+  if (bytes > *dataSize) {
+    *dataSize = bytes;
+    return PBM_SIZE;
+  }
+  *dataSize = bytes;
+
+  for (uint32_t i = 0; i < 3; i++) {
+    pbm_rotateFont(font, count, (pbm_textRotation)(PBM_ROTATE_90 + i), data,
+                   &sizes[i], &rotations->fonts[i]);
+    rotations->table[i] = &rotations->fonts[i];
+    data += sizes[i];
+  }
+  font->rotations = rotations->table;
+  return PBM_OK;
+}
+
+static pbm_return checkFont(const pbm_font *font) {
+  switch (font->alignment) {
+  case PBM_DATA_HORIZONTAL_LSB:
+  case PBM_DATA_HORIZONTAL_MSB:
+    break;
+  default:
+    return PBM_ARGUMENTS;
+  }
+  switch (font->encoding) {
+  case PBM_FONT_BITMAP:
+    break;
+  case PBM_FONT_PACKED:
+    if (NULL == font->glyphBoxes || NULL == font->glyphOffsets) {
+      return PBM_ARGUMENTS;
+    }
+    break;
+  default:
+    return PBM_ARGUMENTS;
+  }
+  return PBM_OK;
+}
+
+static pbm_return checkStyle(const pbm_font *font, const pbm_textStyle *style) {
+  if (NULL == style) {
+    return PBM_OK;
+  }
+  if (style->scale > PBM_TEXT_SCALE_MAX ||
+      0 != (style->emphasis & ~TEXT_EMPHASIS_MASK)) {
+    return PBM_ARGUMENTS;
+  }
+  switch (style->rotation) {
+  case PBM_ROTATE_0:
+    return PBM_OK;
+  case PBM_ROTATE_90:
+  case PBM_ROTATE_180:
+  case PBM_ROTATE_270:
+    if (0 != style->emphasis) {
+      return PBM_ARGUMENTS;
+    }
+    break;
+  default:
+    return PBM_ARGUMENTS;
+  }
+  // Rotated text needs the pre-rotated font
+  if (NULL == font->rotations) {
+    return PBM_ARGUMENTS;
+  }
+  const pbm_font *rotated = font->rotations[style->rotation - 1];
+  uint8_t sideways = (PBM_ROTATE_180 != style->rotation);
+  if (NULL == rotated || PBM_OK != checkFont(rotated) ||
+      rotated->width != (sideways ? font->height : font->width) ||
+      rotated->height != (sideways ? font->width : font->height)) {
+    return PBM_ARGUMENTS;
+  }
+  return PBM_OK;
+}
+
+static void lineBox(const pbm_textStyle *style, uint32_t lineWidth,
+                    uint32_t lineHeight, uint32_t *boxWidth,
+                    uint32_t *boxHeight) {
+  if (NULL != style && (PBM_ROTATE_90 == style->rotation ||
+                        PBM_ROTATE_270 == style->rotation)) {
+    *boxWidth = lineHeight;
+    *boxHeight = lineWidth;
+    return;
+  }
+  *boxWidth = lineWidth;
+  *boxHeight = lineHeight;
+}
+
+static uint32_t textScale(const pbm_textStyle *style) {
+  return (NULL != style && style->scale > 1) ? style->scale : 1;
+}
+
+static void scaleRow(const uint8_t *src, uint32_t bits, uint32_t factor,
+                     uint8_t *dst) {
+  uint32_t bytes = (bits + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  if (1 == factor) {
+    memcpy(dst, src, bytes);
+    return;
+  }
+  const uint64_t *table = bitScaleTables[factor - 2];
+  for (uint32_t i = 0; i < bytes; i++) {
+    uint64_t entry = table[src[i]];
+    for (uint32_t j = 0; j < factor; j++) {
+      dst[i * factor + j] =
+          (uint8_t)(entry >> (IMAGE_BUFFER_BIT_SIZE * (factor - 1 - j)));
+    }
+  }
+}
+
+static void smoothRow(const uint8_t *previous, const uint8_t *current,
+                      const uint8_t *next, uint32_t width, uint8_t *top,
+                      uint8_t *bottom) {
+  uint32_t bytes =
+      (2 * width + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  memset(top, 0, bytes);
+  memset(bottom, 0, bytes);
+  for (uint32_t i = 0; i < width; i++) {
+    uint8_t mask = MSB_BIT >> (i % IMAGE_BUFFER_BIT_SIZE);
+    uint32_t byte = i / IMAGE_BUFFER_BIT_SIZE;
+    // Neighbours: A above, B right, C left, D below of the pixel P
+    uint8_t p = (0 != (current[byte] & mask));
+    uint8_t a = (0 != (previous[byte] & mask));
+    uint8_t d = (0 != (next[byte] & mask));
+    uint8_t c = (i > 0) && readBits(current, i - 1, 1);
+    uint8_t b = (i + 1 < width) && readBits(current, i + 1, 1);
+    uint8_t pixels[4] = {p, p, p, p};
+    if (c == a && c != d && a != b) {
+      pixels[0] = a;
+    }
+    if (a == b && a != c && b != d) {
+      pixels[1] = b;
+    }
+    if (d == c && d != b && c != a) {
+      pixels[2] = c;
+    }
+    if (b == d && b != a && d != c) {
+      pixels[3] = d;
+    }
+    for (uint32_t j = 0; j < 2; j++) {
+      uint32_t column = 2 * i + j;
+      uint8_t bit = MSB_BIT >> (column % IMAGE_BUFFER_BIT_SIZE);
+      if (pixels[j]) {
+        top[column / IMAGE_BUFFER_BIT_SIZE] |= bit;
+      }
+      if (pixels[2 + j]) {
+        bottom[column / IMAGE_BUFFER_BIT_SIZE] |= bit;
+      }
+    }
+  }
+}
+
+static uint8_t reverseByte(uint8_t value) {
+  value = (uint8_t)((value & 0xF0) >> 4 | (value & 0x0F) << 4);
+  value = (uint8_t)((value & 0xCC) >> 2 | (value & 0x33) << 2);
+  value = (uint8_t)((value & 0xAA) >> 1 | (value & 0x55) << 1);
+  return value;
+}
+
+static uint8_t readBits(const uint8_t *src, uint32_t bitIndex,
+                        uint32_t count) {
+  uint32_t byteIndex = bitIndex / IMAGE_BUFFER_BIT_SIZE;
+  uint32_t bitOffset = bitIndex % IMAGE_BUFFER_BIT_SIZE;
+  uint32_t value = (uint32_t)src[byteIndex] << IMAGE_BUFFER_BIT_SIZE;
+  if (bitOffset + count > IMAGE_BUFFER_BIT_SIZE) {
+    value |= src[byteIndex + 1];
+  }
+  return (uint8_t)((value >> (2 * IMAGE_BUFFER_BIT_SIZE - bitOffset - count)) &
+                   ((1u << count) - 1));
+}
+
+static uint8_t bitmapPixel(const pbm_image *image, uint32_t x, uint32_t y) {
+  const size_t stride = (image->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1;
+  switch (image->alignment) {
+  case PBM_DATA_HORIZONTAL_MSB:
+    return (image->data[y * stride + x / IMAGE_BUFFER_BIT_SIZE] >>
+            (IMAGE_BUFFER_BIT_SIZE - 1 - x % IMAGE_BUFFER_BIT_SIZE)) &
+           1;
+  case PBM_DATA_HORIZONTAL_LSB:
+    return (image->data[y * stride + x / IMAGE_BUFFER_BIT_SIZE] >>
+            (x % IMAGE_BUFFER_BIT_SIZE)) &
+           1;
+  case PBM_DATA_VERTICAL_MSB:
+    return (image->data[(size_t)(y / IMAGE_BUFFER_BIT_SIZE) * image->width +
+                        x] >>
+            (IMAGE_BUFFER_BIT_SIZE - 1 - y % IMAGE_BUFFER_BIT_SIZE)) &
+           1;
+  default:
+    return (image->data[(size_t)(y / IMAGE_BUFFER_BIT_SIZE) * image->width +
+                        x] >>
+            (y % IMAGE_BUFFER_BIT_SIZE)) &
+           1;
+  }
+}
+
+static void writeSpan(pbm_image *imageHandler, uint32_t x, uint32_t y,
+                      const uint8_t *src, uint32_t srcBit, uint32_t count,
+                      pbm_colors color, uint8_t transparent) {
+  uint8_t *data = imageHandler->data;
+
+  switch (IMAGE_ALIGNMENT(imageHandler)) {
+  case PBM_DATA_HORIZONTAL_MSB:
+  case PBM_DATA_HORIZONTAL_LSB: {
+    // The line is a continuous bit range, write it byte per byte
+    uint8_t msb = (PBM_DATA_HORIZONTAL_MSB == IMAGE_ALIGNMENT(imageHandler));
+    uint64_t bitPosition =
+        (uint64_t)y *
+            ((imageHandler->width - 1) / IMAGE_BUFFER_BIT_SIZE + 1) *
+            IMAGE_BUFFER_BIT_SIZE +
+        x;
+    while (count > 0) {
+      uint32_t dstBit = (uint32_t)(bitPosition % IMAGE_BUFFER_BIT_SIZE);
+      uint32_t n = IMAGE_BUFFER_BIT_SIZE - dstBit;
+      if (n > count) {
+        n = count;
+      }
+      uint8_t value = readBits(src, srcBit, n);
+      uint8_t mask;
+      uint8_t bits;
+      if (msb) {
+        uint32_t shift = IMAGE_BUFFER_BIT_SIZE - dstBit - n;
+        mask = (uint8_t)(((1u << n) - 1) << shift);
+        bits = (uint8_t)(value << shift);
+      } else {
+        mask = (uint8_t)(((1u << n) - 1) << dstBit);
+        bits = (uint8_t)(reverseByte((uint8_t)(value << (IMAGE_BUFFER_BIT_SIZE -
+                                                         n)))
+                         << dstBit);
+      }
+      uint8_t *dst = &data[(size_t)(bitPosition / IMAGE_BUFFER_BIT_SIZE)];
+      if (!transparent) {
+        *dst = (uint8_t)((*dst & ~mask) |
+                         ((PBM_BLACK == color) ? bits : (~bits & mask)));
+      } else if (PBM_BLACK == color) {
+        *dst |= bits;
+      } else {
+        *dst &= (uint8_t)~bits;
+      }
+      bitPosition += n;
+      srcBit += n;
+      count -= n;
+    }
+    break;
+  }
+  case PBM_DATA_VERTICAL_MSB:
+  case PBM_DATA_VERTICAL_LSB: {
+    // Every pixel is in an own byte with the same bit pattern
+    uint8_t pattern = (PBM_DATA_VERTICAL_MSB == IMAGE_ALIGNMENT(imageHandler))
+                          ? (MSB_BIT >> (y % IMAGE_BUFFER_BIT_SIZE))
+                          : (LSB_BIT << (y % IMAGE_BUFFER_BIT_SIZE));
+    uint8_t *dst =
+        &data[(size_t)(y / IMAGE_BUFFER_BIT_SIZE) * imageHandler->width + x];
+    for (uint32_t i = 0; i < count; i++, srcBit++) {
+      uint8_t set = src[srcBit / IMAGE_BUFFER_BIT_SIZE] &
+                    (MSB_BIT >> (srcBit % IMAGE_BUFFER_BIT_SIZE));
+      if (transparent && !set) {
+        continue;
+      }
+      if ((0 != set) == (PBM_BLACK == color)) {
+        dst[i] |= pattern;
+      } else {
+        dst[i] &= (uint8_t)~pattern;
+      }
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+static void blitRow(pbm_image *imageHandler, const pbm_rect *clip, uint32_t x,
+                    uint32_t y, const uint8_t *src, uint32_t srcBit,
+                    uint32_t count, pbm_colors color, uint8_t transparent) {
+  int64_t left = 0;
+  int64_t top = 0;
+  int64_t right = imageHandler->width;
+  int64_t bottom = imageHandler->height;
+  if (NULL != clip) {
+    left = (clip->x > left) ? clip->x : left;
+    top = (clip->y > top) ? clip->y : top;
+    if ((int64_t)clip->x + clip->width < right) {
+      right = (int64_t)clip->x + clip->width;
+    }
+    if ((int64_t)clip->y + clip->height < bottom) {
+      bottom = (int64_t)clip->y + clip->height;
+    }
+  }
+  // Wrapped around positions are left or above of the image
+  int64_t yPosition = (int32_t)y;
+  int64_t xPosition = (int32_t)x;
+  if (yPosition < top || yPosition >= bottom) {
+    return;
+  }
+  if (xPosition < left) {
+    if (left - xPosition >= count) {
+      return;
+    }
+    srcBit += (uint32_t)(left - xPosition);
+    count -= (uint32_t)(left - xPosition);
+    xPosition = left;
+  }
+  if (xPosition >= right) {
+    return;
+  }
+  if (xPosition + count > right) {
+    count = (uint32_t)(right - xPosition);
+  }
+  writeSpan(imageHandler, (uint32_t)xPosition, (uint32_t)yPosition, src,
+            srcBit, count, color, transparent);
+}
+
+static void blitPages(pbm_image *imageHandler, uint32_t x, uint32_t y,
+                      const pbm_image *bitmap, pbm_colors color,
+                      uint8_t transparent) {
+  // Wrapped around positions are left or above of the image
+  int64_t xPosition = (int32_t)x;
+  int64_t yPosition = (int32_t)y;
+  int64_t firstColumn = (xPosition < 0) ? -xPosition : 0;
+  int64_t lastColumn = (int64_t)imageHandler->width - xPosition;
+  if (lastColumn > bitmap->width) {
+    lastColumn = bitmap->width;
+  }
+  const int64_t pages =
+      ((int64_t)imageHandler->height + IMAGE_BUFFER_BIT_SIZE - 1) /
+      IMAGE_BUFFER_BIT_SIZE;
+  const uint8_t msb = (PBM_DATA_VERTICAL_MSB == bitmap->alignment);
+  uint8_t *data = imageHandler->data;
+
+  for (uint32_t page = 0; page * IMAGE_BUFFER_BIT_SIZE < bitmap->height;
+       page++) {
+    // Bits of the page inside of the bitmap and of the image
+    int64_t firstLine = yPosition + (int64_t)page * IMAGE_BUFFER_BIT_SIZE;
+    uint8_t mask = 0;
+    for (uint32_t bit = 0; bit < IMAGE_BUFFER_BIT_SIZE; bit++) {
+      int64_t line = firstLine + bit;
+      if (page * IMAGE_BUFFER_BIT_SIZE + bit < bitmap->height && line >= 0 &&
+          line < imageHandler->height) {
+        mask |= msb ? (MSB_BIT >> bit) : (LSB_BIT << bit);
+      }
+    }
+    if (0 == mask) {
+      continue;
+    }
+    // The page covers two bytes of the image with the line offset
+    int64_t imagePage = (firstLine >= 0)
+                            ? firstLine / IMAGE_BUFFER_BIT_SIZE
+                            : -((IMAGE_BUFFER_BIT_SIZE - 1 - firstLine) /
+                                IMAGE_BUFFER_BIT_SIZE);
+    uint32_t shift = (uint32_t)(firstLine - imagePage * IMAGE_BUFFER_BIT_SIZE);
+    const uint8_t *src = &bitmap->data[(size_t)page * bitmap->width];
+    for (int64_t column = firstColumn; column < lastColumn; column++) {
+      uint8_t ink = src[column] & mask;
+      uint8_t write = transparent ? ink : mask;
+      uint8_t set = (PBM_BLACK == color) ? ink : (uint8_t)(mask & ~ink);
+      uint16_t writeBits = msb ? (uint16_t)(write << IMAGE_BUFFER_BIT_SIZE >>
+                                            shift)
+                               : (uint16_t)(write << shift);
+      uint16_t setBits =
+          msb ? (uint16_t)(set << IMAGE_BUFFER_BIT_SIZE >> shift)
+              : (uint16_t)(set << shift);
+      // First byte of the page in the image, then the byte below
+      uint8_t firstWrite = msb ? (uint8_t)(writeBits >> IMAGE_BUFFER_BIT_SIZE)
+                               : (uint8_t)writeBits;
+      uint8_t firstSet =
+          msb ? (uint8_t)(setBits >> IMAGE_BUFFER_BIT_SIZE) : (uint8_t)setBits;
+      uint8_t secondWrite = msb ? (uint8_t)writeBits
+                                : (uint8_t)(writeBits >> IMAGE_BUFFER_BIT_SIZE);
+      uint8_t secondSet =
+          msb ? (uint8_t)setBits : (uint8_t)(setBits >> IMAGE_BUFFER_BIT_SIZE);
+      size_t index = (size_t)(xPosition + column);
+      if (imagePage >= 0 && imagePage < pages && 0 != firstWrite) {
+        uint8_t *byte = &data[(size_t)imagePage * imageHandler->width + index];
+        *byte = (uint8_t)((*byte & ~firstWrite) | (firstSet & firstWrite));
+      }
+      if (imagePage + 1 >= 0 && imagePage + 1 < pages && 0 != secondWrite) {
+        uint8_t *byte =
+            &data[(size_t)(imagePage + 1) * imageHandler->width + index];
+        *byte = (uint8_t)((*byte & ~secondWrite) | (secondSet & secondWrite));
+      }
+    }
+  }
+}
+
+static uint8_t rangeMask(uint32_t byte, uint32_t start, uint32_t end,
+                         uint8_t msb) {
+  uint32_t first = byte * IMAGE_BUFFER_BIT_SIZE;
+  uint32_t low = (start > first) ? start - first : 0;
+  uint32_t high = (end < first + IMAGE_BUFFER_BIT_SIZE) ? end - first
+                                                        : IMAGE_BUFFER_BIT_SIZE;
+  if (end <= first || low >= high) {
+    return 0;
+  }
+  uint32_t bits = ((1u << (high - low)) - 1);
+  return (uint8_t)(msb ? bits << (IMAGE_BUFFER_BIT_SIZE - high) : bits << low);
+}
+
+static void fillLine(uint8_t *line, uint32_t step, uint8_t msb,
+                     uint32_t start, uint32_t length, pbm_colors color) {
+  uint32_t end = start + length;
+  for (uint32_t byte = start / IMAGE_BUFFER_BIT_SIZE;
+       byte <= (end - 1) / IMAGE_BUFFER_BIT_SIZE; byte++) {
+    uint8_t mask = rangeMask(byte, start, end, msb);
+    if (PBM_BLACK == color) {
+      line[(size_t)byte * step] |= mask;
+    } else {
+      line[(size_t)byte * step] &= (uint8_t)~mask;
+    }
+  }
+}
 
+static void shiftLine(uint8_t *line, uint32_t step, uint8_t msb,
+                      uint32_t start, uint32_t length, int32_t shift,
+                      pbm_colors fill) {
+  const uint32_t end = start + length;
+  const uint32_t firstByte = start / IMAGE_BUFFER_BIT_SIZE;
+  const uint32_t lastByte = (end - 1) / IMAGE_BUFFER_BIT_SIZE;
+  // Pixels with a source inside of the range
+  const uint32_t movedStart = (shift > 0) ? start + (uint32_t)shift : start;
+  const uint32_t movedEnd = (shift > 0) ? end : end - (uint32_t)-shift;
+  const uint32_t bytes = lastByte - firstByte + 1;
+
+  // Moving to higher pixels reads the lower bytes, process them last
+  for (uint32_t i = 0; i < bytes; i++) {
+    uint32_t byte = (shift > 0) ? lastByte - i : firstByte + i;
+    uint8_t inside = rangeMask(byte, start, end, msb);
+    uint8_t moved = rangeMask(byte, movedStart, movedEnd, msb);
+    uint8_t value = 0;
+    if (0 != moved) {
+      int64_t source = (int64_t)byte * IMAGE_BUFFER_BIT_SIZE - shift;
+      int64_t sourceByte = source / IMAGE_BUFFER_BIT_SIZE;
+      if (source < 0 && 0 != source % IMAGE_BUFFER_BIT_SIZE) {
+        sourceByte--;
+      }
+      uint32_t offset =
+          (uint32_t)(source - sourceByte * IMAGE_BUFFER_BIT_SIZE);
+      uint32_t pair = 0;
+      // Bytes outside of the range are not read, their bits are not moved
+      if (sourceByte >= firstByte && sourceByte <= lastByte) {
+        pair = line[(size_t)sourceByte * step];
+      }
+      if (sourceByte + 1 >= firstByte && sourceByte + 1 <= lastByte) {
+        uint32_t next = line[(size_t)(sourceByte + 1) * step];
+        pair = msb ? (pair << IMAGE_BUFFER_BIT_SIZE) | next
+                   : pair | (next << IMAGE_BUFFER_BIT_SIZE);
+      } else if (msb) {
+        pair <<= IMAGE_BUFFER_BIT_SIZE;
+      }
+      value = msb ? (uint8_t)(pair >> (IMAGE_BUFFER_BIT_SIZE - offset))
+                  : (uint8_t)(pair >> offset);
+    }
+    uint8_t *dst = &line[(size_t)byte * step];
+    uint8_t filled = (PBM_BLACK == fill) ? (uint8_t)(inside & ~moved) : 0;
+    *dst = (uint8_t)((*dst & ~inside) | (value & moved) | filled);
+  }
+}
+
+static void copyRange(uint8_t *dst, const uint8_t *src, uint32_t bytes,
+                      uint8_t firstMask, uint8_t lastMask) {
+  if (1 == bytes) {
+    uint8_t mask = firstMask & lastMask;
+    *dst = (uint8_t)((*dst & ~mask) | (*src & mask));
+    return;
+  }
+  uint8_t first = (uint8_t)((*dst & ~firstMask) | (*src & firstMask));
+  uint8_t last = (uint8_t)((dst[bytes - 1] & ~lastMask) |
+                           (src[bytes - 1] & lastMask));
+  memmove(dst, src, bytes);
+  dst[0] = first;
+  dst[bytes - 1] = last;
+}
+
+static void decodeFontRow(const pbm_font *font, uint32_t glyph, uint32_t line,
+                          fontRowCursor *cursor, uint8_t *row) {
+  if (PBM_FONT_PACKED == font->encoding) {
+    uint32_t rowBytes = (font->width + IMAGE_BUFFER_BIT_SIZE - 1) /
+                        IMAGE_BUFFER_BIT_SIZE;
+    memset(row, 0, rowBytes);
+    const pbm_glyphBox *box = &font->glyphBoxes[glyph];
+    if (box->xMin > box->xMax || line < box->yMin || line > box->yMax) {
+      return;
+    }
+    fontRowCursor single = {0, 0, 0};
+    if (NULL == cursor) {
+      cursor = &single;
+    }
+    // A new glyph or a line before the cursor starts at the first record
+    if (cursor->nextLine <= box->yMin || line + 1 < cursor->nextLine) {
+      cursor->nextLine = box->yMin;
+      cursor->bit = 0;
+      cursor->rowBit = 0;
+    }
+    // Walk over the line records up to the desired line
+    const uint8_t *data = &font->fontData[font->glyphOffsets[glyph]];
+    uint32_t boxWidth = box->xMax - box->xMin + 1;
+    for (; cursor->nextLine <= line; cursor->nextLine++) {
+      if (readBits(data, cursor->bit, 1)) {
+        cursor->rowBit = cursor->bit + 1;
+        cursor->bit += boxWidth;
+      }
+      cursor->bit++;
+    }
+    uint32_t rowBit = cursor->rowBit;
+    for (uint32_t i = 0; i < boxWidth; i++) {
+      if (readBits(data, rowBit + i, 1)) {
+        uint32_t column = box->xMin + i;
+        row[column / IMAGE_BUFFER_BIT_SIZE] |=
+            MSB_BIT >> (column % IMAGE_BUFFER_BIT_SIZE);
+      }
+    }
+    return;
+  }
+  // Font lines are stored as little endian values with the first pixel on the
+  // highest bit (MSB) or as the mirrored value (LSB)
+  uint32_t rowBytes = (font->width + IMAGE_BUFFER_BIT_SIZE - 1) /
+                      IMAGE_BUFFER_BIT_SIZE;
+  uint32_t padding = rowBytes * IMAGE_BUFFER_BIT_SIZE - font->width;
+  const unsigned char *src =
+      &font->fontData[(glyph * font->height + line) * rowBytes];
+  uint8_t lsb = (PBM_DATA_HORIZONTAL_LSB == font->alignment);
+
+  for (uint32_t i = 0; i < rowBytes; i++) {
+    uint8_t high = lsb ? reverseByte(src[i]) : src[rowBytes - 1 - i];
+    uint8_t low = 0;
+    if (i + 1 < rowBytes) {
+      low = lsb ? reverseByte(src[i + 1]) : src[rowBytes - 2 - i];
+    }
+    row[i] = (uint8_t)((high << padding) |
+                       (low >> (IMAGE_BUFFER_BIT_SIZE - padding)));
+  }
+}
+
+static void decodeStyledRow(const pbm_font *font, uint32_t glyph,
+                            uint32_t line, const pbm_textStyle *style,
+                            fontRowCursor *cursor, uint8_t *row) {
+  decodeFontRow(font, glyph, line, cursor, row);
+  if (NULL == style || 0 == style->emphasis) {
+    return;
+  }
+  uint32_t rowBytes =
+      (font->width + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  if ((PBM_TEXT_UNDERLINE & style->emphasis && line == font->height - 1u) ||
+      (PBM_TEXT_STRIKE & style->emphasis && line == font->height / 2u)) {
+    memset(row, 0xFF, rowBytes);
+  } else {
+    uint32_t first;
+    uint32_t last;
+    if (PBM_TEXT_ITALIC & style->emphasis &&
+        rowInk(row, rowBytes, &first, &last)) {
+      // Slant around the middle line, the bottom lines to the left and the
+      // top lines to the right, but never beyond the drawn columns
+      uint32_t slant = (font->height - 1) / ITALIC_SLOPE;
+      int32_t shift = (int32_t)((font->height - 1 - line) / ITALIC_SLOPE) -
+                      (int32_t)(slant / 2);
+      int32_t leftColumn = 0;
+      int32_t rightColumn = (int32_t)font->width - 1;
+      if (NULL != font->metrics) {
+        const pbm_glyphMetrics *metric = &font->metrics[glyph];
+        leftColumn = metric->leftBearing;
+        if (leftColumn + metric->advance - 1 < rightColumn) {
+          rightColumn = leftColumn + metric->advance - 1;
+        }
+      }
+      int32_t right = rightColumn - (int32_t)last;
+      int32_t left = (int32_t)first - leftColumn;
+      if (shift > 0) {
+        shift = (shift < right) ? shift : (right > 0) ? right : 0;
+      } else if (shift < 0) {
+        shift = (-shift < left) ? shift : (left > 0) ? -left : 0;
+      }
+      if (0 != shift) {
+        shiftLine(row, 1, 1, 0, font->width, shift, PBM_WHITE);
+      }
+    }
+    if (PBM_TEXT_BOLD & style->emphasis) {
+      uint8_t carry = 0;
+      for (uint32_t i = 0; i < rowBytes; i++) {
+        uint8_t value = row[i];
+        row[i] = (uint8_t)(value | value >> 1 | carry);
+        carry = (uint8_t)(value << (IMAGE_BUFFER_BIT_SIZE - 1));
+      }
+    }
+  }
+  // Cut the bold pixels shifted out of the glyph cell
+  if (0 != font->width % IMAGE_BUFFER_BIT_SIZE) {
+    row[rowBytes - 1] &=
+        (uint8_t)(0xFF << (IMAGE_BUFFER_BIT_SIZE -
+                           font->width % IMAGE_BUFFER_BIT_SIZE));
+  }
+}
+
+static void drawEmphasisGap(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, uint32_t width,
+                            pbm_colors color, const pbm_font *font,
+                            const pbm_textStyle *style) {
+  uint32_t scale = textScale(style);
+  uint32_t lines[2];
+  uint32_t lineCount = 0;
+  if (PBM_TEXT_STRIKE & style->emphasis) {
+    lines[lineCount++] = font->height / 2;
+  }
+  if (PBM_TEXT_UNDERLINE & style->emphasis) {
+    lines[lineCount++] = font->height - 1;
+  }
+  for (uint32_t i = 0; i < lineCount; i++) {
+    for (uint32_t j = 0; j < scale; j++) {
+      // The empty line is written opaque with the inverted color to fill it
+      uint32_t position = x;
+      uint32_t remaining = width;
+      while (remaining > 0) {
+        uint32_t count = FONT_ROW_BUFFER_SIZE * IMAGE_BUFFER_BIT_SIZE;
+        count = (remaining < count) ? remaining : count;
+        blitRow(imageHandler, clip, position, y + lines[i] * scale + j,
+                emptyFontRow, 0, count, !color, 0);
+        position += count;
+        remaining -= count;
+      }
+    }
+  }
+}
+
+static void drawGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                      uint32_t x, uint32_t y, uint32_t pen, uint32_t lineWidth,
+                      pbm_colors color, const pbm_font *font, uint32_t glyph,
+                      const pbm_textStyle *style) {
+  if (0 == font->width || 0 == font->height) {
+    return;
+  }
+  uint8_t transparent = (NULL != style && PBM_TEXT_TRANSPARENT == style->mode);
+  uint8_t emphasis = (NULL != style) ? style->emphasis : 0;
+  uint32_t firstLine = 0;
+  uint32_t lastLine = font->height - 1;
+  uint32_t firstColumn = 0;
+  uint32_t lastColumn = font->width - 1;
+  uint32_t originColumn = 0;
+
+  if (NULL != font->metrics) {
+    // Proportional glyph, draw only the columns of the advance
+    const pbm_glyphMetrics *metric = &font->metrics[glyph];
+    if (0 == metric->advance || metric->leftBearing >= font->width) {
+      return;
+    }
+    originColumn = metric->leftBearing;
+    firstColumn = metric->leftBearing;
+    if (firstColumn + metric->advance - 1 < lastColumn) {
+      lastColumn = firstColumn + metric->advance - 1;
+    }
+  }
+
+  uint32_t scale = textScale(style);
+  uint32_t cellX = pen - originColumn * scale;
+  if (NULL != style && PBM_ROTATE_0 != style->rotation) {
+    drawRotatedGlyph(imageHandler, clip, x, y, cellX, lineWidth, color, font,
+                     glyph, firstColumn, lastColumn, style);
+    return;
+  }
+  x += cellX;
+
+  if (1 == scale && PBM_FONT_PACKED == font->encoding && 0 == emphasis) {
+    drawPackedGlyph(imageHandler, clip, x, y, color, font, glyph, firstColumn,
+                    lastColumn, transparent);
+    return;
+  }
+
+  if (transparent && NULL != font->glyphBoxes && 0 == emphasis) {
+    // Only the ink of the glyph has to be drawn
+    if (!cropToInk(font, glyph, &firstColumn, &lastColumn, &firstLine,
+                   &lastLine)) {
+      return;
+    }
+  }
+
+  if (scale > 1) {
+    drawScaledGlyph(imageHandler, clip, x, y, color, font, glyph, firstColumn,
+                    lastColumn, firstLine, lastLine, style);
+    return;
+  }
+
+  fontRowCursor cursor = {0, 0, 0};
+  for (uint32_t line = firstLine; line <= lastLine; line++) {
+    uint8_t row[FONT_ROW_BUFFER_SIZE];
+    decodeStyledRow(font, glyph, line, style, &cursor, row);
+    blitRow(imageHandler, clip, x + firstColumn, y + line, row, firstColumn,
+            lastColumn - firstColumn + 1, color, transparent);
+  }
+}
+
+static uint8_t cropToInk(const pbm_font *font, uint32_t glyph,
+                         uint32_t *firstColumn, uint32_t *lastColumn,
+                         uint32_t *firstLine, uint32_t *lastLine) {
+  const pbm_glyphBox *box = &font->glyphBoxes[glyph];
+  if (box->xMin > box->xMax || box->xMin > *lastColumn ||
+      box->xMax < *firstColumn) {
+    return 0;
+  }
+  *firstLine = box->yMin;
+  *lastLine = box->yMax;
+  *firstColumn = (box->xMin > *firstColumn) ? box->xMin : *firstColumn;
+  *lastColumn = (box->xMax < *lastColumn) ? box->xMax : *lastColumn;
+  return 1;
+}
+
+static void drawRotatedGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                             uint32_t x, uint32_t y, uint32_t cellX,
+                             uint32_t lineWidth, pbm_colors color,
+                             const pbm_font *font, uint32_t glyph,
+                             uint32_t firstColumn, uint32_t lastColumn,
+                             const pbm_textStyle *style) {
+  const pbm_font *rotated = font->rotations[style->rotation - 1];
+  uint32_t scale = textScale(style);
+  uint32_t width = font->width - 1;
+  uint32_t height = font->height - 1;
+  uint32_t firstLine = 0;
+  uint32_t lastLine = height;
+  if (PBM_TEXT_TRANSPARENT == style->mode && NULL != font->glyphBoxes) {
+    if (!cropToInk(font, glyph, &firstColumn, &lastColumn, &firstLine,
+                   &lastLine)) {
+      return;
+    }
+  }
+
+  // Map the upright cell part and position to the rotated cell (clockwise)
+  switch (style->rotation) {
+  case PBM_ROTATE_90:
+    drawScaledGlyph(imageHandler, clip, x, y + cellX, color, rotated, glyph,
+                    height - lastLine, height - firstLine, firstColumn,
+                    lastColumn, style);
+    break;
+  case PBM_ROTATE_180:
+    drawScaledGlyph(imageHandler, clip,
+                    x + lineWidth - cellX - font->width * scale, y, color,
+                    rotated, glyph, width - lastColumn, width - firstColumn,
+                    height - lastLine, height - firstLine, style);
+    break;
+  case PBM_ROTATE_270:
+    drawScaledGlyph(imageHandler, clip, x,
+                    y + lineWidth - cellX - font->width * scale, color,
+                    rotated, glyph, firstLine, lastLine, width - lastColumn,
+                    width - firstColumn, style);
+    break;
+  default:
+    break;
+  }
+}
+
+static void computeInkBox(const pbm_font *font, uint32_t glyph,
+                          pbm_glyphBox *box) {
+  if (PBM_FONT_PACKED == font->encoding) {
+    *box = font->glyphBoxes[glyph];
+    return;
+  }
+  uint32_t rowBytes = (font->width + IMAGE_BUFFER_BIT_SIZE - 1) /
+                      IMAGE_BUFFER_BIT_SIZE;
+  box->xMin = UINT8_MAX;
+  box->yMin = UINT8_MAX;
+  box->xMax = 0;
+  box->yMax = 0;
+  for (uint32_t line = 0; line < font->height; line++) {
+    uint8_t row[FONT_ROW_BUFFER_SIZE];
+    decodeFontRow(font, glyph, line, NULL, row);
+    uint32_t first;
+    uint32_t last;
+    if (rowInk(row, rowBytes, &first, &last)) {
+      box->xMin = (first < box->xMin) ? first : box->xMin;
+      box->xMax = (last > box->xMax) ? last : box->xMax;
+      box->yMin = (line < box->yMin) ? line : box->yMin;
+      box->yMax = line;
+    }
+  }
+}
+
+static uint8_t rowInk(const uint8_t *row, uint32_t rowBytes, uint32_t *first,
+                      uint32_t *last) {
+  uint32_t i = 0;
+  while (i < rowBytes && 0 == row[i]) {
+    i++;
+  }
+  if (i == rowBytes) {
+    return 0;
+  }
+  *first = i * IMAGE_BUFFER_BIT_SIZE;
+  while (!(row[*first / IMAGE_BUFFER_BIT_SIZE] &
+           (MSB_BIT >> (*first % IMAGE_BUFFER_BIT_SIZE)))) {
+    (*first)++;
+  }
+  *last = rowBytes * IMAGE_BUFFER_BIT_SIZE - 1;
+  while (!(row[*last / IMAGE_BUFFER_BIT_SIZE] &
+           (MSB_BIT >> (*last % IMAGE_BUFFER_BIT_SIZE)))) {
+    (*last)--;
+  }
+  return 1;
+}
+
+static uint32_t glyphColumns(const pbm_font *font, uint32_t glyph) {
+  if (NULL == font->metrics) {
+    return font->width;
+  }
+  return font->metrics[glyph].advance;
+}
+
+static int32_t kerningOffset(const pbm_font *font, uint32_t left,
+                             uint32_t right) {
+  if (NULL == font->kerning) {
+    return 0;
+  }
+  uint32_t key = left << 16 | right;
+  uint32_t low = 0;
+  uint32_t high = font->kerningCount;
+  while (low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    const pbm_kerningPair *pair = &font->kerning[middle];
+    uint32_t pairKey = (uint32_t)pair->left << 16 | pair->right;
+    if (pairKey == key) {
+      return pair->offset;
+    }
+    if (pairKey < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return 0;
+}
+
+static uint32_t decodeUtf8(const uint8_t **text, const uint8_t *end) {
+#define UTF8_REPLACEMENT (0xFFFD)
+  // Smallest codepoint of a sequence with the number of following bytes
+  static const uint32_t minimum[] = {0, 0x80, 0x800, 0x10000};
+  const uint8_t *position = *text;
+  uint32_t codepoint = *position++;
+  uint32_t following;
+
+  if (codepoint < 0x80) {
+    *text = position;
+    return codepoint;
+  } else if (codepoint >= 0xF0 && codepoint < 0xF5) {
+    following = 3;
+    codepoint &= 0x07;
+  } else if (codepoint >= 0xE0 && codepoint < 0xF0) {
+    following = 2;
+    codepoint &= 0x0F;
+  } else if (codepoint >= 0xC0 && codepoint < 0xE0) {
+    following = 1;
+    codepoint &= 0x1F;
+  } else {
+    // Continuation byte or lead byte of a codepoint above U+10FFFF
+    *text = position;
+    return UTF8_REPLACEMENT;
+  }
+  for (uint32_t i = 0; i < following; i++) {
+    if ((NULL != end && position >= end) || 0x80 != (*position & 0xC0)) {
+      *text = position;
+      return UTF8_REPLACEMENT;
+    }
+    codepoint = codepoint << 6 | (*position++ & 0x3F);
+  }
+  *text = position;
+  if (codepoint < minimum[following] || codepoint > 0x10FFFF ||
+      (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+    return UTF8_REPLACEMENT;
+  }
+  return codepoint;
+}
+
+static uint32_t lookupGlyph(const pbm_font *font, uint32_t codepoint) {
+  if (NULL == font->glyphMap || 0 == font->glyphMapCount) {
+    return (codepoint <= UINT8_MAX) ? codepoint : font->defaultGlyph;
+  }
+  // Hot range (e.g. ASCII) without search
+  const pbm_glyphRange *range = &font->glyphMap[0];
+  if (codepoint - range->first < range->count) {
+    return range->glyph + (codepoint - range->first);
+  }
+  uint32_t low = 1;
+  uint32_t high = font->glyphMapCount;
+  while (low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    range = &font->glyphMap[middle];
+    if (codepoint < range->first) {
+      high = middle;
+    } else if (codepoint - range->first >= range->count) {
+      low = middle + 1;
+    } else {
+      return range->glyph + (codepoint - range->first);
+    }
+  }
+  return font->defaultGlyph;
+}
+
+static uint32_t nextGlyph(const pbm_font *font, const uint8_t **text,
+                          const uint8_t *end) {
+  if (NULL == font->glyphMap) {
+    return *(*text)++;
+  }
+  return lookupGlyph(font, decodeUtf8(text, end));
+}
+
+static uint32_t measureLine(const pbm_font *font, const char *msg,
+                            uint32_t *length) {
+  if (NULL == font->metrics && NULL == font->kerning &&
+      NULL == font->glyphMap) {
+    uint32_t stringLen = strlen(msg);
+    *length = stringLen;
+    if (0 == stringLen) {
+      return 0;
+    }
+    return (stringLen - 1) * (font->width + CHARACTER_GAP) + font->width;
+  }
+  const uint8_t *character = (const uint8_t *)msg;
+  int32_t width = 0;
+  uint32_t previousGlyph = 0;
+  uint8_t first = 1;
+  while (*character != '\0') {
+    uint32_t glyph = nextGlyph(font, &character, NULL);
+    if (!first) {
+      width += CHARACTER_GAP + kerningOffset(font, previousGlyph, glyph);
+    }
+    width += glyphColumns(font, glyph);
+    previousGlyph = glyph;
+    first = 0;
+  }
+  *length = (uint32_t)(character - (const uint8_t *)msg);
+  return (width > 0) ? (uint32_t)width : 0;
+}
+
+static void measureInk(const pbm_font *font, const uint8_t *msg,
+                       uint32_t length, pbm_textExtent *extent) {
+  int32_t inkLeft = INT32_MAX;
+  int32_t inkRight = INT32_MIN;
+  uint32_t inkTop = UINT32_MAX;
+  uint32_t inkBottom = 0;
+  int32_t penX = 0;
+  const uint8_t *end = msg + length;
+  uint32_t glyph = 0;
+
+  while (msg < end) {
+    glyph = nextGlyph(font, &msg, end);
+    pbm_glyphBox box;
+    if (NULL != font->glyphBoxes) {
+      box = font->glyphBoxes[glyph];
+    } else {
+      computeInkBox(font, glyph, &box);
+    }
+    int32_t firstColumn = 0;
+    int32_t lastColumn = (int32_t)font->width - 1;
+    int32_t originColumn = 0;
+    if (NULL != font->metrics) {
+      originColumn = font->metrics[glyph].leftBearing;
+      firstColumn = originColumn;
+      lastColumn = originColumn + font->metrics[glyph].advance - 1;
+    }
+    firstColumn = (box.xMin > firstColumn) ? box.xMin : firstColumn;
+    lastColumn = (box.xMax < lastColumn) ? box.xMax : lastColumn;
+    if (box.xMin <= box.xMax && firstColumn <= lastColumn) {
+      if (penX + firstColumn - originColumn < inkLeft) {
+        inkLeft = penX + firstColumn - originColumn;
+      }
+      if (penX + lastColumn - originColumn > inkRight) {
+        inkRight = penX + lastColumn - originColumn;
+      }
+      inkTop = (box.yMin < inkTop) ? box.yMin : inkTop;
+      inkBottom = (box.yMax > inkBottom) ? box.yMax : inkBottom;
+    }
+    penX += glyphColumns(font, glyph) + CHARACTER_GAP;
+    if (msg < end) {
+      // Kerning to the following glyph
+      const uint8_t *following = msg;
+      penX += kerningOffset(font, glyph, nextGlyph(font, &following, end));
+    }
+  }
+
+  if (inkLeft > inkRight) {
+    extent->inkX = 0;
+    extent->inkY = 0;
+    extent->inkWidth = 0;
+    extent->inkHeight = 0;
+    return;
+  }
+  extent->inkX = (uint32_t)inkLeft;
+  extent->inkY = inkTop;
+  extent->inkWidth = (uint32_t)(inkRight - inkLeft + 1);
+  extent->inkHeight = inkBottom - inkTop + 1;
+}
+
+static uint32_t measureExtent(const pbm_font *font, const char *msg,
+                              pbm_textExtent *extent) {
+  uint32_t length;
+  extent->width = measureLine(font, msg, &length);
+  extent->height = font->height;
+  measureInk(font, (const uint8_t *)msg, length, extent);
+  return length;
+}
+
+static void layoutTextBox(pbm_textBoxCache *cache, const char *text) {
+  const pbm_font *font = cache->font;
+  const uint8_t *chars = (const uint8_t *)text;
+  const uint32_t spaceGlyph = lookupGlyph(font, ' ');
+  uint32_t maxLines = PBM_TEXTBOX_MAX_LINES;
+  if (cache->boxHeight + LINE_GAP < (font->height + LINE_GAP) * maxLines) {
+    maxLines = (cache->boxHeight + LINE_GAP) / (font->height + LINE_GAP);
+  }
+  uint32_t position = 0;
+  cache->lineCount = 0;
+
+  while ('\0' != chars[position] && cache->lineCount < maxLines) {
+    pbm_textLine *line = &cache->lines[cache->lineCount++];
+    uint32_t i = position;
+    int32_t width = 0;
+    uint16_t spaces = 0;
+    // Last break position between words
+    uint32_t breakEnd = 0;
+    int32_t breakWidth = 0;
+    uint16_t breakSpaces = 0;
+    uint8_t hasBreak = 0;
+
+    uint32_t previousGlyph = 0;
+
+    line->start = position;
+    line->lastLine = 1;
+    while ('\0' != chars[i] && '\n' != chars[i]) {
+      const uint8_t *following = &chars[i];
+      uint32_t glyph = nextGlyph(font, &following, NULL);
+      int32_t advance = glyphColumns(font, glyph);
+      if (i > position) {
+        advance += CHARACTER_GAP + kerningOffset(font, previousGlyph, glyph);
+      }
+      if (PBM_WRAP_NONE != cache->wrapMode && i > position &&
+          width + advance > (int32_t)cache->boxWidth && ' ' != chars[i]) {
+        line->lastLine = 0;
+        if (PBM_WRAP_WORD == cache->wrapMode && hasBreak) {
+          // Break after the last complete word
+          i = breakEnd;
+          width = breakWidth;
+          spaces = breakSpaces;
+        }
+        break;
+      }
+      if (' ' == chars[i] && i > position && ' ' != chars[i - 1]) {
+        hasBreak = 1;
+        breakEnd = i;
+        breakWidth = width;
+        breakSpaces = spaces;
+      }
+      spaces += (' ' == chars[i]);
+      width += advance;
+      previousGlyph = glyph;
+      i = (uint32_t)(following - chars);
+    }
+
+    // Remove the trailing spaces of the line
+    uint32_t end = i;
+    while (end > position && ' ' == chars[end - 1]) {
+      end--;
+      spaces--;
+      width -= glyphColumns(font, spaceGlyph) + CHARACTER_GAP;
+    }
+    line->length = end - position;
+    line->width = (width > 0) ? (uint32_t)width : 0;
+    line->spaces = spaces;
+
+    // Skip the spaces and the newline to the next line
+    while (' ' == chars[i]) {
+      i++;
+    }
+    if ('\n' == chars[i]) {
+      line->lastLine = 1;
+      i++;
+    } else if ('\0' == chars[i]) {
+      line->lastLine = 1;
+    }
+    position = i;
+  }
+}
+
+static void alignmentOffset(pbm_stringAlignment textAlignment, uint32_t width,
+                            uint32_t height, uint32_t *xOffset,
+                            uint32_t *yOffset) {
   switch (textAlignment) {
   case PBM_STRING_LEFT_TOP:
   case PBM_STRING_LEFT_CENTER:
   case PBM_STRING_LEFT_BOTTOM:
-    xOffset = 0;
+  case PBM_STRING_JUSTIFY_TOP:
+  case PBM_STRING_JUSTIFY_CENTER:
+  case PBM_STRING_JUSTIFY_BOTTOM:
+    *xOffset = 0;
     break;
   case PBM_STRING_CENTER_TOP:
   case PBM_STRING_CENTER_CENTER:
   case PBM_STRING_CENTER_BOTTOM:
-    xOffset = msgBitLen / 2;
+    *xOffset = width / 2;
     break;
   case PBM_STRING_RIGHT_TOP:
   case PBM_STRING_RIGHT_CENTER:
   case PBM_STRING_RIGHT_BOTTOM:
-    xOffset = msgBitLen;
+    *xOffset = width;
     break;
   default:
-    xOffset = 0;
+    *xOffset = 0;
     break;
   }
 
@@ -362,52 +2729,201 @@ pbm_return pbm_writeString(pbm_image *const imageHandler, const uint32_t x,
   case PBM_STRING_LEFT_TOP:
   case PBM_STRING_CENTER_TOP:
   case PBM_STRING_RIGHT_TOP:
-    yOffset = 0;
+  case PBM_STRING_JUSTIFY_TOP:
+    *yOffset = 0;
     break;
   case PBM_STRING_LEFT_CENTER:
   case PBM_STRING_CENTER_CENTER:
   case PBM_STRING_RIGHT_CENTER:
-    yOffset = font->height / 2;
+  case PBM_STRING_JUSTIFY_CENTER:
+    *yOffset = height / 2;
     break;
   case PBM_STRING_LEFT_BOTTOM:
   case PBM_STRING_CENTER_BOTTOM:
   case PBM_STRING_RIGHT_BOTTOM:
-    yOffset = font->height;
+  case PBM_STRING_JUSTIFY_BOTTOM:
+    *yOffset = height;
     break;
   default:
-    yOffset = 0;
+    *yOffset = 0;
     break;
   }
+}
 
-  uint32_t currentX =
-      ((x == PBM_IMAGE_END) ? imageHandler->width : x) - xOffset;
-  uint32_t currentY =
-      ((y == PBM_IMAGE_END) ? imageHandler->height : y) - yOffset;
-
-  while (*msg != '\0') {
-    pbm_writeChar(imageHandler, currentX, currentY, color, font, *msg++);
-    currentX += font->width + CHARACTER_GAP;
+static void drawLine(pbm_image *imageHandler, const pbm_rect *clip,
+                     uint32_t x, uint32_t y, uint32_t lineWidth,
+                     pbm_colors color, const pbm_font *font,
+                     const uint8_t *msg, uint32_t length,
+                     const pbm_textStyle *style, uint32_t justifyPixels,
+                     uint32_t justifySpaces) {
+  uint32_t scale = textScale(style);
+  uint32_t pen = 0;
+  uint8_t fillGaps = (NULL != style && 0 != (style->emphasis &
+                                             (PBM_TEXT_UNDERLINE |
+                                              PBM_TEXT_STRIKE)));
+  if (NULL == font->metrics && NULL == font->kerning &&
+      NULL == font->glyphMap && 0 == justifyPixels) {
+    // Fixed width font
+    for (uint32_t i = 0; i < length; i++) {
+      drawGlyph(imageHandler, clip, x, y, pen, lineWidth, color, font, msg[i],
+                style);
+      pen += (font->width + CHARACTER_GAP) * scale;
+      if (fillGaps && i + 1 < length) {
+        drawEmphasisGap(imageHandler, clip, x + pen - CHARACTER_GAP * scale, y,
+                        CHARACTER_GAP * scale, color, font, style);
+      }
+    }
+    return;
   }
 
-  return PBM_OK;
+  const uint8_t *end = msg + length;
+  uint32_t space = 0;
+  if (msg >= end) {
+    return;
+  }
+  uint8_t isSpace = (' ' == *msg);
+  uint32_t glyph = nextGlyph(font, &msg, end);
+  while (1) {
+    drawGlyph(imageHandler, clip, x, y, pen, lineWidth, color, font, glyph,
+              style);
+    uint32_t glyphEnd = pen + glyphColumns(font, glyph) * scale;
+    pen += (glyphColumns(font, glyph) + CHARACTER_GAP) * scale;
+    if (isSpace && 0 != justifySpaces) {
+      pen += justifyPixels / justifySpaces +
+           ((space < justifyPixels % justifySpaces) ? 1 : 0);
+      space++;
+    }
+    if (msg >= end) {
+      break;
+    }
+    uint32_t previousGlyph = glyph;
+    isSpace = (' ' == *msg);
+    glyph = nextGlyph(font, &msg, end);
+    pen += kerningOffset(font, previousGlyph, glyph) * (int32_t)scale;
+    if (fillGaps && (int32_t)(pen - glyphEnd) > 0) {
+      drawEmphasisGap(imageHandler, clip, x + glyphEnd, y, pen - glyphEnd,
+                      color, font, style);
+    }
+  }
 }
 
-// Byte offsets calculations
-uint32_t byteOffset_horizontalMSB(uint32_t index, const pbm_font *font) {
-  return (font->width - 1 - index) / IMAGE_BUFFER_BIT_SIZE;
-}
-uint32_t byteOffset_horizontalLSB(uint32_t index, const pbm_font *font) {
-  return (
-      (index + IMAGE_BUFFER_BIT_SIZE - (font->width % IMAGE_BUFFER_BIT_SIZE)) /
-      IMAGE_BUFFER_BIT_SIZE);
+static void drawPackedGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, pbm_colors color,
+                            const pbm_font *font, uint32_t glyph,
+                            uint32_t firstColumn, uint32_t lastColumn,
+                            uint8_t transparent) {
+  const pbm_glyphBox *box = &font->glyphBoxes[glyph];
+  uint8_t empty = (box->xMin > box->xMax);
+  const uint8_t *data = &font->fontData[font->glyphOffsets[glyph]];
+  uint32_t boxWidth = empty ? 0 : box->xMax - box->xMin + 1;
+  // Visible columns of the ink box
+  uint32_t inkFirst = (box->xMin > firstColumn) ? box->xMin : firstColumn;
+  uint32_t inkLast = (box->xMax < lastColumn) ? box->xMax : lastColumn;
+  uint32_t bit = 0;
+  uint32_t rowBit = 0;
+
+  if (transparent && (empty || inkFirst > inkLast)) {
+    return;
+  }
+  for (uint32_t line = transparent ? box->yMin : 0; line < font->height;
+       line++) {
+    if (empty || line < box->yMin || line > box->yMax) {
+      if (transparent) {
+        break;
+      }
+      blitRow(imageHandler, clip, x + firstColumn, y + line, emptyFontRow, 0,
+              lastColumn - firstColumn + 1, color, transparent);
+      continue;
+    }
+    // Read the line record, a repeated line keeps the previous data
+    if (readBits(data, bit, 1)) {
+      rowBit = bit + 1;
+      bit += boxWidth;
+    }
+    bit++;
+
+    if (!transparent) {
+      // Background left and right of the ink box
+      if (firstColumn < box->xMin) {
+        uint32_t last = (uint32_t)box->xMin - 1;
+        last = (last < lastColumn) ? last : lastColumn;
+        blitRow(imageHandler, clip, x + firstColumn, y + line, emptyFontRow, 0,
+                last - firstColumn + 1, color, transparent);
+      }
+      if (lastColumn > box->xMax) {
+        uint32_t first = (uint32_t)box->xMax + 1;
+        first = (first > firstColumn) ? first : firstColumn;
+        blitRow(imageHandler, clip, x + first, y + line, emptyFontRow, 0,
+                lastColumn - first + 1, color, transparent);
+      }
+    }
+    if (inkFirst <= inkLast) {
+      blitRow(imageHandler, clip, x + inkFirst, y + line, data,
+              rowBit + inkFirst - box->xMin, inkLast - inkFirst + 1, color,
+              transparent);
+    }
+  }
 }
 
-// Bit offset calculations
-uint32_t bitOffset_horizontalMSB(uint32_t index, const pbm_font *font) {
-  return (0x1 << (font->width - 1 - index) % IMAGE_BUFFER_BIT_SIZE);
+static void drawScaledGlyph(pbm_image *imageHandler, const pbm_rect *clip,
+                            uint32_t x, uint32_t y, pbm_colors color,
+                            const pbm_font *font, uint32_t glyph,
+                            uint32_t firstColumn, uint32_t lastColumn,
+                            uint32_t firstLine, uint32_t lastLine,
+                            const pbm_textStyle *style) {
+  uint32_t scale = textScale(style);
+  uint8_t transparent = (PBM_TEXT_TRANSPARENT == style->mode);
+  // Smoothing doubles the lines first, the rest is replicated. Smoothing
+  // never leaves the ink box of a glyph.
+  uint8_t smooth = (0 != style->smooth && 0 == scale % 2);
+  uint32_t factor = smooth ? scale / 2 : scale;
+  uint32_t subLines = smooth ? 2 : 1;
+
+  uint8_t lines[3][FONT_ROW_BUFFER_SIZE];
+  uint8_t *previous = lines[0];
+  uint8_t *current = lines[1];
+  uint8_t *next = lines[2];
+  uint8_t smoothed[2][2 * FONT_ROW_BUFFER_SIZE];
+  uint8_t scaled[SCALED_ROW_BUFFER_SIZE];
+  uint32_t rowBytes =
+      (font->width + IMAGE_BUFFER_BIT_SIZE - 1) / IMAGE_BUFFER_BIT_SIZE;
+  uint32_t srcBit = firstColumn * scale;
+  uint32_t count = (lastColumn - firstColumn + 1) * scale;
+  fontRowCursor cursor = {0, 0, 0};
+
+  if (smooth) {
+    memset(previous, 0, rowBytes);
+    if (firstLine > 0) {
+      decodeStyledRow(font, glyph, firstLine - 1, style, &cursor, previous);
+    }
+    decodeStyledRow(font, glyph, firstLine, style, &cursor, current);
+  }
+  for (uint32_t line = firstLine; line <= lastLine; line++) {
+    const uint8_t *subLine[2] = {current, NULL};
+    if (smooth) {
+      memset(next, 0, rowBytes);
+      if (line + 1 < font->height) {
+        decodeStyledRow(font, glyph, line + 1, style, &cursor, next);
+      }
+      smoothRow(previous, current, next, font->width, smoothed[0],
+                smoothed[1]);
+      subLine[0] = smoothed[0];
+      subLine[1] = smoothed[1];
+      uint8_t *oldest = previous;
+      previous = current;
+      current = next;
+      next = oldest;
+    } else {
+      decodeStyledRow(font, glyph, line, style, &cursor, current);
+    }
+    for (uint32_t i = 0; i < subLines; i++) {
+      scaleRow(subLine[i], font->width * subLines, factor, scaled);
+      // Replicate the scaled line with span writes
+      for (uint32_t j = 0; j < factor; j++) {
+        blitRow(imageHandler, clip, x + srcBit,
+                y + line * scale + i * factor + j, scaled, srcBit, count,
+                color, transparent);
+      }
+    }
+  }
 }
-uint32_t bitOffset_horizontalLSB(uint32_t index, const pbm_font *font) {
-  return (0x1 << (index + IMAGE_BUFFER_BIT_SIZE -
-                  (font->width % IMAGE_BUFFER_BIT_SIZE)) %
-                     IMAGE_BUFFER_BIT_SIZE);
-}
\ No newline at end of file
@@ -0,0 +1,1952 @@
+/**
+ * @file pbm_io.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Decode and encode PBM images, convert PGM and PPM images, index
+ * files with several images
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// read and write of file descriptors, fdopen and fseeko
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include "pbm_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define HEADER_BUFFER_SIZE (32) ///< Maximum length of a written header
+#define PLAIN_LINE_PIXELS (64)  ///< Pixels per written P1 line, at most 70
+#define PLAIN_BUFFER_SIZE (4096) ///< Bytes of the P1 text buffers
+#define BYTE_VALUES (256)        ///< Number of different byte values
+#define PROBE_BUFFER_SIZE (256) ///< Bytes read at once for a header
+#define INDEX_MAGIC "PBMINDEX"   ///< Start of an index file, 8 bytes
+#define INDEX_FIELD_SIZE (8)     ///< Bytes of an index file field
+#define INDEX_CAPACITY (64)      ///< First number of offsets of a scan
+
+/**
+ * @brief Fields of the header
+ *
+ */
+enum {
+  HEADER_MAGIC = 0, ///< Waiting for the P
+  HEADER_TYPE,      ///< Waiting for the format digit
+  HEADER_WIDTH,     ///< Reading the width
+  HEADER_HEIGHT,    ///< Reading the height
+  HEADER_MAXVAL,    ///< Reading the maximum sample value of PGM and PPM
+  HEADER_DONE       ///< The raster follows
+};
+
+/**
+ * @brief State of the header tokenizer
+ *
+ */
+typedef struct {
+  uint8_t state;     ///< Current header field
+  uint8_t comment;   ///< Inside of a comment
+  uint8_t separated; ///< Whitespace since the last token
+  uint8_t digits;    ///< Number of digits of the current number
+  pbm_format format; ///< Format of the magic number
+  uint64_t value;    ///< Value of the current number
+  uint32_t width;    ///< Parsed width
+  uint32_t height;   ///< Parsed height
+  uint32_t maxval;   ///< Parsed maximum sample value, 1 for bitmaps
+} pbmHeader;
+
+/**
+ * @brief Source of an image to decode
+ *
+ * A memory buffer if memory is set, otherwise a stream if file is set,
+ * otherwise a file descriptor.
+ */
+typedef struct {
+  const uint8_t *memory; ///< Encoded buffer
+  size_t size;           ///< Size of the buffer
+  size_t position;       ///< Read bytes of the buffer
+  FILE *file;            ///< Encoded stream
+  int fd;                ///< Encoded file descriptor
+} inputSource;
+
+/**
+ * @brief Destination of an encoded image
+ *
+ * A memory buffer if memory is set, otherwise a stream if file is set,
+ * otherwise a file descriptor.
+ */
+typedef struct {
+  uint8_t *memory; ///< Next byte of the destination buffer
+  FILE *file;      ///< Destination stream
+  int fd;          ///< Destination file descriptor
+} outputSink;
+
+/**
+ * @brief State of the P1 raster parser
+ *
+ */
+typedef struct {
+  uint8_t *data;   ///< Cleared image data in PBM_DATA_HORIZONTAL_MSB
+  size_t stride;   ///< Bytes per image line
+  uint32_t width;  ///< Width of the image
+  uint32_t height; ///< Height of the image
+  uint32_t x;      ///< Position of the next pixel
+  uint32_t y;      ///< Line of the next pixel
+} plainRaster;
+
+/**
+ * @brief State of the grayscale and color raster conversion
+ *
+ * Only one source row and its brightness are kept, the converted pixels are
+ * written directly into the bitmap.
+ */
+typedef struct {
+  const pbm_conversion *conversion; ///< Conversion to the bitmap
+  uint8_t *data;        ///< Cleared image data in PBM_DATA_HORIZONTAL_MSB
+  size_t stride;        ///< Bytes per image line
+  uint32_t width;       ///< Width of the image
+  uint32_t height;      ///< Height of the image
+  uint32_t channels;    ///< Samples per pixel, 1 or 3
+  uint32_t sampleBytes; ///< Bytes per sample, 1 or 2
+  uint32_t maxval;      ///< Maximum sample value
+  uint8_t *raw;         ///< One source row in the binary sample layout
+  size_t rawBytes;      ///< Bytes of a source row
+  size_t filled;        ///< Bytes of the current row of a plain raster
+  uint8_t *luma;        ///< Brightness of the current row
+  uint32_t y;           ///< Next row
+  uint32_t value;       ///< Current sample of a plain raster
+  uint8_t digits;       ///< Digits of the current sample
+} sampleRaster;
+
+/**
+ * @brief State of a skipped plain raster
+ *
+ */
+typedef struct {
+  uint64_t missing; ///< Samples up to the end of the raster
+  uint8_t bitmap;   ///< P1 raster, every digit is a sample
+  uint8_t number;   ///< Inside of a sample
+} plainSkip;
+
+#define BYTE_TABLE_4(entry, value)                                             \
+  entry(value), entry((value) + 1), entry((value) + 2),                        \
+      entry((value) + 3) ///< Entries of 4 byte values
+#define BYTE_TABLE_16(entry, value)                                            \
+  BYTE_TABLE_4(entry, value), BYTE_TABLE_4(entry, (value) + 4),                \
+      BYTE_TABLE_4(entry, (value) + 8),                                        \
+      BYTE_TABLE_4(entry, (value) + 12) ///< Entries of 16 byte values
+#define BYTE_TABLE_64(entry, value)                                            \
+  BYTE_TABLE_16(entry, value), BYTE_TABLE_16(entry, (value) + 16),             \
+      BYTE_TABLE_16(entry, (value) + 32),                                      \
+      BYTE_TABLE_16(entry, (value) + 48) ///< Entries of 64 byte values
+#define BYTE_TABLE(entry)                                                      \
+  {BYTE_TABLE_64(entry, 0), BYTE_TABLE_64(entry, 64),                          \
+   BYTE_TABLE_64(entry, 128),                                                  \
+   BYTE_TABLE_64(entry, 192)} ///< Entries of all byte values
+#define PLAIN_DIGIT(value, bit)                                                \
+  (char)('0' + (((value) >> (7 - (bit))) & 1)) ///< Pixel text of a bit
+#define PLAIN_TEXT(value)                                                      \
+  {PLAIN_DIGIT(value, 0), PLAIN_DIGIT(value, 1), PLAIN_DIGIT(value, 2),        \
+   PLAIN_DIGIT(value, 3), PLAIN_DIGIT(value, 4), PLAIN_DIGIT(value, 5),        \
+   PLAIN_DIGIT(value, 6), PLAIN_DIGIT(value, 7)} ///< Pixel text of a byte
+#define REVERSED_BYTE(value)                                                   \
+  (uint8_t)(((value) & 0x01) << 7 | ((value) & 0x02) << 5 |                    \
+            ((value) & 0x04) << 3 | ((value) & 0x08) << 1 |                    \
+            ((value) & 0x10) >> 1 | ((value) & 0x20) >> 3 |                    \
+            ((value) & 0x40) >> 5 | ((value) & 0x80) >> 7) ///< Reversed byte
+
+/**
+ * @brief Pixel text of every data byte, MSB first
+ *
+ */
+static const char plainText[BYTE_VALUES][8] = BYTE_TABLE(PLAIN_TEXT);
+
+/**
+ * @brief Bit reversed bytes, to pack LSB first masks into MSB first data
+ *
+ */
+static const uint8_t reversedBytes[BYTE_VALUES] = BYTE_TABLE(REVERSED_BYTE);
+
+/**
+ * @brief Ordered dither matrix, black below index * 4 + 2
+ *
+ */
+static const uint8_t ditherMatrix[8][8] = {
+    {0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44, 4, 36, 14, 46, 6, 38}, {60, 28, 52, 20, 62, 30, 54, 22},
+    {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47, 7, 39, 13, 45, 5, 37}, {63, 31, 55, 23, 61, 29, 53, 21}};
+
+/**
+ * @brief Conversion of the decoders without options
+ *
+ */
+static const pbm_conversion defaultConversion = {PBM_CONVERT_THRESHOLD, 128};
+
+/**
+ * @brief Formats of the magic numbers P1 to P6
+ *
+ */
+static const pbm_format headerFormats[] = {
+    PBM_FORMAT_PLAIN,      PBM_FORMAT_GRAY_PLAIN, PBM_FORMAT_COLOR_PLAIN,
+    PBM_FORMAT_BINARY,     PBM_FORMAT_GRAY,       PBM_FORMAT_COLOR};
+
+/**
+ * @brief Feed the next byte to the header tokenizer
+ *
+ * The header is complete when the state is HEADER_DONE, the single whitespace
+ * after the height is consumed.
+ *
+ * @param header the tokenizer state, zero initialized at the start
+ * @param byte the next byte of the header
+ * @return pbm_return state, PBM_ERROR for an invalid header, PBM_SIZE for a
+ * too big number
+ */
+static pbm_return parseHeader(pbmHeader *header, uint8_t byte);
+
+/**
+ * @brief Field of the header after the current number
+ *
+ * @param header the tokenizer state
+ * @return uint8_t the next header state
+ */
+static uint8_t nextField(const pbmHeader *header);
+
+/**
+ * @brief Store the current number in its header field
+ *
+ * @param header the tokenizer state
+ * @return pbm_return state, PBM_ERROR for an invalid maximum value
+ */
+static pbm_return finishNumber(pbmHeader *header);
+
+/**
+ * @brief Check for a whitespace of the netpbm formats
+ *
+ * @param byte the byte to check
+ * @return uint8_t 1 for a whitespace, 0 otherwise
+ */
+static uint8_t isSpace(uint8_t byte);
+
+/**
+ * @brief Read exactly the requested bytes from a source
+ *
+ * @param source the source to read
+ * @param buffer the destination
+ * @param size the number of bytes
+ * @return pbm_return state, PBM_ERROR on an error or the end of the source
+ */
+static pbm_return sourceRead(inputSource *source, uint8_t *buffer,
+                             size_t size);
+
+/**
+ * @brief Feed the bytes of a buffer to the header tokenizer
+ *
+ * The parsing stops at the end of the header or the buffer.
+ *
+ * @param header the tokenizer state
+ * @param data the bytes of the header
+ * @param length the number of bytes
+ * @param consumed the number of parsed bytes
+ * @return pbm_return state
+ */
+static pbm_return probeHeader(pbmHeader *header, const uint8_t *data,
+                              size_t length, size_t *consumed);
+
+/**
+ * @brief Fill the header information of a complete header
+ *
+ * @param header the parsed header
+ * @param offset the offset of the raster
+ * @param total the size of the file or buffer
+ * @param info the header information, only changed on success
+ * @return pbm_return state, PBM_ERROR if the payload does not fit
+ */
+static pbm_return probeInfo(const pbmHeader *header, uint64_t offset,
+                            uint64_t total, pbm_imageInfo *info);
+
+/**
+ * @brief Read the header of an image from a source
+ *
+ * @param source the source positioned at the header
+ * @param header the parsed header, zero initialized
+ * @return pbm_return state
+ */
+static pbm_return readHeader(inputSource *source, pbmHeader *header);
+
+/**
+ * @brief Skip the whitespace before the next image of a stream source
+ *
+ * @param source a memory source or a stream
+ * @param offset optional, the offset of the next image
+ * @return pbm_return state, PBM_OUT_OF_RANGE at the end of the source
+ */
+static pbm_return skipSpace(inputSource *source, uint64_t *offset);
+
+/**
+ * @brief Skip the raster of an image without decoding it
+ *
+ * @param source the source positioned at the raster
+ * @param header the parsed header
+ * @return pbm_return state, PBM_ERROR for a truncated raster
+ */
+static pbm_return skipRaster(inputSource *source, const pbmHeader *header);
+
+/**
+ * @brief Compute the payload of an image
+ *
+ * @param header the parsed header
+ * @param samples the number of samples of the raster
+ * @param size the bytes of a binary raster, the minimum bytes of a plain
+ * raster
+ * @return pbm_return state, PBM_SIZE for an empty or too big image
+ */
+static pbm_return payloadSize(const pbmHeader *header, uint64_t *samples,
+                              uint64_t *size);
+
+/**
+ * @brief Count the samples of plain raster text
+ *
+ * @param skip the skip state
+ * @param text the raster text
+ * @param length the number of bytes of the text
+ * @param consumed the number of counted bytes
+ * @return pbm_return state, PBM_ERROR for an invalid character
+ */
+static pbm_return countSamples(plainSkip *skip, const uint8_t *text,
+                               size_t length, size_t *consumed);
+
+/**
+ * @brief Decode the next image of a stream
+ *
+ * @param stream the stream to read
+ * @param imageHandler the decoded image, only changed on success
+ * @param mode copy the data or alias the mapping
+ * @param conversion conversion of grayscale and color images, NULL to accept
+ * only bitmaps
+ * @return pbm_return state
+ */
+static pbm_return readStream(pbm_stream *stream, pbm_image *imageHandler,
+                             pbm_decodeMode mode,
+                             const pbm_conversion *conversion);
+
+/**
+ * @brief Store a little endian 64 bit value
+ *
+ * @param value the value
+ * @param data the destination of INDEX_FIELD_SIZE bytes
+ */
+static void storeLittleEndian(uint64_t value, uint8_t *data);
+
+/**
+ * @brief Read a little endian 64 bit value
+ *
+ * @param data the INDEX_FIELD_SIZE bytes
+ * @return uint64_t the value
+ */
+static uint64_t readLittleEndian(const uint8_t *data);
+
+/**
+ * @brief Decode an image from a source
+ *
+ * @param source the source positioned at the header
+ * @param imageHandler the decoded image, only changed on success
+ * @param mode copy the data or, for P4 in memory, alias the buffer
+ * @param conversion conversion of grayscale and color images, NULL to accept
+ * only bitmaps
+ * @return pbm_return state
+ */
+static pbm_return decodeImage(inputSource *source, pbm_image *imageHandler,
+                              pbm_decodeMode mode,
+                              const pbm_conversion *conversion);
+
+/**
+ * @brief Decode a P1 raster into the bitmap
+ *
+ * @param source the source positioned at the raster
+ * @param header the parsed header
+ * @param data the cleared image data
+ * @return pbm_return state
+ */
+static pbm_return decodePlain(inputSource *source, const pbmHeader *header,
+                              uint8_t *data);
+
+/**
+ * @brief Convert a grayscale or color raster row by row into the bitmap
+ *
+ * @param source the source positioned at the raster
+ * @param header the parsed header
+ * @param conversion conversion to the bitmap
+ * @param data the cleared image data
+ * @return pbm_return state
+ */
+static pbm_return decodeSamples(inputSource *source, const pbmHeader *header,
+                                const pbm_conversion *conversion,
+                                uint8_t *data);
+
+/**
+ * @brief Parse plain grayscale or color raster text
+ *
+ * @param raster the raster state
+ * @param text the raster text
+ * @param length the number of bytes of the text
+ * @param consumed the number of parsed bytes
+ * @return pbm_return state, PBM_ERROR for an invalid character or sample
+ */
+static pbm_return parseSamples(sampleRaster *raster, const uint8_t *text,
+                               size_t length, size_t *consumed);
+
+/**
+ * @brief Store the next sample of a plain raster into the source row
+ *
+ * @param raster the raster state
+ * @param value the sample value, at most the maximum value
+ */
+static void storeSample(sampleRaster *raster, uint32_t value);
+
+/**
+ * @brief Convert the source row into the next bitmap line
+ *
+ * @param raster the raster state with a complete source row
+ */
+static void convertRow(sampleRaster *raster);
+
+/**
+ * @brief Compute the BT.601 brightness of a row of 8 bit RGB samples
+ *
+ * @param rgb the interleaved samples
+ * @param width the number of pixels
+ * @param luma the brightness of the pixels
+ */
+static void lumaRow(const uint8_t *rgb, uint32_t width, uint8_t *luma);
+
+/**
+ * @brief Set the bitmap pixels of a line with a brightness below the limit
+ *
+ * @param luma the brightness of the pixels
+ * @param width the number of pixels
+ * @param limits the limits of 16 pixels, repeated over the line
+ * @param row the cleared bitmap line
+ */
+static void thresholdRow(const uint8_t *luma, uint32_t width,
+                         const uint8_t *limits, uint8_t *row);
+
+/**
+ * @brief Parse P1 raster text into the image data
+ *
+ * The parsing stops after the last pixel of the image.
+ *
+ * @param raster the raster state
+ * @param text the raster text
+ * @param length the number of bytes of the text
+ * @param consumed the number of parsed bytes
+ * @return pbm_return state, PBM_ERROR for an invalid character
+ */
+static pbm_return parsePlain(plainRaster *raster, const uint8_t *text,
+                             size_t length, size_t *consumed);
+
+/**
+ * @brief Store the next P1 pixel into the image data
+ *
+ * @param raster the raster state
+ * @param set 1 for a black pixel
+ */
+static void plainPixel(plainRaster *raster, uint8_t set);
+
+/**
+ * @brief Write bytes to a sink
+ *
+ * @param sink the destination
+ * @param data the bytes to write
+ * @param size the number of bytes
+ * @return pbm_return state
+ */
+static pbm_return sinkWrite(outputSink *sink, const void *data, size_t size);
+
+/**
+ * @brief Encode an image into a sink
+ *
+ * @param sink the destination
+ * @param imageHandler the image to encode
+ * @param format the format to write
+ * @return pbm_return state
+ */
+static pbm_return encodeImage(outputSink *sink, const pbm_image *imageHandler,
+                              pbm_format format);
+
+/**
+ * @brief Write the header of an image
+ *
+ * @param imageHandler the image to write
+ * @param format the format to write
+ * @param header the buffer of HEADER_BUFFER_SIZE bytes
+ * @return size_t the length of the header
+ */
+static size_t writeHeader(const pbm_image *imageHandler, pbm_format format,
+                          char *header);
+
+/**
+ * @brief Check an image to encode and compute its encoded size
+ *
+ * @param imageHandler the image to encode
+ * @param format the format to write
+ * @param size the number of encoded bytes, set on success
+ * @return pbm_return state
+ */
+static pbm_return checkEncode(const pbm_image *imageHandler,
+                              pbm_format format, size_t *size);
+
+/**
+ * @brief Read exactly the requested bytes from a file descriptor
+ *
+ * @param fd the file descriptor
+ * @param buffer the destination
+ * @param size the number of bytes
+ * @return pbm_return state, PBM_ERROR on an error or the end of the file
+ */
+static pbm_return readAll(int fd, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Write all bytes to a file descriptor
+ *
+ * @param fd the file descriptor
+ * @param buffer the source
+ * @param size the number of bytes
+ * @return pbm_return state
+ */
+static pbm_return writeAll(int fd, const uint8_t *buffer, size_t size);
+
+/**
+ * @brief Compute the data size of a PBM image in PBM_DATA_HORIZONTAL_MSB
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @param size the number of bytes, set on success
+ * @return pbm_return state, PBM_SIZE if the size is empty or too big
+ */
+static pbm_return rasterSize(uint32_t width, uint32_t height, size_t *size);
+
+pbm_return pbm_loadImage(const char *imagePath, pbm_image *imageHandler) {
+  if (NULL == imagePath || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  FILE *file = fopen(imagePath, "rb");
+  if (file == NULL) {
+    printf("ERROR, could not load %s\n", imagePath);
+    return PBM_ERROR;
+  }
+  pbm_return retVal = pbm_decodeFromFile(file, imageHandler);
+  if (PBM_OK != retVal) {
+    printf("Invalid PBM file %s\n", imagePath);
+  }
+  fclose(file);
+  return retVal;
+}
+
+pbm_return pbm_loadImageConverted(const char *imagePath,
+                                  pbm_image *imageHandler,
+                                  const pbm_conversion *conversion) {
+  if (NULL == imagePath || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  FILE *file = fopen(imagePath, "rb");
+  if (file == NULL) {
+    printf("ERROR, could not load %s\n", imagePath);
+    return PBM_ERROR;
+  }
+  pbm_return retVal =
+      pbm_decodeFromFileConverted(file, imageHandler, conversion);
+  if (PBM_OK != retVal) {
+    printf("Invalid PBM, PGM or PPM file %s\n", imagePath);
+  }
+  fclose(file);
+  return retVal;
+}
+
+pbm_return pbm_probeImage(const char *imagePath, pbm_imageInfo *info) {
+  if (NULL == imagePath || NULL == info) {
+    return PBM_ARGUMENTS;
+  }
+  int file = open(imagePath, O_RDONLY);
+  if (file < 0) {
+    printf("ERROR, could not load %s\n", imagePath);
+    return PBM_ERROR;
+  }
+  // The size of the payload is checked against the file size
+  struct stat status;
+  if (0 != fstat(file, &status) || !S_ISREG(status.st_mode)) {
+    close(file);
+    return PBM_ERROR;
+  }
+  pbmHeader header = {0};
+  uint8_t buffer[PROBE_BUFFER_SIZE];
+  uint64_t offset = 0;
+  pbm_return retVal = PBM_OK;
+  while (PBM_OK == retVal && HEADER_DONE != header.state) {
+    ssize_t count = read(file, buffer, sizeof(buffer));
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count <= 0) {
+      retVal = PBM_ERROR;
+      break;
+    }
+    size_t consumed = 0;
+    retVal = probeHeader(&header, buffer, (size_t)count, &consumed);
+    offset += consumed;
+  }
+  close(file);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  return probeInfo(&header, offset, (uint64_t)status.st_size, info);
+}
+
+pbm_return pbm_probeMemory(const uint8_t *buffer, size_t size,
+                           pbm_imageInfo *info) {
+  if (NULL == buffer || NULL == info) {
+    return PBM_ARGUMENTS;
+  }
+  pbmHeader header = {0};
+  size_t consumed;
+  pbm_return retVal = probeHeader(&header, buffer, size, &consumed);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  if (HEADER_DONE != header.state) {
+    return PBM_ERROR;
+  }
+  return probeInfo(&header, consumed, size, info);
+}
+
+pbm_return pbm_saveImage(const char *imagePath, const pbm_image *imageHandler) {
+  return pbm_saveImageFormat(imagePath, imageHandler, PBM_FORMAT_BINARY);
+}
+
+pbm_return pbm_saveImageFormat(const char *imagePath,
+                               const pbm_image *imageHandler,
+                               pbm_format format) {
+  if (NULL == imagePath || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  size_t size;
+  pbm_return retVal = checkEncode(imageHandler, format, &size);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+
+  FILE *file = fopen(imagePath, "wb");
+  if (file == NULL) {
+    printf("ERROR, could not open %s\n", imagePath);
+    return PBM_ERROR;
+  }
+  retVal = pbm_encodeToFileFormat(file, imageHandler, format);
+  if (0 != fclose(file) && PBM_OK == retVal) {
+    retVal = PBM_ERROR;
+  }
+  if (PBM_OK != retVal) {
+    printf("ERROR, could not write %s\n", imagePath);
+  }
+  return retVal;
+}
+
+pbm_return pbm_decodeFromMemory(const uint8_t *buffer, size_t size,
+                                pbm_image *imageHandler, pbm_decodeMode mode,
+                                size_t *used) {
+  if (NULL == buffer || NULL == imageHandler || mode > PBM_DECODE_ALIAS) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {buffer, size, 0, NULL, -1};
+  pbm_return retVal = decodeImage(&source, imageHandler, mode, NULL);
+  if (PBM_OK == retVal && NULL != used) {
+    *used = source.position;
+  }
+  return retVal;
+}
+
+pbm_return pbm_decodeFromMemoryConverted(const uint8_t *buffer, size_t size,
+                                         pbm_image *imageHandler,
+                                         const pbm_conversion *conversion,
+                                         size_t *used) {
+  if (NULL == buffer || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {buffer, size, 0, NULL, -1};
+  pbm_return retVal = decodeImage(
+      &source, imageHandler, PBM_DECODE_COPY,
+      (NULL != conversion) ? conversion : &defaultConversion);
+  if (PBM_OK == retVal && NULL != used) {
+    *used = source.position;
+  }
+  return retVal;
+}
+
+pbm_return pbm_encodeToMemory(const pbm_image *imageHandler, uint8_t *buffer,
+                              size_t *size) {
+  return pbm_encodeToMemoryFormat(imageHandler, PBM_FORMAT_BINARY, buffer,
+                                  size);
+}
+
+pbm_return pbm_encodeToMemoryFormat(const pbm_image *imageHandler,
+                                    pbm_format format, uint8_t *buffer,
+                                    size_t *size) {
+  if (NULL == imageHandler || NULL == size) {
+    return PBM_ARGUMENTS;
+  }
+  size_t required;
+  pbm_return retVal = checkEncode(imageHandler, format, &required);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  if (NULL == buffer || *size < required) {
+    *size = required;
+    return PBM_SIZE;
+  }
+  outputSink sink = {buffer, NULL, -1};
+  retVal = encodeImage(&sink, imageHandler, format);
+  *size = required;
+  return retVal;
+}
+
+pbm_return pbm_decodeFromFile(FILE *file, pbm_image *imageHandler) {
+  if (NULL == file || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {NULL, 0, 0, file, -1};
+  return decodeImage(&source, imageHandler, PBM_DECODE_COPY, NULL);
+}
+
+pbm_return pbm_decodeFromFileConverted(FILE *file, pbm_image *imageHandler,
+                                       const pbm_conversion *conversion) {
+  if (NULL == file || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {NULL, 0, 0, file, -1};
+  return decodeImage(&source, imageHandler, PBM_DECODE_COPY,
+                     (NULL != conversion) ? conversion : &defaultConversion);
+}
+
+pbm_return pbm_encodeToFile(FILE *file, const pbm_image *imageHandler) {
+  return pbm_encodeToFileFormat(file, imageHandler, PBM_FORMAT_BINARY);
+}
+
+pbm_return pbm_encodeToFileFormat(FILE *file, const pbm_image *imageHandler,
+                                  pbm_format format) {
+  if (NULL == file || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  size_t size;
+  pbm_return retVal = checkEncode(imageHandler, format, &size);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  outputSink sink = {NULL, file, -1};
+  return encodeImage(&sink, imageHandler, format);
+}
+
+pbm_return pbm_decodeFromFd(int fd, pbm_image *imageHandler) {
+  if (fd < 0 || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {NULL, 0, 0, NULL, fd};
+  return decodeImage(&source, imageHandler, PBM_DECODE_COPY, NULL);
+}
+
+pbm_return pbm_decodeFromFdConverted(int fd, pbm_image *imageHandler,
+                                     const pbm_conversion *conversion) {
+  if (fd < 0 || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  inputSource source = {NULL, 0, 0, NULL, fd};
+  return decodeImage(&source, imageHandler, PBM_DECODE_COPY,
+                     (NULL != conversion) ? conversion : &defaultConversion);
+}
+
+pbm_return pbm_encodeToFd(int fd, const pbm_image *imageHandler) {
+  return pbm_encodeToFdFormat(fd, imageHandler, PBM_FORMAT_BINARY);
+}
+
+pbm_return pbm_encodeToFdFormat(int fd, const pbm_image *imageHandler,
+                                pbm_format format) {
+  if (fd < 0 || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  size_t size;
+  pbm_return retVal = checkEncode(imageHandler, format, &size);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  outputSink sink = {NULL, NULL, fd};
+  return encodeImage(&sink, imageHandler, format);
+}
+
+pbm_return pbm_openStream(const char *streamPath, pbm_stream *stream) {
+  if (NULL == streamPath || NULL == stream) {
+    return PBM_ARGUMENTS;
+  }
+  memset(stream, 0, sizeof(*stream));
+  int file = open(streamPath, O_RDONLY);
+  if (file < 0) {
+    printf("ERROR, could not load %s\n", streamPath);
+    return PBM_ERROR;
+  }
+  struct stat status;
+  if (0 == fstat(file, &status) && S_ISREG(status.st_mode)) {
+    if ((uint64_t)status.st_size > SIZE_MAX) {
+      close(file);
+      return PBM_SIZE;
+    }
+    stream->size = (size_t)status.st_size;
+    if (0 == stream->size) {
+      // An empty file has no images
+      close(file);
+      return PBM_OK;
+    }
+    // Aliased images may be changed, the pages are copied on write
+    void *mapping = mmap(NULL, stream->size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, file, 0);
+    if (MAP_FAILED != mapping) {
+      close(file);
+      stream->mapping = (uint8_t *)mapping;
+      return PBM_OK;
+    }
+  }
+  stream->file = fdopen(file, "rb");
+  if (NULL == stream->file) {
+    close(file);
+    return PBM_ERROR;
+  }
+  return PBM_OK;
+}
+
+void pbm_closeStream(pbm_stream *stream) {
+  if (NULL == stream) {
+    return;
+  }
+  if (NULL != stream->mapping) {
+    munmap(stream->mapping, stream->size);
+  }
+  if (NULL != stream->file) {
+    fclose(stream->file);
+  }
+  free(stream->offsets);
+  memset(stream, 0, sizeof(*stream));
+}
+
+pbm_return pbm_readStream(pbm_stream *stream, pbm_image *imageHandler,
+                          pbm_decodeMode mode) {
+  if (NULL == stream || NULL == imageHandler || mode > PBM_DECODE_ALIAS) {
+    return PBM_ARGUMENTS;
+  }
+  return readStream(stream, imageHandler, mode, NULL);
+}
+
+pbm_return pbm_readStreamConverted(pbm_stream *stream, pbm_image *imageHandler,
+                                   const pbm_conversion *conversion) {
+  if (NULL == stream || NULL == imageHandler) {
+    return PBM_ARGUMENTS;
+  }
+  return readStream(stream, imageHandler, PBM_DECODE_COPY,
+                    (NULL != conversion) ? conversion : &defaultConversion);
+}
+
+pbm_return pbm_indexStream(pbm_stream *stream) {
+  if (NULL == stream) {
+    return PBM_ARGUMENTS;
+  }
+  off_t start = 0;
+  if (NULL != stream->file) {
+    start = ftello(stream->file);
+    if (start < 0 || 0 != fseeko(stream->file, 0, SEEK_SET)) {
+      return PBM_ERROR;
+    }
+  }
+  size_t capacity = INDEX_CAPACITY;
+  uint64_t *offsets = (uint64_t *)malloc(capacity * sizeof(*offsets));
+  if (NULL == offsets) {
+    return PBM_ERROR;
+  }
+  size_t count = 0;
+  inputSource source = {stream->mapping, stream->size, 0, stream->file, -1};
+  uint64_t offset;
+  pbm_return retVal;
+  while (PBM_OK == (retVal = skipSpace(&source, &offset))) {
+    if (count == capacity) {
+      uint64_t *grown =
+          (uint64_t *)realloc(offsets, 2 * capacity * sizeof(*offsets));
+      if (NULL == grown) {
+        retVal = PBM_ERROR;
+        break;
+      }
+      offsets = grown;
+      capacity *= 2;
+    }
+    offsets[count++] = offset;
+    pbmHeader header = {0};
+    retVal = readHeader(&source, &header);
+    if (PBM_OK == retVal) {
+      retVal = skipRaster(&source, &header);
+    }
+    if (PBM_OK != retVal) {
+      break;
+    }
+  }
+  if (PBM_OUT_OF_RANGE == retVal) {
+    // Only whitespace after the last image
+    retVal = PBM_OK;
+  }
+  if (NULL != stream->file && 0 != fseeko(stream->file, start, SEEK_SET)) {
+    retVal = PBM_ERROR;
+  }
+  if (PBM_OK != retVal) {
+    free(offsets);
+    return retVal;
+  }
+  free(stream->offsets);
+  stream->offsets = offsets;
+  stream->count = count;
+  return PBM_OK;
+}
+
+pbm_return pbm_seekStream(pbm_stream *stream, size_t index) {
+  if (NULL == stream) {
+    return PBM_ARGUMENTS;
+  }
+  if (NULL == stream->offsets) {
+    pbm_return retVal = pbm_indexStream(stream);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+  }
+  if (index >= stream->count) {
+    return PBM_OUT_OF_RANGE;
+  }
+  if (NULL != stream->file) {
+    if (0 != fseeko(stream->file, (off_t)stream->offsets[index], SEEK_SET)) {
+      return PBM_ERROR;
+    }
+  } else {
+    stream->position = (size_t)stream->offsets[index];
+  }
+  stream->next = index;
+  return PBM_OK;
+}
+
+pbm_return pbm_streamCount(pbm_stream *stream, size_t *count) {
+  if (NULL == stream || NULL == count) {
+    return PBM_ARGUMENTS;
+  }
+  if (NULL == stream->offsets) {
+    pbm_return retVal = pbm_indexStream(stream);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+  }
+  *count = stream->count;
+  return PBM_OK;
+}
+
+pbm_return pbm_saveStreamIndex(pbm_stream *stream, const char *indexPath) {
+  if (NULL == stream || NULL == indexPath) {
+    return PBM_ARGUMENTS;
+  }
+  if (NULL == stream->offsets) {
+    pbm_return retVal = pbm_indexStream(stream);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+  }
+  FILE *file = fopen(indexPath, "wb");
+  if (file == NULL) {
+    printf("ERROR, could not open %s\n", indexPath);
+    return PBM_ERROR;
+  }
+  uint8_t field[INDEX_FIELD_SIZE];
+  uint8_t written = (1 == fwrite(INDEX_MAGIC, INDEX_FIELD_SIZE, 1, file));
+  storeLittleEndian(stream->size, field);
+  written = written && 1 == fwrite(field, sizeof(field), 1, file);
+  storeLittleEndian(stream->count, field);
+  written = written && 1 == fwrite(field, sizeof(field), 1, file);
+  for (size_t i = 0; written && i < stream->count; i++) {
+    storeLittleEndian(stream->offsets[i], field);
+    written = (1 == fwrite(field, sizeof(field), 1, file));
+  }
+  if (0 != fclose(file) || !written) {
+    printf("ERROR, could not write %s\n", indexPath);
+    return PBM_ERROR;
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_loadStreamIndex(pbm_stream *stream, const char *indexPath) {
+  if (NULL == stream || NULL == indexPath) {
+    return PBM_ARGUMENTS;
+  }
+  FILE *file = fopen(indexPath, "rb");
+  if (file == NULL) {
+    printf("ERROR, could not load %s\n", indexPath);
+    return PBM_ERROR;
+  }
+  uint8_t field[3 * INDEX_FIELD_SIZE];
+  if (1 != fread(field, sizeof(field), 1, file) ||
+      0 != memcmp(field, INDEX_MAGIC, INDEX_FIELD_SIZE) ||
+      readLittleEndian(&field[INDEX_FIELD_SIZE]) != stream->size) {
+    fclose(file);
+    return PBM_ERROR;
+  }
+  // Every image has at least a header of 7 bytes
+  uint64_t count = readLittleEndian(&field[2 * INDEX_FIELD_SIZE]);
+  if (count > stream->size / 7) {
+    fclose(file);
+    return PBM_ERROR;
+  }
+  uint64_t *offsets = (uint64_t *)malloc(
+      ((0 != count) ? (size_t)count : 1) * sizeof(*offsets));
+  if (NULL == offsets) {
+    fclose(file);
+    return PBM_ERROR;
+  }
+  pbm_return retVal = PBM_OK;
+  for (uint64_t i = 0; PBM_OK == retVal && i < count; i++) {
+    if (1 != fread(field, INDEX_FIELD_SIZE, 1, file)) {
+      retVal = PBM_ERROR;
+      break;
+    }
+    offsets[i] = readLittleEndian(field);
+    // The offsets increase and start inside of the file
+    if (offsets[i] >= stream->size ||
+        (0 != i && offsets[i] <= offsets[i - 1])) {
+      retVal = PBM_ERROR;
+    }
+  }
+  if (EOF != fgetc(file)) {
+    retVal = PBM_ERROR;
+  }
+  fclose(file);
+  if (PBM_OK != retVal) {
+    free(offsets);
+    return retVal;
+  }
+  free(stream->offsets);
+  stream->offsets = offsets;
+  stream->count = (size_t)count;
+  return PBM_OK;
+}
+
+static pbm_return parseHeader(pbmHeader *header, uint8_t byte) {
+  if (header->comment) {
+    if ('\n' != byte && '\r' != byte) {
+      return PBM_OK;
+    }
+    header->comment = 0;
+    header->separated = 1;
+    if (0 != header->digits) {
+      // The end of the comment is the whitespace before the raster
+      return finishNumber(header);
+    }
+    return PBM_OK;
+  }
+  uint8_t space = isSpace(byte);
+  switch (header->state) {
+  case HEADER_MAGIC:
+    // Whitespace between concatenated images is skipped
+    if (space) {
+      return PBM_OK;
+    }
+    if ('P' != byte) {
+      return PBM_ERROR;
+    }
+    header->state = HEADER_TYPE;
+    return PBM_OK;
+  case HEADER_TYPE:
+    if (byte < '1' || byte > '6') {
+      return PBM_ERROR;
+    }
+    header->format = headerFormats[byte - '1'];
+    header->maxval = 1;
+    header->state = HEADER_WIDTH;
+    return PBM_OK;
+  case HEADER_WIDTH:
+  case HEADER_HEIGHT:
+  case HEADER_MAXVAL:
+    if (byte >= '0' && byte <= '9') {
+      if (!header->separated) {
+        return PBM_ERROR;
+      }
+      header->value = header->value * 10 + (byte - '0');
+      header->digits++;
+      return (header->value > UINT32_MAX) ? PBM_SIZE : PBM_OK;
+    }
+    if (!space && '#' != byte) {
+      return PBM_ERROR;
+    }
+    header->comment = ('#' == byte);
+    if (0 == header->digits) {
+      header->separated = 1;
+      return PBM_OK;
+    }
+    // A comment directly after the last number ends with the whitespace
+    if (header->comment && HEADER_DONE == nextField(header)) {
+      return PBM_OK;
+    }
+    header->separated = space;
+    return finishNumber(header);
+  default:
+    return PBM_ERROR;
+  }
+}
+
+static uint8_t nextField(const pbmHeader *header) {
+  if (HEADER_WIDTH == header->state) {
+    return HEADER_HEIGHT;
+  }
+  if (HEADER_HEIGHT == header->state && header->format >= PBM_FORMAT_GRAY) {
+    return HEADER_MAXVAL;
+  }
+  return HEADER_DONE;
+}
+
+static pbm_return finishNumber(pbmHeader *header) {
+  switch (header->state) {
+  case HEADER_WIDTH:
+    header->width = (uint32_t)header->value;
+    break;
+  case HEADER_HEIGHT:
+    header->height = (uint32_t)header->value;
+    break;
+  default:
+    if (0 == header->value || header->value > UINT16_MAX) {
+      return PBM_ERROR;
+    }
+    header->maxval = (uint32_t)header->value;
+    break;
+  }
+  header->state = nextField(header);
+  header->value = 0;
+  header->digits = 0;
+  return PBM_OK;
+}
+
+static uint8_t isSpace(uint8_t byte) {
+  return (' ' == byte || '\t' == byte || '\n' == byte || '\v' == byte ||
+          '\f' == byte || '\r' == byte);
+}
+
+static pbm_return sourceRead(inputSource *source, uint8_t *buffer,
+                             size_t size) {
+  if (NULL != source->memory) {
+    if (source->size - source->position < size) {
+      return PBM_ERROR;
+    }
+    memcpy(buffer, &source->memory[source->position], size);
+    source->position += size;
+    return PBM_OK;
+  }
+  if (NULL != source->file) {
+    return (fread(buffer, 1, size, source->file) == size) ? PBM_OK
+                                                          : PBM_ERROR;
+  }
+  return readAll(source->fd, buffer, size);
+}
+
+static pbm_return probeHeader(pbmHeader *header, const uint8_t *data,
+                              size_t length, size_t *consumed) {
+  size_t position = 0;
+  while (HEADER_DONE != header->state && position < length) {
+    pbm_return retVal = parseHeader(header, data[position++]);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+  }
+  *consumed = position;
+  return PBM_OK;
+}
+
+static pbm_return probeInfo(const pbmHeader *header, uint64_t offset,
+                            uint64_t total, pbm_imageInfo *info) {
+  uint64_t samples;
+  uint64_t size;
+  pbm_return retVal = payloadSize(header, &samples, &size);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  if (total - offset < size) {
+    return PBM_ERROR;
+  }
+  info->format = header->format;
+  info->width = header->width;
+  info->height = header->height;
+  info->maxval = header->maxval;
+  info->dataOffset = offset;
+  info->dataSize = size;
+  return PBM_OK;
+}
+
+static pbm_return readHeader(inputSource *source, pbmHeader *header) {
+  // The header is read byte by byte to not consume the following data
+  while (HEADER_DONE != header->state) {
+    uint8_t byte;
+    if (PBM_OK != sourceRead(source, &byte, 1)) {
+      return PBM_ERROR;
+    }
+    pbm_return retVal = parseHeader(header, byte);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+  }
+  return PBM_OK;
+}
+
+static pbm_return skipSpace(inputSource *source, uint64_t *offset) {
+  if (NULL == source->file) {
+    while (source->position < source->size &&
+           isSpace(source->memory[source->position])) {
+      source->position++;
+    }
+    if (source->position == source->size) {
+      return PBM_OUT_OF_RANGE;
+    }
+    if (NULL != offset) {
+      *offset = source->position;
+    }
+    return PBM_OK;
+  }
+  int byte;
+  do {
+    byte = getc(source->file);
+  } while (EOF != byte && isSpace((uint8_t)byte));
+  if (EOF == byte) {
+    return ferror(source->file) ? PBM_ERROR : PBM_OUT_OF_RANGE;
+  }
+  if (EOF == ungetc(byte, source->file)) {
+    return PBM_ERROR;
+  }
+  if (NULL != offset) {
+    off_t position = ftello(source->file);
+    if (position < 0) {
+      return PBM_ERROR;
+    }
+    *offset = (uint64_t)position;
+  }
+  return PBM_OK;
+}
+
+static pbm_return payloadSize(const pbmHeader *header, uint64_t *samples,
+                              uint64_t *size) {
+  uint64_t pixels = (uint64_t)header->width * header->height;
+  // At most 6 bytes per pixel
+  if (0 == pixels || pixels > UINT64_MAX / 6) {
+    return PBM_SIZE;
+  }
+  *samples = (PBM_FORMAT_COLOR == header->format ||
+              PBM_FORMAT_COLOR_PLAIN == header->format)
+                 ? 3 * pixels
+                 : pixels;
+  switch (header->format) {
+  case PBM_FORMAT_BINARY:
+    *size = ((uint64_t)header->width + 7) / 8 * header->height;
+    break;
+  case PBM_FORMAT_PLAIN:
+    *size = pixels;
+    break;
+  case PBM_FORMAT_GRAY:
+  case PBM_FORMAT_COLOR:
+    *size = *samples * ((header->maxval > UINT8_MAX) ? 2 : 1);
+    break;
+  default:
+    // Separated samples, the last one may end with the file
+    *size = 2 * *samples - 1;
+    break;
+  }
+  return PBM_OK;
+}
+
+static pbm_return skipRaster(inputSource *source, const pbmHeader *header) {
+  uint64_t samples;
+  uint64_t bytes;
+  pbm_return retVal = payloadSize(header, &samples, &bytes);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+
+  uint8_t text[PLAIN_BUFFER_SIZE];
+  if (PBM_FORMAT_BINARY == header->format ||
+      PBM_FORMAT_GRAY == header->format ||
+      PBM_FORMAT_COLOR == header->format) {
+    if (NULL == source->file) {
+      if (source->size - source->position < bytes) {
+        return PBM_ERROR;
+      }
+      source->position += (size_t)bytes;
+      return PBM_OK;
+    }
+    while (0 != bytes) {
+      size_t length = (bytes < sizeof(text)) ? (size_t)bytes : sizeof(text);
+      if (PBM_OK != sourceRead(source, text, length)) {
+        return PBM_ERROR;
+      }
+      bytes -= length;
+    }
+    return PBM_OK;
+  }
+
+  plainSkip skip = {samples, PBM_FORMAT_PLAIN == header->format, 0};
+  if (NULL == source->file) {
+    size_t consumed = 0;
+    retVal = countSamples(&skip, &source->memory[source->position],
+                          source->size - source->position, &consumed);
+    source->position += consumed;
+  } else {
+    // Every sample has at least one character, as for the decoders
+    while (PBM_OK == retVal && 0 != skip.missing) {
+      size_t length =
+          (skip.missing < sizeof(text)) ? (size_t)skip.missing : sizeof(text);
+      size_t consumed;
+      if (PBM_OK != sourceRead(source, text, length)) {
+        break;
+      }
+      retVal = countSamples(&skip, text, length, &consumed);
+    }
+  }
+  // The last sample may end with the file
+  if (PBM_OK == retVal && 1 == skip.missing && skip.number) {
+    skip.missing = 0;
+  }
+  return (PBM_OK == retVal && 0 != skip.missing) ? PBM_ERROR : retVal;
+}
+
+static pbm_return countSamples(plainSkip *skip, const uint8_t *text,
+                               size_t length, size_t *consumed) {
+  size_t position = 0;
+  while (0 != skip->missing && position < length) {
+    uint8_t byte = text[position++];
+    if (skip->bitmap && ('0' == byte || '1' == byte)) {
+      skip->missing--;
+    } else if (!skip->bitmap && byte >= '0' && byte <= '9') {
+      skip->number = 1;
+    } else if (!isSpace(byte)) {
+      *consumed = position - 1;
+      return PBM_ERROR;
+    } else if (skip->number) {
+      skip->number = 0;
+      skip->missing--;
+    }
+  }
+  *consumed = position;
+  return PBM_OK;
+}
+
+static pbm_return readStream(pbm_stream *stream, pbm_image *imageHandler,
+                             pbm_decodeMode mode,
+                             const pbm_conversion *conversion) {
+  if (NULL != stream->offsets && stream->next >= stream->count) {
+    return PBM_OUT_OF_RANGE;
+  }
+  inputSource source = {stream->mapping, stream->size, stream->position,
+                        stream->file, -1};
+  pbm_return retVal = skipSpace(&source, NULL);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  // Only the mapping can be aliased
+  if (PBM_DECODE_ALIAS == mode && NULL == stream->mapping) {
+    return PBM_ARGUMENTS;
+  }
+  retVal = decodeImage(&source, imageHandler, mode, conversion);
+  if (PBM_OK == retVal) {
+    stream->position = source.position;
+    stream->next++;
+  }
+  return retVal;
+}
+
+static void storeLittleEndian(uint64_t value, uint8_t *data) {
+  for (uint32_t i = 0; i < INDEX_FIELD_SIZE; i++) {
+    data[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint64_t readLittleEndian(const uint8_t *data) {
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < INDEX_FIELD_SIZE; i++) {
+    value |= (uint64_t)data[i] << (8 * i);
+  }
+  return value;
+}
+
+static pbm_return decodeImage(inputSource *source, pbm_image *imageHandler,
+                              pbm_decodeMode mode,
+                              const pbm_conversion *conversion) {
+  pbmHeader header = {0};
+  pbm_return retVal = readHeader(source, &header);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  if (header.format >= PBM_FORMAT_GRAY && NULL == conversion) {
+    return PBM_ERROR;
+  }
+  size_t imageDataSize;
+  if (PBM_OK != rasterSize(header.width, header.height, &imageDataSize)) {
+    return PBM_SIZE;
+  }
+
+  uint8_t *data;
+  if (PBM_DECODE_ALIAS == mode) {
+    // Only the P4 raster is stored as bitmap
+    if (PBM_FORMAT_BINARY != header.format) {
+      return PBM_ARGUMENTS;
+    }
+    if (source->size - source->position < imageDataSize) {
+      return PBM_ERROR;
+    }
+    data = (uint8_t *)&source->memory[source->position];
+    source->position += imageDataSize;
+  } else {
+    if (PBM_FORMAT_BINARY == header.format) {
+      data = (uint8_t *)malloc(imageDataSize);
+    } else {
+      data = (uint8_t *)calloc(imageDataSize, 1);
+    }
+    if (NULL == data) {
+      return PBM_ERROR;
+    }
+    switch (header.format) {
+    case PBM_FORMAT_BINARY:
+      retVal = sourceRead(source, data, imageDataSize);
+      break;
+    case PBM_FORMAT_PLAIN:
+      retVal = decodePlain(source, &header, data);
+      break;
+    default:
+      retVal = decodeSamples(source, &header, conversion, data);
+      break;
+    }
+    if (PBM_OK != retVal) {
+      free(data);
+      return retVal;
+    }
+  }
+  imageHandler->width = header.width;
+  imageHandler->height = header.height;
+  imageHandler->alignment = PBM_DATA_HORIZONTAL_MSB;
+  imageHandler->data = data;
+  return PBM_OK;
+}
+
+static pbm_return decodePlain(inputSource *source, const pbmHeader *header,
+                              uint8_t *data) {
+  plainRaster raster = {data, ((size_t)header->width + 7) / 8, header->width,
+                        header->height, 0, 0};
+  pbm_return retVal = PBM_OK;
+  if (NULL != source->memory) {
+    size_t consumed = 0;
+    retVal = parsePlain(&raster, &source->memory[source->position],
+                        source->size - source->position, &consumed);
+    source->position += consumed;
+  } else {
+    // Every pixel has at least one character, reading no more than the
+    // missing pixels never consumes bytes after the image
+    uint8_t text[PLAIN_BUFFER_SIZE];
+    while (PBM_OK == retVal && raster.y < raster.height) {
+      uint64_t missing =
+          (uint64_t)(raster.height - raster.y) * raster.width - raster.x;
+      size_t length =
+          (missing < sizeof(text)) ? (size_t)missing : sizeof(text);
+      size_t consumed;
+      retVal = sourceRead(source, text, length);
+      if (PBM_OK == retVal) {
+        retVal = parsePlain(&raster, text, length, &consumed);
+      }
+    }
+  }
+  if (PBM_OK == retVal && raster.y < raster.height) {
+    retVal = PBM_ERROR;
+  }
+  return retVal;
+}
+
+static pbm_return decodeSamples(inputSource *source, const pbmHeader *header,
+                                const pbm_conversion *conversion,
+                                uint8_t *data) {
+  sampleRaster raster = {0};
+  raster.conversion = conversion;
+  raster.data = data;
+  raster.stride = ((size_t)header->width + 7) / 8;
+  raster.width = header->width;
+  raster.height = header->height;
+  raster.channels = (PBM_FORMAT_COLOR == header->format ||
+                     PBM_FORMAT_COLOR_PLAIN == header->format)
+                        ? 3
+                        : 1;
+  raster.sampleBytes = (header->maxval > UINT8_MAX) ? 2 : 1;
+  raster.maxval = header->maxval;
+  // At most 6 bytes per pixel, the width is below 2^32
+  raster.rawBytes =
+      (size_t)header->width * raster.channels * raster.sampleBytes;
+  if (raster.rawBytes / raster.channels / raster.sampleBytes !=
+      header->width) {
+    return PBM_SIZE;
+  }
+  raster.raw = (uint8_t *)malloc(raster.rawBytes);
+  raster.luma = (uint8_t *)malloc(header->width);
+  if (NULL == raster.raw || NULL == raster.luma) {
+    free(raster.raw);
+    free(raster.luma);
+    return PBM_ERROR;
+  }
+
+  pbm_return retVal = PBM_OK;
+  if (PBM_FORMAT_GRAY == header->format || PBM_FORMAT_COLOR == header->format) {
+    while (PBM_OK == retVal && raster.y < raster.height) {
+      retVal = sourceRead(source, raster.raw, raster.rawBytes);
+      if (PBM_OK == retVal) {
+        convertRow(&raster);
+      }
+    }
+  } else if (NULL != source->memory) {
+    size_t consumed = 0;
+    retVal = parseSamples(&raster, &source->memory[source->position],
+                          source->size - source->position, &consumed);
+    source->position += consumed;
+  } else {
+    // Every sample has at least one character, as for the P1 raster
+    uint8_t text[PLAIN_BUFFER_SIZE];
+    while (PBM_OK == retVal && raster.y < raster.height) {
+      uint64_t missing = ((uint64_t)(raster.height - raster.y) *
+                              raster.rawBytes -
+                          raster.filled) /
+                         raster.sampleBytes;
+      size_t length =
+          (missing < sizeof(text)) ? (size_t)missing : sizeof(text);
+      size_t consumed;
+      if (PBM_OK != sourceRead(source, text, length)) {
+        // The last sample may end with the file
+        if (1 != missing || 0 == raster.digits) {
+          retVal = PBM_ERROR;
+        }
+        break;
+      }
+      retVal = parseSamples(&raster, text, length, &consumed);
+    }
+  }
+  if (PBM_OK == retVal && raster.y < raster.height && 0 != raster.digits &&
+      raster.filled + raster.sampleBytes == raster.rawBytes &&
+      raster.y + 1 == raster.height) {
+    storeSample(&raster, raster.value);
+  }
+  if (PBM_OK == retVal && raster.y < raster.height) {
+    retVal = PBM_ERROR;
+  }
+  free(raster.raw);
+  free(raster.luma);
+  return retVal;
+}
+
+static pbm_return parseSamples(sampleRaster *raster, const uint8_t *text,
+                               size_t length, size_t *consumed) {
+  size_t position = 0;
+  while (raster->y < raster->height && position < length) {
+    uint8_t byte = text[position++];
+    if (byte >= '0' && byte <= '9') {
+      raster->value = raster->value * 10 + (byte - '0');
+      raster->digits = 1;
+      if (raster->value > raster->maxval) {
+        *consumed = position;
+        return PBM_ERROR;
+      }
+    } else if (!isSpace(byte)) {
+      *consumed = position - 1;
+      return PBM_ERROR;
+    } else if (0 != raster->digits) {
+      storeSample(raster, raster->value);
+    }
+  }
+  *consumed = position;
+  return PBM_OK;
+}
+
+static void storeSample(sampleRaster *raster, uint32_t value) {
+  if (2 == raster->sampleBytes) {
+    raster->raw[raster->filled++] = (uint8_t)(value >> 8);
+  }
+  raster->raw[raster->filled++] = (uint8_t)value;
+  raster->value = 0;
+  raster->digits = 0;
+  if (raster->filled == raster->rawBytes) {
+    convertRow(raster);
+    raster->filled = 0;
+  }
+}
+
+static void convertRow(sampleRaster *raster) {
+  const uint8_t *raw = raster->raw;
+  const uint8_t *luma = raw;
+  const uint32_t width = raster->width;
+  if (1 == raster->sampleBytes && UINT8_MAX == raster->maxval) {
+    if (3 == raster->channels) {
+      lumaRow(raw, width, raster->luma);
+      luma = raster->luma;
+    }
+  } else {
+    // Scale the samples to 8 bit first
+    const uint32_t maxval = raster->maxval;
+    for (uint32_t x = 0; x < width; x++) {
+      uint32_t sample[3];
+      for (uint32_t c = 0; c < raster->channels; c++) {
+        uint32_t value = *raw++;
+        if (2 == raster->sampleBytes) {
+          value = value << 8 | *raw++;
+        }
+        sample[c] = (value * UINT8_MAX + maxval / 2) / maxval;
+      }
+      raster->luma[x] =
+          (uint8_t)((3 == raster->channels)
+                        ? (77u * sample[0] + 150u * sample[1] +
+                           29u * sample[2] + 128) >>
+                              8
+                        : sample[0]);
+    }
+    luma = raster->luma;
+  }
+
+  uint8_t limits[16];
+  if (PBM_CONVERT_DITHER == raster->conversion->mode) {
+    for (uint32_t i = 0; i < sizeof(limits); i++) {
+      limits[i] = (uint8_t)(ditherMatrix[raster->y % 8][i % 8] * 4 + 2);
+    }
+  } else {
+    memset(limits, raster->conversion->threshold, sizeof(limits));
+  }
+  thresholdRow(luma, width, limits, &raster->data[raster->y * raster->stride]);
+  raster->y++;
+}
+
+static void lumaRow(const uint8_t *rgb, uint32_t width, uint8_t *luma) {
+  uint32_t x = 0;
+#if defined(__SSE2__)
+  // ITU-R BT.601 weights in 1/256, the sums stay below 2^16
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i red = _mm_set1_epi16(77);
+  const __m128i green = _mm_set1_epi16(150);
+  const __m128i blue = _mm_set1_epi16(29);
+  const __m128i half = _mm_set1_epi16(128);
+  for (; x + 32 <= width; x += 32, rgb += 96) {
+    // Five rounds of byte interleaving split 32 pixels into the channels,
+    // red in the chunks 0 and 1, green in 2 and 3, blue in 4 and 5
+    __m128i chunk[6];
+    for (uint32_t i = 0; i < 6; i++) {
+      chunk[i] = _mm_loadu_si128((const __m128i *)&rgb[i * 16]);
+    }
+    for (uint32_t round = 0; round < 5; round++) {
+      __m128i split[6];
+      for (uint32_t i = 0; i < 3; i++) {
+        split[2 * i] = _mm_unpacklo_epi8(chunk[i], chunk[i + 3]);
+        split[2 * i + 1] = _mm_unpackhi_epi8(chunk[i], chunk[i + 3]);
+      }
+      memcpy(chunk, split, sizeof(chunk));
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+      // Weighted sums of the low and the high 8 pixels in 16 bit
+      __m128i low = _mm_add_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(chunk[i], zero), red),
+                        _mm_mullo_epi16(_mm_unpacklo_epi8(chunk[i + 2], zero),
+                                        green)),
+          _mm_add_epi16(
+              _mm_mullo_epi16(_mm_unpacklo_epi8(chunk[i + 4], zero), blue),
+              half));
+      __m128i high = _mm_add_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(chunk[i], zero), red),
+                        _mm_mullo_epi16(_mm_unpackhi_epi8(chunk[i + 2], zero),
+                                        green)),
+          _mm_add_epi16(
+              _mm_mullo_epi16(_mm_unpackhi_epi8(chunk[i + 4], zero), blue),
+              half));
+      _mm_storeu_si128((__m128i *)&luma[x + i * 16],
+                       _mm_packus_epi16(_mm_srli_epi16(low, 8),
+                                        _mm_srli_epi16(high, 8)));
+    }
+  }
+#endif
+  for (; x < width; x++, rgb += 3) {
+    luma[x] =
+        (uint8_t)((77u * rgb[0] + 150u * rgb[1] + 29u * rgb[2] + 128) >> 8);
+  }
+}
+
+static void thresholdRow(const uint8_t *luma, uint32_t width,
+                         const uint8_t *limits, uint8_t *row) {
+  uint32_t x = 0;
+#if defined(__SSE2__)
+  // Unsigned compare of 16 pixels with the sign bit flipped
+  const __m128i bias = _mm_set1_epi8((char)0x80);
+  const __m128i limit =
+      _mm_xor_si128(_mm_loadu_si128((const __m128i *)limits), bias);
+  for (; x + 16 <= width; x += 16) {
+    __m128i value =
+        _mm_xor_si128(_mm_loadu_si128((const __m128i *)&luma[x]), bias);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(value, limit));
+    row[x / 8] = reversedBytes[mask & 0xFF];
+    row[x / 8 + 1] = reversedBytes[mask >> 8];
+  }
+#endif
+  for (; x < width; x++) {
+    if (luma[x] < limits[x % 16]) {
+      row[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+    }
+  }
+}
+
+static pbm_return parsePlain(plainRaster *raster, const uint8_t *text,
+                             size_t length, size_t *consumed) {
+  size_t position = 0;
+#if defined(__SSE2__)
+  // Classify 16 characters at once, the masks have one bit per character
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i one = _mm_set1_epi8('1');
+  const __m128i blank = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t' - 1);
+  const __m128i carriageReturn = _mm_set1_epi8('\r' + 1);
+  while (raster->y < raster->height && length - position >= 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)&text[position]);
+    __m128i ones = _mm_cmpeq_epi8(chunk, one);
+    __m128i digits = _mm_or_si128(_mm_cmpeq_epi8(chunk, zero), ones);
+    // '\t' to '\r' and the blank, the signed compare is fine for ASCII
+    __m128i spaces = _mm_or_si128(
+        _mm_cmpeq_epi8(chunk, blank),
+        _mm_and_si128(_mm_cmpgt_epi8(chunk, tab),
+                      _mm_cmplt_epi8(chunk, carriageReturn)));
+    uint32_t digitMask = (uint32_t)_mm_movemask_epi8(digits);
+    uint32_t oneMask = (uint32_t)_mm_movemask_epi8(ones);
+    uint32_t spaceMask = (uint32_t)_mm_movemask_epi8(spaces);
+    if (0xFFFF != (digitMask | spaceMask)) {
+      // Let the scalar loop find the invalid character
+      break;
+    }
+    if (0xFFFF == digitMask && raster->width - raster->x >= 16) {
+      // 16 pixels of the same line, or them into the cleared data
+      uint32_t bits = (uint32_t)reversedBytes[oneMask & 0xFF] << 8 |
+                      reversedBytes[oneMask >> 8];
+      uint8_t *row = &raster->data[raster->y * raster->stride];
+      uint32_t shift = raster->x % 8;
+      uint8_t *dst = &row[raster->x / 8];
+      if (0 == shift) {
+        dst[0] = (uint8_t)(bits >> 8);
+        dst[1] = (uint8_t)bits;
+      } else {
+        bits <<= 8 - shift;
+        dst[0] |= (uint8_t)(bits >> 16);
+        dst[1] |= (uint8_t)(bits >> 8);
+        dst[2] |= (uint8_t)bits;
+      }
+      raster->x += 16;
+      if (raster->x == raster->width) {
+        raster->x = 0;
+        raster->y++;
+      }
+      position += 16;
+      continue;
+    }
+    // Walk the digits between the whitespaces
+    while (0 != digitMask) {
+      uint32_t index = (uint32_t)__builtin_ctz(digitMask);
+      plainPixel(raster, (uint8_t)((oneMask >> index) & 1));
+      digitMask &= digitMask - 1;
+      if (raster->y == raster->height) {
+        *consumed = position + index + 1;
+        return PBM_OK;
+      }
+    }
+    position += 16;
+  }
+#endif
+  while (raster->y < raster->height && position < length) {
+    uint8_t byte = text[position++];
+    if ('0' == byte || '1' == byte) {
+      plainPixel(raster, (uint8_t)(byte - '0'));
+    } else if (!isSpace(byte)) {
+      *consumed = position - 1;
+      return PBM_ERROR;
+    }
+  }
+  *consumed = position;
+  return PBM_OK;
+}
+
+static void plainPixel(plainRaster *raster, uint8_t set) {
+  if (set) {
+    raster->data[raster->y * raster->stride + raster->x / 8] |=
+        (uint8_t)(0x80 >> (raster->x % 8));
+  }
+  if (++raster->x == raster->width) {
+    raster->x = 0;
+    raster->y++;
+  }
+}
+
+static pbm_return sinkWrite(outputSink *sink, const void *data, size_t size) {
+  if (NULL != sink->memory) {
+    memcpy(sink->memory, data, size);
+    sink->memory += size;
+    return PBM_OK;
+  }
+  if (NULL != sink->file) {
+    return (fwrite(data, 1, size, sink->file) == size) ? PBM_OK : PBM_ERROR;
+  }
+  return writeAll(sink->fd, (const uint8_t *)data, size);
+}
+
+static pbm_return encodeImage(outputSink *sink, const pbm_image *imageHandler,
+                              pbm_format format) {
+  char header[HEADER_BUFFER_SIZE];
+  size_t headerSize = writeHeader(imageHandler, format, header);
+  pbm_return retVal = sinkWrite(sink, header, headerSize);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  size_t stride = ((size_t)imageHandler->width + 7) / 8;
+  if (PBM_FORMAT_BINARY == format) {
+    retVal = sinkWrite(sink, imageHandler->data, stride * imageHandler->height);
+    if (PBM_OK == retVal) {
+      retVal = sinkWrite(sink, "\n", 1);
+    }
+    return retVal;
+  }
+
+  // Lines of 64 pixels are 8 data bytes copied from the text table
+  char text[PLAIN_BUFFER_SIZE];
+  size_t length = 0;
+  for (uint32_t y = 0; y < imageHandler->height && PBM_OK == retVal; y++) {
+    const uint8_t *row = &imageHandler->data[y * stride];
+    for (uint32_t x = 0; x < imageHandler->width; x += PLAIN_LINE_PIXELS) {
+      uint32_t pixels = imageHandler->width - x;
+      if (pixels > PLAIN_LINE_PIXELS) {
+        pixels = PLAIN_LINE_PIXELS;
+      }
+      if (length + PLAIN_LINE_PIXELS + 1 > sizeof(text)) {
+        retVal = sinkWrite(sink, text, length);
+        length = 0;
+      }
+      for (uint32_t i = 0; i < pixels; i += 8) {
+        memcpy(&text[length + i], plainText[row[(x + i) / 8]], 8);
+      }
+      length += pixels;
+      text[length++] = '\n';
+    }
+  }
+  if (PBM_OK == retVal && 0 != length) {
+    retVal = sinkWrite(sink, text, length);
+  }
+  return retVal;
+}
+
+static size_t writeHeader(const pbm_image *imageHandler, pbm_format format,
+                          char *header) {
+  int length = snprintf(header, HEADER_BUFFER_SIZE,
+                        "P%c\n%" PRIu32 " %" PRIu32 "\n",
+                        (PBM_FORMAT_PLAIN == format) ? '1' : '4',
+                        imageHandler->width, imageHandler->height);
+  return (size_t)length;
+}
+
+static pbm_return checkEncode(const pbm_image *imageHandler,
+                              pbm_format format, size_t *size) {
+  if (NULL == imageHandler->data ||
+      PBM_DATA_HORIZONTAL_MSB != imageHandler->alignment ||
+      format > PBM_FORMAT_PLAIN) {
+    return PBM_ARGUMENTS;
+  }
+  size_t imageDataSize;
+  pbm_return retVal =
+      rasterSize(imageHandler->width, imageHandler->height, &imageDataSize);
+  if (PBM_OK != retVal) {
+    return retVal;
+  }
+  char header[HEADER_BUFFER_SIZE];
+  size_t headerSize = writeHeader(imageHandler, format, header);
+  size_t rasterBytes;
+  if (PBM_FORMAT_BINARY == format) {
+    // Data and the closing line feed
+    rasterBytes = imageDataSize;
+    if (rasterBytes > SIZE_MAX - headerSize - 1) {
+      return PBM_SIZE;
+    }
+    *size = headerSize + rasterBytes + 1;
+    return PBM_OK;
+  }
+  // Every pixel a character and a line feed after each line of text
+  uint64_t lineBytes =
+      (uint64_t)imageHandler->width +
+      ((uint64_t)imageHandler->width + PLAIN_LINE_PIXELS - 1) /
+          PLAIN_LINE_PIXELS;
+  if (lineBytes > (SIZE_MAX - headerSize) / imageHandler->height) {
+    return PBM_SIZE;
+  }
+  *size = headerSize + (size_t)lineBytes * imageHandler->height;
+  return PBM_OK;
+}
+
+static pbm_return readAll(int fd, uint8_t *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t count = read(fd, buffer, size);
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count <= 0) {
+      return PBM_ERROR;
+    }
+    buffer += count;
+    size -= (size_t)count;
+  }
+  return PBM_OK;
+}
+
+static pbm_return writeAll(int fd, const uint8_t *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t count = write(fd, buffer, size);
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count <= 0) {
+      return PBM_ERROR;
+    }
+    buffer += count;
+    size -= (size_t)count;
+  }
+  return PBM_OK;
+}
+
+static pbm_return rasterSize(uint32_t width, uint32_t height, size_t *size) {
+  if (0 == width || 0 == height) {
+    return PBM_SIZE;
+  }
+  size_t lineBytes = ((size_t)width + 7) / 8;
+  if (lineBytes > SIZE_MAX / height) {
+    return PBM_SIZE;
+  }
+  *size = lineBytes * height;
+  return PBM_OK;
+}
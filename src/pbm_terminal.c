@@ -0,0 +1,447 @@
+/**
+ * @file pbm_terminal.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Character cell terminal on an image
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "pbm_terminal.h"
+
+#include <string.h>
+
+#define ESCAPE_CHARACTER (0x1B)  ///< Start of an escape sequence
+#define PARAMETER_MAX (9999)     ///< Maximal value of an escape parameter
+#define CELL_ATTRIBUTES                                                        \
+  (PBM_TERMINAL_BOLD | PBM_TERMINAL_UNDERLINE |                                \
+   PBM_TERMINAL_INVERSE) ///< Attributes without the dirty flag
+
+/**
+ * @brief States of the escape sequence parser
+ *
+ */
+typedef enum {
+  ESCAPE_NONE = 0, ///< Normal characters
+  ESCAPE_START,    ///< Escape character received
+  ESCAPE_CSI       ///< Control sequence introducer received
+} escapeState;
+
+/**
+ * @brief Get a cell of the terminal
+ *
+ * @param terminal the terminal
+ * @param row the shown row
+ * @param column the column
+ * @return pbm_terminalCell* the cell
+ */
+static pbm_terminalCell *terminalCell(pbm_terminal *terminal, uint32_t row,
+                                      uint32_t column);
+
+/**
+ * @brief Set the character and the attributes of a cell, changed cells are
+ * marked dirty
+ *
+ * @param cell the cell
+ * @param character the new character
+ * @param attributes the new attributes
+ */
+static void setCell(pbm_terminalCell *cell, uint8_t character,
+                    uint8_t attributes);
+
+/**
+ * @brief Clear the cells of a row between two columns
+ *
+ * @param terminal the terminal
+ * @param row the shown row
+ * @param first the first column to clear
+ * @param last the last column to clear
+ */
+static void clearCells(pbm_terminal *terminal, uint32_t row, uint32_t first,
+                       uint32_t last);
+
+/**
+ * @brief Move the cursor to the next row, scroll at the last row
+ *
+ * @param terminal the terminal
+ */
+static void lineFeed(pbm_terminal *terminal);
+
+/**
+ * @brief Write a printable character at the cursor
+ *
+ * @param terminal the terminal
+ * @param character the character
+ */
+static void putCharacter(pbm_terminal *terminal, uint8_t character);
+
+/**
+ * @brief Execute a control sequence with the parsed parameters
+ *
+ * @param terminal the terminal
+ * @param command the final character of the sequence
+ */
+static void executeSequence(pbm_terminal *terminal, uint8_t command);
+
+/**
+ * @brief Get an escape parameter
+ *
+ * @param terminal the terminal
+ * @param index the index of the parameter
+ * @param fallback the value of a missing or zero parameter
+ * @return uint32_t the parameter value
+ */
+static uint32_t sequenceParameter(const pbm_terminal *terminal, uint32_t index,
+                                  uint32_t fallback);
+
+pbm_return pbm_initTerminal(pbm_terminal *terminal, pbm_image *imageHandler,
+                            uint32_t x, uint32_t y, const pbm_font *font,
+                            uint16_t rows, uint16_t columns,
+                            pbm_terminalCell *cells, pbm_colors color) {
+  if (NULL == terminal || NULL == imageHandler || NULL == font ||
+      NULL == cells || 0 == rows || 0 == columns) {
+    return PBM_ARGUMENTS;
+  }
+  if (NULL != font->metrics || NULL != font->kerning || 0 == font->width ||
+      0 == font->height) {
+    return PBM_ARGUMENTS;
+  }
+  if ((uint64_t)x + (uint64_t)columns * font->width > imageHandler->width ||
+      (uint64_t)y + (uint64_t)rows * font->height > imageHandler->height) {
+    return PBM_SIZE;
+  }
+  memset(terminal, 0, sizeof(*terminal));
+  terminal->image = imageHandler;
+  terminal->font = font;
+  terminal->x = x;
+  terminal->y = y;
+  terminal->rows = rows;
+  terminal->columns = columns;
+  terminal->cells = cells;
+  terminal->color = color;
+  for (uint32_t i = 0; i < (uint32_t)rows * columns; i++) {
+    cells[i].character = ' ';
+    cells[i].attributes = PBM_TERMINAL_DIRTY;
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_writeTerminal(pbm_terminal *terminal, const char *msg) {
+  if (NULL == terminal || NULL == msg) {
+    return PBM_ARGUMENTS;
+  }
+  for (const uint8_t *c = (const uint8_t *)msg; '\0' != *c; c++) {
+    switch (terminal->escapeState) {
+    case ESCAPE_START:
+      if ('[' == *c) {
+        terminal->escapeState = ESCAPE_CSI;
+        terminal->parameterCount = 0;
+        memset(terminal->parameters, 0, sizeof(terminal->parameters));
+      } else {
+        // Unsupported escape sequence
+        terminal->escapeState = ESCAPE_NONE;
+      }
+      continue;
+    case ESCAPE_CSI:
+      if (*c >= '0' && *c <= '9') {
+        if (0 == terminal->parameterCount) {
+          terminal->parameterCount = 1;
+        }
+        uint16_t *parameter =
+            &terminal->parameters[terminal->parameterCount - 1];
+        uint32_t value = *parameter * 10u + (uint32_t)(*c - '0');
+        *parameter = (uint16_t)((value > PARAMETER_MAX) ? PARAMETER_MAX
+                                                          : value);
+      } else if (';' == *c) {
+        if (0 == terminal->parameterCount) {
+          terminal->parameterCount = 1;
+        }
+        if (terminal->parameterCount < PBM_TERMINAL_MAX_PARAMETERS) {
+          terminal->parameterCount++;
+        }
+      } else if (*c >= 0x40 && *c <= 0x7E) {
+        executeSequence(terminal, *c);
+        terminal->escapeState = ESCAPE_NONE;
+      }
+      // Private and intermediate characters are ignored
+      continue;
+    default:
+      break;
+    }
+
+    switch (*c) {
+    case ESCAPE_CHARACTER:
+      terminal->escapeState = ESCAPE_START;
+      break;
+    case '\n':
+      terminal->cursorColumn = 0;
+      lineFeed(terminal);
+      break;
+    case '\r':
+      terminal->cursorColumn = 0;
+      break;
+    case '\b':
+      if (terminal->cursorColumn >= terminal->columns) {
+        terminal->cursorColumn = terminal->columns - 1;
+      }
+      if (terminal->cursorColumn > 0) {
+        terminal->cursorColumn--;
+      }
+      break;
+    case '\t': {
+      uint32_t column = (terminal->cursorColumn / PBM_TERMINAL_TAB_SIZE + 1) *
+                        PBM_TERMINAL_TAB_SIZE;
+      terminal->cursorColumn = (uint16_t)((column < terminal->columns)
+                                              ? column
+                                              : terminal->columns - 1u);
+      break;
+    }
+    default:
+      if (*c >= ' ') {
+        putCharacter(terminal, *c);
+      }
+      break;
+    }
+  }
+  return PBM_OK;
+}
+
+pbm_return pbm_setTerminalCursor(pbm_terminal *terminal, uint16_t row,
+                                 uint16_t column) {
+  if (NULL == terminal) {
+    return PBM_ARGUMENTS;
+  }
+  if (row >= terminal->rows || column >= terminal->columns) {
+    return PBM_OUT_OF_RANGE;
+  }
+  terminal->cursorRow = row;
+  terminal->cursorColumn = column;
+  return PBM_OK;
+}
+
+pbm_return pbm_clearTerminal(pbm_terminal *terminal) {
+  if (NULL == terminal) {
+    return PBM_ARGUMENTS;
+  }
+  for (uint32_t row = 0; row < terminal->rows; row++) {
+    clearCells(terminal, row, 0, terminal->columns - 1u);
+  }
+  terminal->cursorRow = 0;
+  terminal->cursorColumn = 0;
+  return PBM_OK;
+}
+
+pbm_return pbm_flushTerminal(pbm_terminal *terminal) {
+  if (NULL == terminal) {
+    return PBM_ARGUMENTS;
+  }
+  const pbm_font *font = terminal->font;
+  // Nothing of the image can be reused if all rows are scrolled out
+  uint8_t redraw = (terminal->scrolledRows >= terminal->rows);
+  if (0 != terminal->scrolledRows && !redraw) {
+    pbm_rect area = {terminal->x, terminal->y,
+                     (uint32_t)terminal->columns * font->width,
+                     (uint32_t)terminal->rows * font->height};
+    pbm_scroll(terminal->image, &area, 0,
+               -(int32_t)(terminal->scrolledRows * font->height),
+               !terminal->color);
+  }
+  terminal->scrolledRows = 0;
+  for (uint32_t row = 0; row < terminal->rows; row++) {
+    for (uint32_t column = 0; column < terminal->columns; column++) {
+      pbm_terminalCell *cell = terminalCell(terminal, row, column);
+      if (!redraw && 0 == (cell->attributes & PBM_TERMINAL_DIRTY)) {
+        continue;
+      }
+      pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE};
+      if (PBM_TERMINAL_BOLD & cell->attributes) {
+        style.emphasis |= PBM_TEXT_BOLD;
+      }
+      if (PBM_TERMINAL_UNDERLINE & cell->attributes) {
+        style.emphasis |= PBM_TEXT_UNDERLINE;
+      }
+      pbm_colors color = terminal->color;
+      if (PBM_TERMINAL_INVERSE & cell->attributes) {
+        color = !color;
+      }
+      pbm_writeCharStyled(terminal->image, terminal->x + column * font->width,
+                          terminal->y + row * font->height, color, font,
+                          &style, cell->character);
+      cell->attributes &= (uint8_t)~PBM_TERMINAL_DIRTY;
+    }
+  }
+  return PBM_OK;
+}
+
+static pbm_terminalCell *terminalCell(pbm_terminal *terminal, uint32_t row,
+                                      uint32_t column) {
+  uint32_t cellRow = (terminal->firstRow + row) % terminal->rows;
+  return &terminal->cells[cellRow * terminal->columns + column];
+}
+
+static void setCell(pbm_terminalCell *cell, uint8_t character,
+                    uint8_t attributes) {
+  if (cell->character != character ||
+      (cell->attributes & CELL_ATTRIBUTES) != attributes) {
+    cell->character = character;
+    cell->attributes = attributes | PBM_TERMINAL_DIRTY;
+  }
+}
+
+static void clearCells(pbm_terminal *terminal, uint32_t row, uint32_t first,
+                       uint32_t last) {
+  for (uint32_t column = first; column <= last; column++) {
+    setCell(terminalCell(terminal, row, column), ' ', 0);
+  }
+}
+
+static void lineFeed(pbm_terminal *terminal) {
+  if (terminal->cursorRow + 1u < terminal->rows) {
+    terminal->cursorRow++;
+    return;
+  }
+  // Scroll by moving the first row of the ring buffer
+  terminal->firstRow = (uint16_t)((terminal->firstRow + 1u) % terminal->rows);
+  if (terminal->scrolledRows < terminal->rows) {
+    terminal->scrolledRows++;
+  }
+  // The new row shows the pixels of the old first row after the image scroll
+  for (uint32_t column = 0; column < terminal->columns; column++) {
+    pbm_terminalCell *cell =
+        terminalCell(terminal, terminal->rows - 1u, column);
+    cell->character = ' ';
+    cell->attributes = PBM_TERMINAL_DIRTY;
+  }
+}
+
+static void putCharacter(pbm_terminal *terminal, uint8_t character) {
+  if (terminal->cursorColumn >= terminal->columns) {
+    // Wrap to the next row with the first character after the last column
+    terminal->cursorColumn = 0;
+    lineFeed(terminal);
+  }
+  setCell(terminalCell(terminal, terminal->cursorRow, terminal->cursorColumn),
+          character, terminal->attributes);
+  terminal->cursorColumn++;
+}
+
+static void executeSequence(pbm_terminal *terminal, uint8_t command) {
+  uint32_t row = terminal->cursorRow;
+  uint32_t column = terminal->cursorColumn;
+  uint32_t lastRow = terminal->rows - 1u;
+  uint32_t lastColumn = terminal->columns - 1u;
+  column = (column > lastColumn) ? lastColumn : column;
+  uint32_t count = sequenceParameter(terminal, 0, 1);
+
+  switch (command) {
+  case 'A':
+    row = (count > row) ? 0 : row - count;
+    break;
+  case 'B':
+    row = (count > lastRow - row) ? lastRow : row + count;
+    break;
+  case 'C':
+    column = (count > lastColumn - column) ? lastColumn : column + count;
+    break;
+  case 'D':
+    column = (count > column) ? 0 : column - count;
+    break;
+  case 'H':
+  case 'f':
+    row = sequenceParameter(terminal, 0, 1) - 1;
+    column = sequenceParameter(terminal, 1, 1) - 1;
+    row = (row > lastRow) ? lastRow : row;
+    column = (column > lastColumn) ? lastColumn : column;
+    break;
+  case 'J': {
+    uint32_t mode = sequenceParameter(terminal, 0, 0);
+    if (0 == mode) {
+      clearCells(terminal, row, column, lastColumn);
+      for (uint32_t i = row + 1; i <= lastRow; i++) {
+        clearCells(terminal, i, 0, lastColumn);
+      }
+    } else if (1 == mode) {
+      for (uint32_t i = 0; i < row; i++) {
+        clearCells(terminal, i, 0, lastColumn);
+      }
+      clearCells(terminal, row, 0, column);
+    } else if (2 == mode) {
+      for (uint32_t i = 0; i <= lastRow; i++) {
+        clearCells(terminal, i, 0, lastColumn);
+      }
+    }
+    // The cursor stays at the position
+    return;
+  }
+  case 'K': {
+    uint32_t mode = sequenceParameter(terminal, 0, 0);
+    if (0 == mode) {
+      clearCells(terminal, row, column, lastColumn);
+    } else if (1 == mode) {
+      clearCells(terminal, row, 0, column);
+    } else if (2 == mode) {
+      clearCells(terminal, row, 0, lastColumn);
+    }
+    return;
+  }
+  case 'm': {
+    uint32_t parameters =
+        (0 == terminal->parameterCount) ? 1 : terminal->parameterCount;
+    for (uint32_t i = 0; i < parameters; i++) {
+      switch (terminal->parameters[i]) {
+      case 0:
+        terminal->attributes = 0;
+        break;
+      case 1:
+        terminal->attributes |= PBM_TERMINAL_BOLD;
+        break;
+      case 4:
+        terminal->attributes |= PBM_TERMINAL_UNDERLINE;
+        break;
+      case 7:
+        terminal->attributes |= PBM_TERMINAL_INVERSE;
+        break;
+      case 22:
+        terminal->attributes &= (uint8_t)~PBM_TERMINAL_BOLD;
+        break;
+      case 24:
+        terminal->attributes &= (uint8_t)~PBM_TERMINAL_UNDERLINE;
+        break;
+      case 27:
+        terminal->attributes &= (uint8_t)~PBM_TERMINAL_INVERSE;
+        break;
+      default:
+        break;
+      }
+    }
+    return;
+  }
+  default:
+    return;
+  }
+  terminal->cursorRow = (uint16_t)row;
+  terminal->cursorColumn = (uint16_t)column;
+}
+
+static uint32_t sequenceParameter(const pbm_terminal *terminal, uint32_t index,
+                                  uint32_t fallback) {
+  if (index >= terminal->parameterCount || 0 == terminal->parameters[index]) {
+    return fallback;
+  }
+  return terminal->parameters[index];
+}
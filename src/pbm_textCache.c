@@ -0,0 +1,347 @@
+/**
+ * @file pbm_textCache.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Cache of rendered strings for repeated labels
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pbm_textCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PBM_IMAGE_ALIGNMENT
+#define BITMAP_ALIGNMENT (PBM_IMAGE_ALIGNMENT) ///< Copied line or page wise
+#else
+#define BITMAP_ALIGNMENT (PBM_DATA_HORIZONTAL_MSB) ///< Copied line by line
+#endif
+
+/**
+ * @brief Cached rendered string
+ *
+ * The entry, the string and the bitmaps are allocated in one block.
+ */
+struct pbm_textCacheEntry {
+  pbm_textCacheEntry *newer; ///< Next more recently used string
+  pbm_textCacheEntry *older; ///< Next less recently used string
+  pbm_textCacheEntry *next;  ///< Next string in the same hash bucket
+  const pbm_font *font;      ///< Font of the string
+  pbm_textStyle style;       ///< Normalized style of the string
+  uint32_t hash;             ///< Hash of the string
+  size_t size;               ///< Allocated memory of the entry
+  pbm_image ink;        ///< Pixels drawn in the color
+  pbm_image background; ///< Pixels drawn in the inverted color, opaque only
+  char text[];          ///< The cached string
+};
+
+/**
+ * @brief Fill the default values of a style
+ *
+ * @param style the style of the string or NULL
+ * @param normalized output style to compare the cached strings
+ */
+static void normalizeStyle(const pbm_textStyle *style,
+                           pbm_textStyle *normalized);
+
+/**
+ * @brief Search a string in the cache
+ *
+ * @param cache the text cache
+ * @param font the font of the string
+ * @param style the normalized style
+ * @param hash the hash of the string
+ * @param msg the C string
+ * @return pbm_textCacheEntry* the cached string or NULL
+ */
+static pbm_textCacheEntry *findEntry(const pbm_textCache *cache,
+                                     const pbm_font *font,
+                                     const pbm_textStyle *style,
+                                     uint32_t hash, const char *msg);
+
+/**
+ * @brief Render a string into a new entry
+ *
+ * @param font the font of the string
+ * @param style the normalized style
+ * @param hash the hash of the string
+ * @param msg the C string
+ * @param budget maximal memory of the entry
+ * @param entry output rendered string, NULL if larger than the budget
+ * @return pbm_return state of the function
+ */
+static pbm_return renderEntry(const pbm_font *font, const pbm_textStyle *style,
+                              uint32_t hash, const char *msg, size_t budget,
+                              pbm_textCacheEntry **entry);
+
+/**
+ * @brief Remove an entry from the LRU list
+ *
+ * @param cache the text cache
+ * @param entry the entry to remove
+ */
+static void unlinkEntry(pbm_textCache *cache, pbm_textCacheEntry *entry);
+
+/**
+ * @brief Add an entry as the most recently used string
+ *
+ * @param cache the text cache
+ * @param entry the entry to add
+ */
+static void linkNewest(pbm_textCache *cache, pbm_textCacheEntry *entry);
+
+/**
+ * @brief Remove the least recently used string and release its memory
+ *
+ * @param cache the text cache
+ */
+static void evictOldest(pbm_textCache *cache);
+
+pbm_return pbm_initTextCache(pbm_textCache *cache, size_t budget) {
+  if (NULL == cache) {
+    return PBM_ARGUMENTS;
+  }
+  memset(cache, 0, sizeof(*cache));
+  cache->budget = budget;
+  return PBM_OK;
+}
+
+void pbm_clearTextCache(pbm_textCache *cache) {
+  if (NULL == cache) {
+    return;
+  }
+  pbm_textCacheEntry *entry = cache->newest;
+  while (NULL != entry) {
+    pbm_textCacheEntry *older = entry->older;
+    free(entry);
+    entry = older;
+  }
+  cache->newest = NULL;
+  cache->oldest = NULL;
+  cache->used = 0;
+  cache->entries = 0;
+  memset(cache->buckets, 0, sizeof(cache->buckets));
+}
+
+pbm_return pbm_writeStringCached(pbm_textCache *cache,
+                                 pbm_image *const imageHandler,
+                                 const uint32_t x, const uint32_t y,
+                                 pbm_colors color, const pbm_font *font,
+                                 pbm_stringAlignment textAlignment,
+                                 const pbm_textStyle *style, const char *msg) {
+  if (NULL == cache || NULL == imageHandler || NULL == font || NULL == msg) {
+    return PBM_ARGUMENTS;
+  }
+  pbm_textStyle normalized;
+  normalizeStyle(style, &normalized);
+  uint32_t hash = pbm_hashString(msg);
+
+  pbm_textCacheEntry *entry = findEntry(cache, font, &normalized, hash, msg);
+  if (NULL != entry) {
+    cache->hits++;
+    unlinkEntry(cache, entry);
+    linkNewest(cache, entry);
+  } else {
+    pbm_return retVal =
+        renderEntry(font, &normalized, hash, msg, cache->budget, &entry);
+    if (PBM_OK != retVal) {
+      return retVal;
+    }
+    cache->misses++;
+    if (NULL == entry) {
+      // Larger than the whole cache
+      return pbm_writeStringStyled(imageHandler, x, y, color, font,
+                                   textAlignment, &normalized, msg);
+    }
+    while (NULL != cache->oldest && cache->used + entry->size > cache->budget) {
+      evictOldest(cache);
+    }
+    pbm_textCacheEntry **bucket =
+        &cache->buckets[hash % PBM_TEXT_CACHE_BUCKETS];
+    entry->next = *bucket;
+    *bucket = entry;
+    linkNewest(cache, entry);
+    cache->used += entry->size;
+    cache->entries++;
+  }
+
+  // Unset pixels inside the glyph cells first, they may be below the ink
+  if (NULL != entry->background.data) {
+    pbm_drawBitmap(imageHandler, x, y, !color, textAlignment,
+                   &entry->background, PBM_TEXT_TRANSPARENT);
+  }
+  return pbm_drawBitmap(imageHandler, x, y, color, textAlignment, &entry->ink,
+                        PBM_TEXT_TRANSPARENT);
+}
+
+static void normalizeStyle(const pbm_textStyle *style,
+                           pbm_textStyle *normalized) {
+  memset(normalized, 0, sizeof(*normalized));
+  normalized->mode = PBM_TEXT_OPAQUE;
+  normalized->scale = 1;
+  normalized->rotation = PBM_ROTATE_0;
+  if (NULL != style) {
+    normalized->mode = style->mode;
+    normalized->scale = (0 == style->scale) ? 1 : style->scale;
+    normalized->smooth = (0 != style->smooth);
+    normalized->rotation = style->rotation;
+    normalized->emphasis = style->emphasis;
+  }
+}
+
+static pbm_textCacheEntry *findEntry(const pbm_textCache *cache,
+                                     const pbm_font *font,
+                                     const pbm_textStyle *style,
+                                     uint32_t hash, const char *msg) {
+  pbm_textCacheEntry *entry = cache->buckets[hash % PBM_TEXT_CACHE_BUCKETS];
+  while (NULL != entry) {
+    if (entry->hash == hash && entry->font == font &&
+        entry->style.mode == style->mode &&
+        entry->style.scale == style->scale &&
+        entry->style.smooth == style->smooth &&
+        entry->style.rotation == style->rotation &&
+        entry->style.emphasis == style->emphasis &&
+        0 == strcmp(entry->text, msg)) {
+      return entry;
+    }
+    entry = entry->next;
+  }
+  return NULL;
+}
+
+static pbm_return renderEntry(const pbm_font *font, const pbm_textStyle *style,
+                              uint32_t hash, const char *msg, size_t budget,
+                              pbm_textCacheEntry **entry) {
+  *entry = NULL;
+  pbm_textExtent extent;
+  if (PBM_OK != pbm_measureString(font, msg, &extent)) {
+    return PBM_ARGUMENTS;
+  }
+  if ('\0' == *msg || style->scale > PBM_TEXT_SCALE_MAX) {
+    return PBM_ARGUMENTS;
+  }
+  uint32_t width = extent.width * style->scale;
+  uint32_t height = extent.height * style->scale;
+  if (PBM_ROTATE_90 == style->rotation || PBM_ROTATE_270 == style->rotation) {
+    uint32_t swap = width;
+    width = height;
+    height = swap;
+  }
+  size_t textSize = strlen(msg) + 1;
+  size_t bitmapSize;
+  if (PBM_DATA_HORIZONTAL_MSB == BITMAP_ALIGNMENT ||
+      PBM_DATA_HORIZONTAL_LSB == BITMAP_ALIGNMENT) {
+    bitmapSize = (size_t)(((width - 1) / 8 + 1)) * height;
+  } else {
+    bitmapSize = (size_t)(((height - 1) / 8 + 1)) * width;
+  }
+  uint8_t opaque = (PBM_TEXT_OPAQUE == style->mode);
+  size_t size = sizeof(pbm_textCacheEntry) + textSize +
+                (opaque ? 2 * bitmapSize : bitmapSize);
+  if (0 == width || size > budget) {
+    // Validate the arguments, the string is drawn without the cache
+    return PBM_OK;
+  }
+
+  pbm_textCacheEntry *newEntry = malloc(size);
+  if (NULL == newEntry) {
+    return PBM_ERROR;
+  }
+  memset(newEntry, 0, sizeof(*newEntry));
+  newEntry->font = font;
+  newEntry->style = *style;
+  newEntry->hash = hash;
+  newEntry->size = size;
+  memcpy(newEntry->text, msg, textSize);
+
+  uint8_t *bitmaps = (uint8_t *)newEntry->text + textSize;
+  newEntry->ink.width = width;
+  newEntry->ink.height = height;
+  newEntry->ink.alignment = BITMAP_ALIGNMENT;
+  newEntry->ink.data = bitmaps;
+  memset(bitmaps, 0, bitmapSize);
+
+  pbm_return retVal;
+  if (opaque) {
+    // Draw the string on a cleared and on a set bitmap, the pixels changed on
+    // the set bitmap to unset belong to the glyph cells
+    newEntry->background = newEntry->ink;
+    newEntry->background.data = bitmaps + bitmapSize;
+    memset(newEntry->background.data, 0xFF, bitmapSize);
+    retVal = pbm_writeStringStyled(&newEntry->ink, 0, 0, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, style, msg);
+    if (PBM_OK == retVal) {
+      retVal = pbm_writeStringStyled(&newEntry->background, 0, 0, PBM_BLACK,
+                                     font, PBM_STRING_LEFT_TOP, style, msg);
+    }
+    for (size_t i = 0; i < bitmapSize; i++) {
+      newEntry->background.data[i] =
+          (uint8_t) ~(newEntry->ink.data[i] | newEntry->background.data[i]);
+    }
+  } else {
+    retVal = pbm_writeStringStyled(&newEntry->ink, 0, 0, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, style, msg);
+  }
+  if (PBM_OK != retVal) {
+    free(newEntry);
+    return retVal;
+  }
+  *entry = newEntry;
+  return PBM_OK;
+}
+
+static void unlinkEntry(pbm_textCache *cache, pbm_textCacheEntry *entry) {
+  if (NULL != entry->newer) {
+    entry->newer->older = entry->older;
+  } else {
+    cache->newest = entry->older;
+  }
+  if (NULL != entry->older) {
+    entry->older->newer = entry->newer;
+  } else {
+    cache->oldest = entry->newer;
+  }
+  entry->newer = NULL;
+  entry->older = NULL;
+}
+
+static void linkNewest(pbm_textCache *cache, pbm_textCacheEntry *entry) {
+  entry->newer = NULL;
+  entry->older = cache->newest;
+  if (NULL != cache->newest) {
+    cache->newest->newer = entry;
+  } else {
+    cache->oldest = entry;
+  }
+  cache->newest = entry;
+}
+
+static void evictOldest(pbm_textCache *cache) {
+  pbm_textCacheEntry *entry = cache->oldest;
+  pbm_textCacheEntry **link =
+      &cache->buckets[entry->hash % PBM_TEXT_CACHE_BUCKETS];
+  while (*link != entry) {
+    link = &(*link)->next;
+  }
+  *link = entry->next;
+  unlinkEntry(cache, entry);
+  cache->used -= entry->size;
+  cache->entries--;
+  cache->evictions++;
+  free(entry);
+}
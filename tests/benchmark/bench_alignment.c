@@ -0,0 +1,152 @@
+/**
+ * @file bench_alignment.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Timing of the graphics functions with a fixed or dynamic alignment
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+
+#include "pbm_graphics.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (128)        ///< Width of the display image
+#define HEIGHT (64)        ///< Height of the display image
+#define REPETITIONS (2000) ///< Runs of every operation
+
+/**
+ * @brief Operation to time
+ *
+ */
+typedef void (*benchOperation)(pbm_image *image);
+
+/**
+ * @brief Time an operation and print the time of one run
+ *
+ * @param name the name of the operation
+ * @param operation the operation
+ * @param image the image to draw on
+ */
+static void timeOperation(const char *name, benchOperation operation,
+                          pbm_image *image);
+
+/**
+ * @brief Set every pixel of the image one by one
+ *
+ * @param image the image
+ */
+static void setPixels(pbm_image *image);
+
+/**
+ * @brief Draw horizontal, vertical and diagonal lines
+ *
+ * @param image the image
+ */
+static void drawLines(pbm_image *image);
+
+/**
+ * @brief Fill and invert the image
+ *
+ * @param image the image
+ */
+static void fillImage(pbm_image *image);
+
+/**
+ * @brief Write the lines of a text
+ *
+ * @param image the image
+ */
+static void writeText(pbm_image *image);
+
+/**
+ * @brief Scroll the image up by one line
+ *
+ * @param image the image
+ */
+static void scrollImage(pbm_image *image);
+
+static const pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                              .width = 6,
+                              .height = 8,
+                              .alignment = PBM_DATA_HORIZONTAL_MSB};
+
+int main(void) {
+  static uint8_t data[WIDTH * HEIGHT / 8];
+  pbm_image image = {WIDTH, HEIGHT, BENCH_ALIGNMENT, data};
+  timeOperation("setPixel", setPixels, &image);
+  timeOperation("drawLine", drawLines, &image);
+  timeOperation("fill", fillImage, &image);
+  timeOperation("writeString", writeText, &image);
+  timeOperation("scroll", scrollImage, &image);
+  return 0;
+}
+
+static void timeOperation(const char *name, benchOperation operation,
+                          pbm_image *image) {
+  struct timespec start;
+  struct timespec end;
+  // Warm up the caches
+  operation(image);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < REPETITIONS; i++) {
+    operation(image);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double nanoseconds = (end.tv_sec - start.tv_sec) * 1e9 +
+                       (double)(end.tv_nsec - start.tv_nsec);
+  printf("  %-12s %10.0f ns\n", name, nanoseconds / REPETITIONS);
+}
+
+static void setPixels(pbm_image *image) {
+  for (uint32_t y = 0; y < HEIGHT; y++) {
+    for (uint32_t x = 0; x < WIDTH; x++) {
+      pbm_setPixel(image, x, y, (pbm_colors)((x ^ y) & 1));
+    }
+  }
+}
+
+static void drawLines(pbm_image *image) {
+  for (uint32_t i = 0; i < HEIGHT; i++) {
+    pbm_drawLine(image, 0, i, WIDTH - 1, i, (pbm_colors)(i & 1));
+    pbm_drawLine(image, i, 0, i, HEIGHT - 1, (pbm_colors)(i & 1));
+    pbm_drawLine(image, 0, i, WIDTH - 1, HEIGHT - 1 - i, PBM_BLACK);
+  }
+}
+
+static void fillImage(pbm_image *image) {
+  pbm_fill(image, PBM_WHITE);
+  pbm_invertColor(image);
+}
+
+static void writeText(pbm_image *image) {
+  for (uint32_t line = 0; line < HEIGHT / font.height; line++) {
+    pbm_writeString(image, 0, line * font.height, PBM_BLACK, &font,
+                    PBM_STRING_LEFT_TOP, "The quick brown fox jumps");
+  }
+}
+
+static void scrollImage(pbm_image *image) {
+  pbm_rect rect = {0, 0, WIDTH, HEIGHT};
+  pbm_scroll(image, &rect, 0, -1, PBM_WHITE);
+}
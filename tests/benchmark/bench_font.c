@@ -0,0 +1,123 @@
+/**
+ * @file bench_font.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Timing of the text drawing with bitmap and packed fonts
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pbm_graphics.h"
+
+#include "12x20_horizontal_MSB.h"
+#include "32x53_horizontal_MSB.h"
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (256)       ///< Width of the display image
+#define HEIGHT (128)      ///< Height of the display image
+#define GLYPHS (256)      ///< Glyphs of the fonts
+#define REPETITIONS (500) ///< Runs of every operation
+
+static const char text[] = "Packed 0123";
+
+/**
+ * @brief Time the drawing of the text and print the time of one run
+ *
+ * @param name the name of the measurement
+ * @param image the image to draw on
+ * @param font the font
+ * @param style the text style
+ */
+static void timeText(const char *name, pbm_image *image, const pbm_font *font,
+                     const pbm_textStyle *style);
+
+int main(void) {
+  static uint8_t data[WIDTH * HEIGHT / 8];
+  pbm_image image = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, data};
+  const pbm_font fonts[] = {
+      {.fontData = &font_6x8H_MSB[0][0],
+       .width = 6,
+       .height = 8,
+       .alignment = PBM_DATA_HORIZONTAL_MSB},
+      {.fontData = &font_12x20H_MSB[0][0],
+       .width = 12,
+       .height = 20,
+       .alignment = PBM_DATA_HORIZONTAL_MSB},
+      {.fontData = &font_32x53H_MSB[0][0],
+       .width = 32,
+       .height = 53,
+       .alignment = PBM_DATA_HORIZONTAL_MSB}};
+  const pbm_textStyle styles[] = {{.mode = PBM_TEXT_OPAQUE, .scale = 1},
+                                  {.mode = PBM_TEXT_TRANSPARENT, .scale = 1},
+                                  {.mode = PBM_TEXT_OPAQUE, .scale = 2}};
+  const char *styleNames[] = {"opaque", "transparent", "scale 2"};
+  static uint32_t offsets[GLYPHS];
+  static pbm_glyphBox boxes[GLYPHS];
+
+  for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+    uint32_t size = 0;
+    pbm_packFont(&fonts[i], GLYPHS, NULL, &size, NULL, NULL);
+    uint8_t *packed = malloc(size);
+    if (NULL == packed ||
+        PBM_OK != pbm_packFont(&fonts[i], GLYPHS, packed, &size, offsets,
+                               boxes)) {
+      fprintf(stderr, "cannot pack the font\n");
+      return 1;
+    }
+    pbm_font packedFont = fonts[i];
+    packedFont.fontData = packed;
+    packedFont.encoding = PBM_FONT_PACKED;
+    packedFont.glyphOffsets = offsets;
+    packedFont.glyphBoxes = boxes;
+
+    printf("%ux%u\n", fonts[i].width, fonts[i].height);
+    for (size_t j = 0; j < sizeof(styles) / sizeof(styles[0]); j++) {
+      char name[32];
+      snprintf(name, sizeof(name), "bitmap %s", styleNames[j]);
+      timeText(name, &image, &fonts[i], &styles[j]);
+      snprintf(name, sizeof(name), "packed %s", styleNames[j]);
+      timeText(name, &image, &packedFont, &styles[j]);
+    }
+    free(packed);
+  }
+  return 0;
+}
+
+static void timeText(const char *name, pbm_image *image, const pbm_font *font,
+                     const pbm_textStyle *style) {
+  struct timespec start;
+  struct timespec end;
+  // Warm up the caches
+  pbm_writeStringStyled(image, 0, 0, PBM_BLACK, font, PBM_STRING_LEFT_TOP,
+                        style, text);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < REPETITIONS; i++) {
+    pbm_writeStringStyled(image, 0, 0, PBM_BLACK, font, PBM_STRING_LEFT_TOP,
+                          style, text);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double nanoseconds = (end.tv_sec - start.tv_sec) * 1e9 +
+                       (double)(end.tv_nsec - start.tv_nsec);
+  printf("  %-20s %10.0f ns\n", name, nanoseconds / REPETITIONS);
+}
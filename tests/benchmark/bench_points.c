@@ -0,0 +1,126 @@
+/**
+ * @file bench_points.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Timing of single pixels against the batched pixel plotting
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pbm_graphics.h"
+
+#define WIDTH (128)        ///< Width of the display image
+#define HEIGHT (64)        ///< Height of the display image
+#define POINTS (4096)      ///< Points of the point cloud
+#define REPETITIONS (1000) ///< Runs of every operation
+
+/**
+ * @brief Way to plot the point cloud
+ *
+ */
+typedef enum {
+  PLOT_SINGLE = 0, ///< pbm_setPixel for every point
+  PLOT_BATCH,      ///< pbm_setPixels with the points as given
+  PLOT_SORT_BATCH  ///< pbm_sortPoints on a copy and pbm_setPixels
+} plotMode;
+
+/**
+ * @brief Time the plotting of a point cloud and print the time of one run
+ *
+ * @param name the name of the point cloud
+ * @param image the image to draw on
+ * @param points the points
+ * @param mode the way to plot the points
+ */
+static void timePlot(const char *name, pbm_image *image,
+                     const pbm_point *points, plotMode mode);
+
+/**
+ * @brief Plot the point cloud once
+ *
+ * @param image the image to draw on
+ * @param points the points
+ * @param mode the way to plot the points
+ */
+static void plot(pbm_image *image, const pbm_point *points, plotMode mode);
+
+static pbm_point sortedPoints[POINTS];
+
+int main(void) {
+  static uint8_t data[WIDTH * HEIGHT / 8];
+  static pbm_point scattered[POINTS];
+  static pbm_point scanned[POINTS];
+  pbm_image image = {WIDTH, HEIGHT, BENCH_ALIGNMENT, data};
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < POINTS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    scattered[i].x = (seed >> 8) % WIDTH;
+    seed = seed * 1103515245u + 12345u;
+    scattered[i].y = (seed >> 8) % HEIGHT;
+    // Half of the pixels of the image in the byte order
+    scanned[i].x = i / (HEIGHT / 2);
+    scanned[i].y = 2 * (i % (HEIGHT / 2));
+  }
+  const char *modes[] = {"setPixel", "setPixels", "sort+setPixels"};
+  for (int mode = PLOT_SINGLE; mode <= PLOT_SORT_BATCH; mode++) {
+    printf("%s\n", modes[mode]);
+    timePlot("scattered", &image, scattered, (plotMode)mode);
+    timePlot("ordered", &image, scanned, (plotMode)mode);
+  }
+  return 0;
+}
+
+static void timePlot(const char *name, pbm_image *image,
+                     const pbm_point *points, plotMode mode) {
+  struct timespec start;
+  struct timespec end;
+  // Warm up the caches
+  plot(image, points, mode);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < REPETITIONS; i++) {
+    plot(image, points, mode);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double nanoseconds = (end.tv_sec - start.tv_sec) * 1e9 +
+                       (double)(end.tv_nsec - start.tv_nsec);
+  printf("  %-12s %10.0f ns\n", name, nanoseconds / REPETITIONS);
+}
+
+static void plot(pbm_image *image, const pbm_point *points, plotMode mode) {
+  switch (mode) {
+  case PLOT_SINGLE:
+    for (uint32_t i = 0; i < POINTS; i++) {
+      pbm_setPixel(image, points[i].x, points[i].y, PBM_BLACK);
+    }
+    break;
+  case PLOT_BATCH:
+    pbm_setPixels(image, points, POINTS, PBM_BLACK);
+    break;
+  default:
+    memcpy(sortedPoints, points, sizeof(sortedPoints));
+    pbm_sortPoints(image, sortedPoints, POINTS);
+    pbm_setPixels(image, sortedPoints, POINTS, PBM_BLACK);
+    break;
+  }
+}
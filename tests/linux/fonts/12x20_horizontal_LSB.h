@@ -1,4 +1,6 @@
-const unsigned char font_12x20H_LSB[256][40] = {
+#include "pbm_fontHandler.h"
+
+PBM_FONT_DATA font_12x20H_LSB[256][40] = {
     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x00
     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x10, 0x40, 0x20, 0x20, 0x4F, 0x20, 0x4F, 0x20, 0x40, 0xA0, 0x50, 0xA0, 0x50, 0x40, 0x2F, 0x80, 0x10, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x01
     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x1F, 0xC0, 0x3F, 0x60, 0x66, 0x60, 0x66, 0xE0, 0x7F, 0x60, 0x6F, 0x60, 0x6F, 0xC0, 0x30, 0x80, 0x1F, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x02
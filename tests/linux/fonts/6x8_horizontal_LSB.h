@@ -1,4 +1,6 @@
-const unsigned char font_6x8H_LSB[256][8] = {
+#include "pbm_fontHandler.h"
+
+PBM_FONT_DATA font_6x8H_LSB[256][8] = {
     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x00
     {0x70, 0x88, 0xD8, 0x88, 0xA8, 0x88, 0x70, 0x00}, // 0x01
     {0x70, 0xF8, 0xA8, 0xF8, 0x88, 0xF8, 0x70, 0x00}, // 0x02
@@ -1,4 +1,6 @@
-const unsigned char font_6x8H_MSB[256][8] = {
+#include "pbm_fontHandler.h"
+
+PBM_FONT_DATA font_6x8H_MSB[256][8] = {
     {0x02, 0x06, 0x0C, 0x1F, 0x06, 0x0C, 0x08, 0x00}, // 0x00 Charge
     {0xFE, 0x11, 0x1B, 0x11, 0x15, 0x11, 0x0E, 0x00}, // 0x01
     {0x0E, 0x1F, 0x15, 0x1F, 0x11, 0x1F, 0x0E, 0x00}, // 0x02
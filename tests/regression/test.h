@@ -0,0 +1,81 @@
+/**
+ * @file test.h
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Checks of the regression tests
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PBM_TEST_H
+#define PBM_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pbm_types.h"
+
+/**
+ * @brief Number of failed checks of the test program
+ *
+ */
+static int testFailures;
+
+/**
+ * @brief Check a condition and report the line of a failure
+ *
+ */
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);    \
+      testFailures++;                                                          \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Report the result, the exit code of the test program
+ *
+ */
+#define TEST_RESULT(name)                                                      \
+  (printf("%s: %s\n", (name), (0 == testFailures) ? "passed" : "FAILED"),      \
+   (0 == testFailures) ? 0 : 1)
+
+/**
+ * @brief Read a pixel of an image in any alignment
+ *
+ * @param image the image
+ * @param x position in x
+ * @param y position in y
+ * @return int 1 for a black pixel
+ */
+static inline int testPixel(const pbm_image *image, uint32_t x, uint32_t y) {
+  size_t lineBytes = ((size_t)image->width + 7) / 8;
+  switch (image->alignment) {
+  case PBM_DATA_HORIZONTAL_MSB:
+    return (image->data[y * lineBytes + x / 8] >> (7 - x % 8)) & 1;
+  case PBM_DATA_HORIZONTAL_LSB:
+    return (image->data[y * lineBytes + x / 8] >> (x % 8)) & 1;
+  case PBM_DATA_VERTICAL_MSB:
+    return (image->data[(size_t)(y / 8) * image->width + x] >> (7 - y % 8)) &
+           1;
+  default:
+    return (image->data[(size_t)(y / 8) * image->width + x] >> (y % 8)) & 1;
+  }
+}
+
+#endif /* PBM_TEST_H */
@@ -0,0 +1,223 @@
+/**
+ * @file test_batch.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the batch backends
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pbm_batch.h"
+#include "pbm_graphics.h"
+#include "test.h"
+
+#define IMAGES (32)    ///< Images saved and loaded by every backend
+#define DEPTH (8)      ///< Requests in flight
+#define PATH_SIZE (32) ///< Bytes of an image path
+
+/**
+ * @brief Images with their paths
+ *
+ */
+typedef struct {
+  pbm_image images[IMAGES];      ///< Saved images
+  char paths[IMAGES][PATH_SIZE]; ///< Paths of the images
+} imageSet;
+
+/**
+ * @brief Create images of different sizes with a pattern
+ *
+ * @param set the created images
+ * @return int 1 on success
+ */
+static int createImages(imageSet *set);
+
+/**
+ * @brief Submit requests and wait for all of them
+ *
+ * @param batch the opened batch
+ * @param requests the requests
+ * @param count the number of requests
+ * @return size_t the number of completed requests
+ */
+static size_t runBatch(pbm_batch *batch, pbm_batchRequest *requests,
+                       size_t count);
+
+/**
+ * @brief Save and load the images with a backend
+ *
+ * @param set the images
+ * @param backend the batch backend
+ * @param format the saved format
+ */
+static void checkBackend(const imageSet *set, pbm_batchBackend backend,
+                         pbm_format format);
+
+/**
+ * @brief Count the threads of the process
+ *
+ * @return uint32_t the number of threads, 0 if unknown
+ */
+static uint32_t threadCount(void);
+
+/**
+ * @brief Load the images with a batch deeper than the thread pool
+ *
+ * @param set the saved images
+ */
+static void checkDeepPool(const imageSet *set);
+
+int main(void) {
+  imageSet set;
+  CHECK(createImages(&set));
+  const pbm_batchBackend backends[] = {PBM_BATCH_THREADS, PBM_BATCH_URING};
+  for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+    checkBackend(&set, backends[i], PBM_FORMAT_BINARY);
+    checkBackend(&set, backends[i], PBM_FORMAT_PLAIN);
+  }
+  checkDeepPool(&set);
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    free(set.images[i].data);
+    remove(set.paths[i]);
+  }
+  return TEST_RESULT("batch");
+}
+
+static int createImages(imageSet *set) {
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    uint32_t width = 1 + 37 * i;
+    uint32_t height = 1 + 13 * i;
+    pbm_image *image = &set->images[i];
+    *image = (pbm_image){width, height, PBM_DATA_HORIZONTAL_MSB, NULL};
+    image->data = calloc((width + 7) / 8, height);
+    if (NULL == image->data) {
+      return 0;
+    }
+    pbm_drawLine(image, 0, 0, PBM_IMAGE_END, PBM_IMAGE_END, PBM_BLACK);
+    pbm_drawLine(image, 0, PBM_IMAGE_END, PBM_IMAGE_END, 0, PBM_BLACK);
+    pbm_setPixel(image, i % width, 0, PBM_BLACK);
+    snprintf(set->paths[i], PATH_SIZE, "batch%02u.pbm", (unsigned)i);
+  }
+  return 1;
+}
+
+static size_t runBatch(pbm_batch *batch, pbm_batchRequest *requests,
+                       size_t count) {
+  if (PBM_OK != pbm_submitBatch(batch, requests, count)) {
+    return 0;
+  }
+  size_t completed = 0;
+  for (;;) {
+    pbm_batchRequest *done[DEPTH];
+    size_t doneCount = 0;
+    if (PBM_OK != pbm_waitBatch(batch, done, DEPTH, &doneCount) ||
+        0 == doneCount) {
+      return completed;
+    }
+    completed += doneCount;
+  }
+}
+
+static void checkBackend(const imageSet *set, pbm_batchBackend backend,
+                         pbm_format format) {
+  pbm_batch batch;
+  if (PBM_OK != pbm_openBatch(&batch, DEPTH, backend)) {
+    // io_uring may be disabled in the kernel or the build
+    CHECK(PBM_BATCH_URING == backend);
+    printf("batch: backend %d not available, skipped\n", (int)backend);
+    return;
+  }
+  pbm_batchRequest requests[IMAGES + 1];
+  memset(requests, 0, sizeof(requests));
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    requests[i].operation = PBM_BATCH_SAVE;
+    requests[i].path = set->paths[i];
+    requests[i].image = set->images[i];
+    requests[i].format = format;
+    requests[i].result = PBM_ERROR;
+  }
+  CHECK(IMAGES == runBatch(&batch, requests, IMAGES));
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    CHECK(PBM_OK == requests[i].result);
+  }
+
+  memset(requests, 0, sizeof(requests));
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    requests[i].operation = PBM_BATCH_LOAD;
+    requests[i].path = set->paths[i];
+    requests[i].result = PBM_ERROR;
+  }
+  // A missing file completes with an error
+  requests[IMAGES].operation = PBM_BATCH_LOAD;
+  requests[IMAGES].path = "missing.pbm";
+  CHECK(IMAGES + 1 == runBatch(&batch, requests, IMAGES + 1));
+  CHECK(PBM_OK != requests[IMAGES].result);
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    const pbm_image *saved = &set->images[i];
+    pbm_image *loaded = &requests[i].image;
+    CHECK(PBM_OK == requests[i].result);
+    if (PBM_OK != requests[i].result) {
+      continue;
+    }
+    CHECK(saved->width == loaded->width && saved->height == loaded->height);
+    CHECK(0 == memcmp(saved->data, loaded->data,
+                      (saved->width + 7) / 8 * saved->height));
+    free(loaded->data);
+  }
+  pbm_closeBatch(&batch);
+}
+
+static uint32_t threadCount(void) {
+  FILE *status = fopen("/proc/self/status", "r");
+  if (NULL == status) {
+    return 0;
+  }
+  char line[128];
+  unsigned count = 0;
+  while (NULL != fgets(line, sizeof(line), status) &&
+         1 != sscanf(line, "Threads: %u", &count)) {
+  }
+  fclose(status);
+  return count;
+}
+
+static void checkDeepPool(const imageSet *set) {
+  uint32_t threadsBefore = threadCount();
+  pbm_batch batch;
+  CHECK(PBM_OK == pbm_openBatch(&batch, 4096, PBM_BATCH_THREADS));
+  CHECK(4096 == batch.depth);
+  // The pool is not as deep as the batch
+  CHECK(threadCount() <= threadsBefore + PBM_BATCH_MAX_THREADS);
+
+  pbm_batchRequest requests[IMAGES];
+  memset(requests, 0, sizeof(requests));
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    requests[i].operation = PBM_BATCH_LOAD;
+    requests[i].path = set->paths[i];
+  }
+  CHECK(IMAGES == runBatch(&batch, requests, IMAGES));
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    CHECK(PBM_OK == requests[i].result);
+    CHECK(set->images[i].width == requests[i].image.width);
+    free(requests[i].image.data);
+  }
+  pbm_closeBatch(&batch);
+}
@@ -0,0 +1,250 @@
+/**
+ * @file test_codec.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the memory, FILE and file descriptor codecs
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pbm_io.h"
+#include "test.h"
+
+#define MAX_DATA (64 * 1024) ///< Maximum encoded size of the test images
+
+/**
+ * @brief Size of a test image
+ *
+ */
+typedef struct {
+  uint32_t width;  ///< Width of the image
+  uint32_t height; ///< Height of the image
+} imageSize;
+
+/**
+ * @brief Create a random image in the PBM_DATA_HORIZONTAL_MSB alignment
+ *
+ * @param image the image, the data is allocated
+ * @param size the size of the image
+ */
+static void createImage(pbm_image *image, imageSize size);
+
+/**
+ * @brief Compare all pixels of two images
+ *
+ * @param image the decoded image
+ * @param expected the original image
+ * @return int 1 if the images are equal
+ */
+static int sameImage(const pbm_image *image, const pbm_image *expected);
+
+/**
+ * @brief Round trip two images through a memory buffer
+ *
+ * @param first the first image
+ * @param second the second image, encoded behind the first one
+ * @param format the encoded format
+ */
+static void checkMemory(const pbm_image *first, const pbm_image *second,
+                        pbm_format format);
+
+/**
+ * @brief Round trip two images through a FILE stream
+ *
+ * @param first the first image
+ * @param second the second image, encoded behind the first one
+ * @param format the encoded format
+ */
+static void checkFile(const pbm_image *first, const pbm_image *second,
+                      pbm_format format);
+
+/**
+ * @brief Round trip two images through a pipe
+ *
+ * @param first the first image
+ * @param second the second image, encoded behind the first one
+ * @param format the encoded format
+ */
+static void checkFd(const pbm_image *first, const pbm_image *second,
+                    pbm_format format);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  const imageSize sizes[] = {{1, 1}, {7, 3}, {8, 8}, {37, 29}, {64, 2},
+                             {100, 17}};
+  const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+  for (size_t i = 0; i < count; i++) {
+    pbm_image first;
+    pbm_image second;
+    createImage(&first, sizes[i]);
+    createImage(&second, sizes[(i + 1) % count]);
+    for (pbm_format format = PBM_FORMAT_BINARY; format <= PBM_FORMAT_PLAIN;
+         format++) {
+      checkMemory(&first, &second, format);
+      checkFile(&first, &second, format);
+      checkFd(&first, &second, format);
+    }
+    free(first.data);
+    free(second.data);
+  }
+
+  // Only horizontal MSB images are encoded
+  uint8_t data[8] = {0};
+  uint8_t buffer[64];
+  size_t size = sizeof(buffer);
+  pbm_image image = {8, 8, PBM_DATA_VERTICAL_MSB, data};
+  CHECK(PBM_ARGUMENTS == pbm_encodeToMemory(&image, buffer, &size));
+  CHECK(PBM_ARGUMENTS == pbm_encodeToFd(-1, &image));
+  image.alignment = PBM_DATA_HORIZONTAL_MSB;
+  CHECK(PBM_ARGUMENTS == pbm_encodeToMemoryFormat(&image, PBM_FORMAT_GRAY,
+                                                  buffer, &size));
+  // Invalid headers leave the image unchanged
+  const char *invalid[] = {"P7\n1 1\n", "P4\n0 1\n", "P4\n1\n", "P4 -1 1 ",
+                           "P4\n2 2\n\x01", "P1\n2 1\n0 2"};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    CHECK(PBM_OK != pbm_decodeFromMemory((const uint8_t *)invalid[i],
+                                         strlen(invalid[i]), &image,
+                                         PBM_DECODE_COPY, NULL));
+    CHECK(data == image.data && 8 == image.width);
+  }
+  return TEST_RESULT("codec");
+}
+
+static void createImage(pbm_image *image, imageSize size) {
+  size_t bytes = ((size_t)size.width + 7) / 8 * size.height;
+  image->width = size.width;
+  image->height = size.height;
+  image->alignment = PBM_DATA_HORIZONTAL_MSB;
+  image->data = (uint8_t *)malloc(bytes);
+  for (size_t i = 0; i < bytes; i++) {
+    seed = seed * 1103515245u + 12345u;
+    image->data[i] = (uint8_t)(seed >> 16);
+  }
+}
+
+static int sameImage(const pbm_image *image, const pbm_image *expected) {
+  if (image->width != expected->width || image->height != expected->height ||
+      PBM_DATA_HORIZONTAL_MSB != image->alignment) {
+    return 0;
+  }
+  for (uint32_t y = 0; y < image->height; y++) {
+    for (uint32_t x = 0; x < image->width; x++) {
+      if (testPixel(image, x, y) != testPixel(expected, x, y)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+static void checkMemory(const pbm_image *first, const pbm_image *second,
+                        pbm_format format) {
+  static uint8_t buffer[MAX_DATA];
+  // The size query and a too small buffer write nothing
+  size_t firstSize = 0;
+  CHECK(PBM_SIZE ==
+        pbm_encodeToMemoryFormat(first, format, NULL, &firstSize));
+  CHECK(firstSize > 0 && firstSize < MAX_DATA / 2);
+  size_t size = firstSize - 1;
+  memset(buffer, 0xA5, sizeof(buffer));
+  CHECK(PBM_SIZE == pbm_encodeToMemoryFormat(first, format, buffer, &size));
+  CHECK(firstSize == size && 0xA5 == buffer[0]);
+
+  CHECK(PBM_OK == pbm_encodeToMemoryFormat(first, format, buffer, &size));
+  CHECK(firstSize == size);
+  size_t secondSize = MAX_DATA - firstSize;
+  CHECK(PBM_OK == pbm_encodeToMemoryFormat(second, format, &buffer[firstSize],
+                                           &secondSize));
+
+  // Decode both images one after the other
+  pbm_image image;
+  size_t used = 0;
+  CHECK(PBM_OK == pbm_decodeFromMemory(buffer, firstSize + secondSize, &image,
+                                       PBM_DECODE_COPY, &used));
+  CHECK(used <= firstSize && sameImage(&image, first));
+  free(image.data);
+  size_t rest = firstSize + secondSize - used;
+  if (PBM_FORMAT_BINARY == format) {
+    // The aliased data is the raster in the buffer
+    CHECK(PBM_OK == pbm_decodeFromMemory(&buffer[used], rest, &image,
+                                         PBM_DECODE_ALIAS, NULL));
+    CHECK(sameImage(&image, second));
+    CHECK(image.data > &buffer[used] && image.data < &buffer[used + rest]);
+  } else {
+    CHECK(PBM_ARGUMENTS == pbm_decodeFromMemory(&buffer[used], rest, &image,
+                                                PBM_DECODE_ALIAS, NULL));
+  }
+  CHECK(PBM_OK == pbm_decodeFromMemory(&buffer[used], rest, &image,
+                                       PBM_DECODE_COPY, NULL));
+  CHECK(sameImage(&image, second));
+  free(image.data);
+
+  // A truncated image is an error
+  image.data = NULL;
+  CHECK(PBM_ERROR == pbm_decodeFromMemory(buffer, firstSize - 2, &image,
+                                          PBM_DECODE_COPY, NULL));
+  CHECK(NULL == image.data);
+}
+
+static void checkFile(const pbm_image *first, const pbm_image *second,
+                      pbm_format format) {
+  FILE *file = tmpfile();
+  CHECK(NULL != file);
+  if (NULL == file) {
+    return;
+  }
+  CHECK(PBM_OK == pbm_encodeToFileFormat(file, first, format));
+  CHECK(PBM_OK == pbm_encodeToFileFormat(file, second, format));
+  long end = ftell(file);
+  rewind(file);
+  pbm_image image;
+  CHECK(PBM_OK == pbm_decodeFromFile(file, &image));
+  CHECK(sameImage(&image, first));
+  free(image.data);
+  CHECK(PBM_OK == pbm_decodeFromFile(file, &image));
+  CHECK(sameImage(&image, second));
+  free(image.data);
+  // Only the closing whitespace is left
+  CHECK(end - ftell(file) <= 1);
+  CHECK(PBM_OK != pbm_decodeFromFile(file, &image));
+  fclose(file);
+}
+
+static void checkFd(const pbm_image *first, const pbm_image *second,
+                    pbm_format format) {
+  int fds[2];
+  CHECK(0 == pipe(fds));
+  // The encoded images fit into the pipe buffer
+  CHECK(PBM_OK == pbm_encodeToFdFormat(fds[1], first, format));
+  CHECK(PBM_OK == pbm_encodeToFdFormat(fds[1], second, format));
+  close(fds[1]);
+  pbm_image image;
+  CHECK(PBM_OK == pbm_decodeFromFd(fds[0], &image));
+  CHECK(sameImage(&image, first));
+  free(image.data);
+  CHECK(PBM_OK == pbm_decodeFromFd(fds[0], &image));
+  CHECK(sameImage(&image, second));
+  free(image.data);
+  CHECK(PBM_ERROR == pbm_decodeFromFd(fds[0], &image));
+  close(fds[0]);
+}
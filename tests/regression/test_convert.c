@@ -0,0 +1,84 @@
+/**
+ * @file test_convert.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the color to bitmap conversion
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pbm_io.h"
+#include "test.h"
+
+#define MAX_WIDTH (100) ///< Maximum width of the test images
+#define HEIGHT (3)      ///< Height of the test images
+#define MAX_DATA (32 + MAX_WIDTH * HEIGHT * 3)
+
+/**
+ * @brief Convert a random P6 image and compare it with the scalar luma
+ *
+ * The rows of 32 pixels use the SSE2 path, the rest of a row the scalar loop.
+ *
+ * @param width width of the image
+ * @param threshold brightness of the first white pixel
+ */
+static void checkColor(uint32_t width, uint8_t threshold);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  const uint32_t widths[] = {1, 31, 32, 33, 64, 95, MAX_WIDTH};
+  for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+    checkColor(widths[i], 128);
+    checkColor(widths[i], 1);
+    checkColor(widths[i], 255);
+  }
+  return TEST_RESULT("convert");
+}
+
+static void checkColor(uint32_t width, uint8_t threshold) {
+  static uint8_t buffer[MAX_DATA];
+  size_t header = (size_t)sprintf((char *)buffer, "P6\n%u %u\n255\n", width,
+                                  HEIGHT);
+  const size_t samples = (size_t)width * HEIGHT * 3;
+  for (size_t i = 0; i < samples; i++) {
+    seed = seed * 1103515245u + 12345u;
+    buffer[header + i] = (uint8_t)(seed >> 16);
+  }
+  // Saturated samples at both ends of the weights
+  for (size_t i = 0; i < 6 && i < samples; i++) {
+    buffer[header + i] = (i < 3) ? 0xFF : 0x00;
+  }
+
+  pbm_conversion conversion = {PBM_CONVERT_THRESHOLD, threshold};
+  pbm_image image;
+  CHECK(PBM_OK == pbm_decodeFromMemoryConverted(buffer, header + samples,
+                                                &image, &conversion, NULL));
+  uint32_t errors = 0;
+  for (uint32_t y = 0; y < HEIGHT; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      const uint8_t *rgb = &buffer[header + ((size_t)y * width + x) * 3];
+      uint32_t luma = (77u * rgb[0] + 150u * rgb[1] + 29u * rgb[2] + 128) >> 8;
+      errors += ((luma < threshold) != testPixel(&image, x, y));
+    }
+  }
+  CHECK(0 == errors);
+  free(image.data);
+}
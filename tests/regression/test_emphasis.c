@@ -0,0 +1,149 @@
+/**
+ * @file test_emphasis.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the emphasized text
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "12x20_horizontal_MSB.h"
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256)     ///< Glyphs of the test fonts
+#define MAX_ROW_BYTES (2) ///< Bytes of a line of the largest test glyph
+#define MAX_HEIGHT (20)   ///< Lines of the largest test glyph
+
+/**
+ * @brief Draw a glyph into an empty image of the glyph cell
+ *
+ * @param font the font
+ * @param emphasis the emphasis flags
+ * @param character the character
+ * @param data the image buffer of the glyph cell
+ */
+static void drawGlyph(const pbm_font *font, uint8_t emphasis,
+                      uint8_t character, uint8_t *data);
+
+/**
+ * @brief Count the set pixels of a line of the glyph cell
+ *
+ * @param font the font
+ * @param data the image buffer of the glyph cell
+ * @param line the line
+ * @return uint32_t number of set pixels
+ */
+static uint32_t lineInk(const pbm_font *font, const uint8_t *data,
+                        uint32_t line);
+
+/**
+ * @brief Find the first set pixel of a line of the glyph cell
+ *
+ * @param font the font
+ * @param data the image buffer of the glyph cell
+ * @param line the line
+ * @return uint32_t the first set column, the width for an empty line
+ */
+static uint32_t firstColumn(const pbm_font *font, const uint8_t *data,
+                            uint32_t line);
+
+/**
+ * @brief Check italic glyphs keep every pixel and are slanted
+ *
+ * @param font the font
+ */
+static void checkItalic(const pbm_font *font);
+
+int main(void) {
+  const pbm_font fonts[] = {
+      {.fontData = &font_6x8H_MSB[0][0],
+       .width = 6,
+       .height = 8,
+       .alignment = PBM_DATA_HORIZONTAL_MSB},
+      {.fontData = &font_12x20H_MSB[0][0],
+       .width = 12,
+       .height = 20,
+       .alignment = PBM_DATA_HORIZONTAL_MSB}};
+
+  for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+    checkItalic(&fonts[i]);
+  }
+  return TEST_RESULT("emphasis");
+}
+
+static void drawGlyph(const pbm_font *font, uint8_t emphasis,
+                      uint8_t character, uint8_t *data) {
+  pbm_image image = {font->width, font->height, PBM_DATA_HORIZONTAL_MSB,
+                     data};
+  pbm_textStyle style;
+  memset(&style, 0, sizeof(style));
+  style.emphasis = emphasis;
+  pbm_fill(&image, PBM_WHITE);
+  pbm_writeCharStyled(&image, 0, 0, PBM_BLACK, font, &style, character);
+}
+
+static uint32_t lineInk(const pbm_font *font, const uint8_t *data,
+                        uint32_t line) {
+  uint32_t rowBytes = (font->width + 7) / 8;
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < font->width; i++) {
+    count += (0 != (data[line * rowBytes + i / 8] & (0x80 >> (i % 8))));
+  }
+  return count;
+}
+
+static void checkItalic(const pbm_font *font) {
+  uint8_t regular[MAX_ROW_BYTES * MAX_HEIGHT];
+  uint8_t italic[MAX_ROW_BYTES * MAX_HEIGHT];
+  uint32_t lostInk = 0;
+  for (uint32_t glyph = 0; glyph < GLYPHS; glyph++) {
+    drawGlyph(font, 0, (uint8_t)glyph, regular);
+    drawGlyph(font, PBM_TEXT_ITALIC, (uint8_t)glyph, italic);
+    for (uint32_t line = 0; line < font->height; line++) {
+      lostInk += (lineInk(font, regular, line) != lineInk(font, italic, line));
+    }
+  }
+  CHECK(0 == lostInk);
+
+  // The top of a vertical bar leans to the right of its bottom
+  drawGlyph(font, PBM_TEXT_ITALIC, '|', italic);
+  uint32_t top = 0;
+  while (top < font->height && 0 == lineInk(font, italic, top)) {
+    top++;
+  }
+  uint32_t bottom = font->height - 1;
+  while (bottom > top && 0 == lineInk(font, italic, bottom)) {
+    bottom--;
+  }
+  CHECK(firstColumn(font, italic, top) > firstColumn(font, italic, bottom));
+}
+
+static uint32_t firstColumn(const pbm_font *font, const uint8_t *data,
+                            uint32_t line) {
+  uint32_t rowBytes = (font->width + 7) / 8;
+  uint32_t column = 0;
+  while (column < font->width &&
+         0 == (data[line * rowBytes + column / 8] & (0x80 >> (column % 8)))) {
+    column++;
+  }
+  return column;
+}
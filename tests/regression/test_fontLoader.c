@@ -0,0 +1,179 @@
+/**
+ * @file test_fontLoader.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the PSF and BDF font loader
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pbm_fontLoader.h"
+#include "pbm_graphics.h"
+#include "test.h"
+
+#define PSF_GLYPHS (128) ///< Glyphs of the short PSF2 font
+#define PSF_HEIGHT (16)  ///< Rows of the PSF2 glyphs
+
+/**
+ * @brief Glyphs of a BDF font with the origin two columns inside the cell
+ *
+ * Glyph 'a' has two columns of ink at the origin, glyph 'b' fills its cell
+ * from the origin and glyph 'c' has less device width than ink.
+ */
+static const char bdfFont[] = "STARTFONT 2.1\n"
+                              "FONT test\n"
+                              "SIZE 8 75 75\n"
+                              "FONTBOUNDINGBOX 8 8 -2 0\n"
+                              "CHARS 3\n"
+                              "STARTCHAR a\n"
+                              "ENCODING 97\n"
+                              "DWIDTH 6 0\n"
+                              "BBX 2 8 0 0\n"
+                              "BITMAP\n"
+                              "C0\nC0\nC0\nC0\nC0\nC0\nC0\nC0\n"
+                              "ENDCHAR\n"
+                              "STARTCHAR b\n"
+                              "ENCODING 98\n"
+                              "DWIDTH 6 0\n"
+                              "BBX 8 8 0 0\n"
+                              "BITMAP\n"
+                              "FF\nFF\nFF\nFF\nFF\nFF\nFF\nFF\n"
+                              "ENDCHAR\n"
+                              "STARTCHAR c\n"
+                              "ENCODING 99\n"
+                              "DWIDTH 4 0\n"
+                              "BBX 8 8 0 0\n"
+                              "BITMAP\n"
+                              "FF\nFF\nFF\nFF\nFF\nFF\nFF\nFF\n"
+                              "ENDCHAR\n"
+                              "ENDFONT\n";
+
+/**
+ * @brief Write a PSF2 font of 8x16 glyphs without a unicode table
+ *
+ * @param path the path of the font
+ * @return int 1 on success
+ */
+static int writePSF(const char *path);
+
+/**
+ * @brief Store a 32 bit value as little endian
+ *
+ * @param value the value
+ * @param bytes the four bytes
+ */
+static void storeLittleEndian(uint32_t value, uint8_t *bytes);
+
+/**
+ * @brief Check a short PSF2 font is padded to 256 glyphs
+ *
+ */
+static void checkShortPSF(void);
+
+/**
+ * @brief Check the ink widths of BDF glyphs with a negative cell offset
+ *
+ */
+static void checkBDFInk(void);
+
+int main(void) {
+  checkShortPSF();
+  checkBDFInk();
+  return TEST_RESULT("fontLoader");
+}
+
+static int writePSF(const char *path) {
+  uint8_t header[32] = {0x72, 0xB5, 0x4A, 0x86};
+  storeLittleEndian(32, &header[8]);
+  storeLittleEndian(PSF_GLYPHS, &header[16]);
+  storeLittleEndian(PSF_HEIGHT, &header[20]);
+  storeLittleEndian(PSF_HEIGHT, &header[24]);
+  storeLittleEndian(8, &header[28]);
+  FILE *file = fopen(path, "wb");
+  if (NULL == file) {
+    return 0;
+  }
+  int written = (1 == fwrite(header, sizeof(header), 1, file));
+  uint8_t glyph[PSF_HEIGHT];
+  memset(glyph, 0xFF, sizeof(glyph));
+  for (uint32_t i = 0; i < PSF_GLYPHS; i++) {
+    written &= (1 == fwrite(glyph, sizeof(glyph), 1, file));
+  }
+  return (0 == fclose(file)) && written;
+}
+
+static void storeLittleEndian(uint32_t value, uint8_t *bytes) {
+  for (int i = 0; i < 4; i++) {
+    bytes[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static void checkShortPSF(void) {
+  CHECK(writePSF("short.psf"));
+  const pbm_data_alignment alignments[] = {PBM_DATA_HORIZONTAL_MSB,
+                                           PBM_DATA_HORIZONTAL_LSB};
+  for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+    pbm_loadedFont loaded;
+    CHECK(PBM_OK == pbm_loadFontPSF("short.psf", alignments[i], &loaded));
+    CHECK(NULL == loaded.font.glyphMap);
+
+    uint8_t white[PSF_HEIGHT];
+    uint8_t data[PSF_HEIGHT];
+    pbm_image image = {8, PSF_HEIGHT, PBM_DATA_HORIZONTAL_MSB, white};
+    pbm_fill(&image, PBM_WHITE);
+    image.data = data;
+    // Glyphs within the file are drawn, the padded glyphs are empty
+    pbm_fill(&image, PBM_WHITE);
+    pbm_writeChar(&image, 0, 0, PBM_BLACK, &loaded.font, PSF_GLYPHS - 1);
+    CHECK(0 != memcmp(data, white, sizeof(data)));
+    pbm_fill(&image, PBM_WHITE);
+    pbm_writeChar(&image, 0, 0, PBM_BLACK, &loaded.font, 0xFF);
+    CHECK(0 == memcmp(data, white, sizeof(data)));
+    pbm_unloadFont(&loaded);
+  }
+  remove("short.psf");
+}
+
+static void checkBDFInk(void) {
+  FILE *file = fopen("origin.bdf", "w");
+  CHECK(NULL != file);
+  if (NULL == file) {
+    return;
+  }
+  fputs(bdfFont, file);
+  fclose(file);
+
+  pbm_loadedFont loaded;
+  CHECK(PBM_OK ==
+        pbm_loadFontBDF("origin.bdf", PBM_DATA_HORIZONTAL_MSB, &loaded));
+  const pbm_glyphMetrics *metrics = loaded.font.metrics;
+  CHECK(NULL != metrics);
+  if (NULL != metrics) {
+    CHECK(2 == metrics['a'].leftBearing);
+    CHECK(2 == metrics['a'].inkWidth);
+    CHECK(6 == metrics['a'].advance);
+    CHECK(6 == metrics['b'].inkWidth);
+    CHECK(6 == metrics['b'].advance);
+    CHECK(4 == metrics['c'].inkWidth);
+    CHECK(4 == metrics['c'].advance);
+  }
+  pbm_unloadFont(&loaded);
+  remove("origin.bdf");
+}
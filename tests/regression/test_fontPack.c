@@ -0,0 +1,163 @@
+/**
+ * @file test_fontPack.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the packed fonts
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "12x20_horizontal_MSB.h"
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256) ///< Glyphs of the test fonts
+
+/**
+ * @brief Pack a font into a buffer filled with a pattern
+ *
+ * @param font the bitmap font
+ * @param pattern the byte filling the buffer before packing
+ * @param size the packed size
+ * @return uint8_t* the packed data, free it after use
+ */
+static uint8_t *packWithPattern(const pbm_font *font, uint8_t pattern,
+                                uint32_t *size);
+
+/**
+ * @brief Compare every glyph of a packed font with the bitmap font in
+ * several styles and rotated
+ *
+ * @param font the bitmap font
+ * @param packed the packed data
+ */
+static void checkGlyphs(const pbm_font *font, const uint8_t *packed);
+
+static uint32_t offsets[GLYPHS];
+static pbm_glyphBox boxes[GLYPHS];
+
+int main(void) {
+  const pbm_font fonts[] = {
+      {.fontData = &font_6x8H_MSB[0][0],
+       .width = 6,
+       .height = 8,
+       .alignment = PBM_DATA_HORIZONTAL_MSB},
+      {.fontData = &font_12x20H_MSB[0][0],
+       .width = 12,
+       .height = 20,
+       .alignment = PBM_DATA_HORIZONTAL_MSB}};
+
+  for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+    // The padding bits must not depend on the previous buffer content
+    uint32_t clearedSize;
+    uint32_t filledSize;
+    uint8_t *cleared = packWithPattern(&fonts[i], 0x00, &clearedSize);
+    uint8_t *filled = packWithPattern(&fonts[i], 0xA5, &filledSize);
+    CHECK(NULL != cleared && NULL != filled);
+    if (NULL == cleared || NULL == filled) {
+      return TEST_RESULT("fontPack");
+    }
+    CHECK(clearedSize == filledSize);
+    CHECK(0 == memcmp(cleared, filled, clearedSize));
+    if (6 == fonts[i].width) {
+      CHECK(981 == clearedSize);
+    }
+    checkGlyphs(&fonts[i], cleared);
+    free(cleared);
+    free(filled);
+  }
+  return TEST_RESULT("fontPack");
+}
+
+static uint8_t *packWithPattern(const pbm_font *font, uint8_t pattern,
+                                uint32_t *size) {
+  *size = 0;
+  if (PBM_OK != pbm_packFont(font, GLYPHS, NULL, size, NULL, NULL)) {
+    return NULL;
+  }
+  uint8_t *data = (uint8_t *)malloc(*size);
+  if (NULL == data) {
+    return NULL;
+  }
+  memset(data, pattern, *size);
+  if (PBM_OK != pbm_packFont(font, GLYPHS, data, size, offsets, boxes)) {
+    free(data);
+    return NULL;
+  }
+  return data;
+}
+
+static void checkGlyphs(const pbm_font *font, const uint8_t *packed) {
+  pbm_font packedFont = *font;
+  packedFont.fontData = packed;
+  packedFont.encoding = PBM_FONT_PACKED;
+  packedFont.glyphOffsets = offsets;
+  packedFont.glyphBoxes = boxes;
+
+  // Plain glyphs, emphasized glyphs decoded line by line and scaled glyphs
+  const pbm_textStyle styles[] = {
+      {.mode = PBM_TEXT_OPAQUE, .scale = 1},
+      {.mode = PBM_TEXT_OPAQUE,
+       .scale = 1,
+       .emphasis = PBM_TEXT_BOLD | PBM_TEXT_ITALIC},
+      {.mode = PBM_TEXT_TRANSPARENT, .scale = 2, .smooth = 1},
+      {.mode = PBM_TEXT_OPAQUE, .scale = 3}};
+  uint8_t expectedData[5 * 60];
+  uint8_t packedData[5 * 60];
+  for (size_t i = 0; i < sizeof(styles) / sizeof(styles[0]); i++) {
+    uint32_t width = font->width * styles[i].scale;
+    uint32_t height = font->height * styles[i].scale;
+    pbm_image expected = {width, height, PBM_DATA_HORIZONTAL_MSB,
+                          expectedData};
+    pbm_image drawn = {width, height, PBM_DATA_HORIZONTAL_MSB, packedData};
+    size_t size = (size_t)(width + 7) / 8 * height;
+    uint32_t differences = 0;
+    for (uint32_t glyph = 0; glyph < GLYPHS; glyph++) {
+      pbm_fill(&expected, PBM_WHITE);
+      pbm_fill(&drawn, PBM_WHITE);
+      pbm_writeCharStyled(&expected, 0, 0, PBM_BLACK, font, &styles[i],
+                          (uint8_t)glyph);
+      pbm_writeCharStyled(&drawn, 0, 0, PBM_BLACK, &packedFont, &styles[i],
+                          (uint8_t)glyph);
+      differences += (0 != memcmp(expectedData, packedData, size));
+    }
+    CHECK(0 == differences);
+  }
+
+  // The rotation reads all lines of the packed glyphs in order
+  uint32_t rotatedSize = 0;
+  CHECK(PBM_OK == pbm_rotateFont(font, GLYPHS, PBM_ROTATE_90, NULL,
+                                 &rotatedSize, NULL));
+  uint8_t *expectedRotation = (uint8_t *)malloc(rotatedSize);
+  uint8_t *packedRotation = (uint8_t *)malloc(rotatedSize);
+  if (NULL != expectedRotation && NULL != packedRotation) {
+    pbm_font rotated;
+    uint32_t size = rotatedSize;
+    CHECK(PBM_OK == pbm_rotateFont(font, GLYPHS, PBM_ROTATE_90,
+                                   expectedRotation, &size, &rotated));
+    CHECK(PBM_OK == pbm_rotateFont(&packedFont, GLYPHS, PBM_ROTATE_90,
+                                   packedRotation, &size, &rotated));
+    CHECK(0 == memcmp(expectedRotation, packedRotation, rotatedSize));
+  }
+  free(expectedRotation);
+  free(packedRotation);
+}
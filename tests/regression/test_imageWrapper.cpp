@@ -0,0 +1,184 @@
+/**
+ * @file test_imageWrapper.cpp
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the C++ image wrapper against the C functions
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+#include <utility>
+
+#include "pbm.hpp"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (37)       ///< Width of the test images
+#define HEIGHT (29)      ///< Height of the test images
+#define OPERATIONS (800) ///< Random operations per alignment
+
+/**
+ * @brief Get the next pseudo random number
+ *
+ * @return uint32_t random number
+ */
+static uint32_t nextRandom();
+
+/**
+ * @brief Compare the wrapper pixels and data with the C image
+ *
+ * @tparam Alignment the data alignment of the wrapper
+ * @param image the wrapper image
+ * @param reference the C image drawn with the C functions
+ */
+template <pbm_data_alignment Alignment>
+static void compareImages(const pbm::imageView<Alignment> &image,
+                          const pbm_image &reference);
+
+/**
+ * @brief Draw the same random pixels, spans and rectangles with the wrapper
+ * and the C functions
+ *
+ * @tparam Alignment the data alignment of the wrapper
+ * @param alignment the data alignment of the image
+ */
+template <pbm_data_alignment Alignment>
+static void checkAlignment(pbm_data_alignment alignment);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  checkAlignment<PBM_DATA_HORIZONTAL_MSB>(PBM_DATA_HORIZONTAL_MSB);
+  checkAlignment<PBM_DATA_HORIZONTAL_LSB>(PBM_DATA_HORIZONTAL_LSB);
+  checkAlignment<PBM_DATA_VERTICAL_MSB>(PBM_DATA_VERTICAL_MSB);
+  checkAlignment<PBM_DATA_VERTICAL_LSB>(PBM_DATA_VERTICAL_LSB);
+  checkAlignment<pbm::dynamicAlignment>(PBM_DATA_HORIZONTAL_LSB);
+  checkAlignment<pbm::dynamicAlignment>(PBM_DATA_VERTICAL_MSB);
+
+  // A moved image leaves the source empty
+  pbm::image<PBM_DATA_VERTICAL_LSB> first(WIDTH, HEIGHT);
+  first.setPixelUnchecked(3, 9, PBM_BLACK);
+  uint8_t *data = first.data();
+  pbm::image<PBM_DATA_VERTICAL_LSB> second(std::move(first));
+  CHECK(nullptr == first.data() && 0 == first.width() && 0 == first.size());
+  CHECK(data == second.data() && PBM_BLACK == second.pixel(3, 9));
+  pbm::image<PBM_DATA_VERTICAL_LSB> third(1, 1);
+  third = std::move(second);
+  CHECK(nullptr == second.data() && data == third.data());
+  CHECK(HEIGHT == third.view().height());
+  return TEST_RESULT("imageWrapper");
+}
+
+static uint32_t nextRandom() {
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 8;
+}
+
+template <pbm_data_alignment Alignment>
+static void compareImages(const pbm::imageView<Alignment> &image,
+                          const pbm_image &reference) {
+  CHECK(0 == std::memcmp(image.data(), reference.data, image.size()));
+  uint32_t errors = 0;
+  for (uint32_t y = 0; y < HEIGHT; y++) {
+    for (uint32_t x = 0; x < WIDTH; x++) {
+      int black = (PBM_BLACK == image.pixel(x, y));
+      errors += (black != testPixel(&reference, x, y));
+    }
+  }
+  CHECK(0 == errors);
+}
+
+template <pbm_data_alignment Alignment>
+static void checkAlignment(pbm_data_alignment alignment) {
+  pbm::image<Alignment> image(WIDTH, HEIGHT, alignment);
+  CHECK(alignment == image.alignment());
+  CHECK(alignment == image.handle()->alignment);
+  const size_t size = image.size();
+  CHECK(size == ((PBM_DATA_HORIZONTAL_MSB == alignment ||
+                  PBM_DATA_HORIZONTAL_LSB == alignment)
+                     ? (size_t)(WIDTH + 7) / 8 * HEIGHT
+                     : (size_t)(HEIGHT + 7) / 8 * WIDTH));
+  auto referenceData = std::make_unique<uint8_t[]>(size);
+  pbm_image reference = {WIDTH, HEIGHT, alignment, referenceData.get()};
+  compareImages(image.view(), reference);
+
+  for (uint32_t i = 0; i < OPERATIONS; i++) {
+    const pbm_colors color = (nextRandom() % 3) ? PBM_BLACK : PBM_WHITE;
+    uint32_t x = nextRandom() % (WIDTH + 3);
+    uint32_t y = nextRandom() % (HEIGHT + 3);
+    switch (nextRandom() % 4) {
+    case 0: {
+      // Pixels with the image end and outside of the image
+      x = (0 == i % 7) ? PBM_IMAGE_END : x;
+      y = (0 == i % 11) ? PBM_IMAGE_END : y;
+      pbm_return expected = pbm_setPixel(&reference, x, y, color);
+      CHECK(expected == image.setPixel(x, y, color));
+      break;
+    }
+    case 1: {
+      uint32_t length = nextRandom() % (WIDTH + 8);
+      image.drawSpan(x, y, length, color);
+      if (x < WIDTH && y < HEIGHT && 0 != length) {
+        uint32_t end = (length > WIDTH - x) ? WIDTH - 1 : x + length - 1;
+        pbm_drawLine(&reference, x, y, end, y, color);
+      }
+      break;
+    }
+    case 2: {
+      uint32_t width = nextRandom() % 20;
+      uint32_t height = nextRandom() % 12;
+      image.fillRect(x, y, width, height, color);
+      for (uint32_t row = y; row < y + height && row < HEIGHT; row++) {
+        if (x < WIDTH && 0 != width) {
+          uint32_t end = (width > WIDTH - x) ? WIDTH - 1 : x + width - 1;
+          pbm_drawLine(&reference, x, row, end, row, color);
+        }
+      }
+      break;
+    }
+    default:
+      if (x < WIDTH && y < HEIGHT) {
+        image.setPixelUnchecked(x, y, color);
+        pbm_setPixel(&reference, x, y, color);
+      }
+      break;
+    }
+    compareImages(image.view(), reference);
+  }
+
+  // The C wrappers give the same image
+  pbm_font font{};
+  font.fontData = &font_6x8H_MSB[0][0];
+  font.width = 6;
+  font.height = 8;
+  font.alignment = PBM_DATA_HORIZONTAL_MSB;
+  const pbm_rect rect = {3, 4, 20, 15};
+  CHECK(pbm_scroll(&reference, &rect, 5, -3, PBM_BLACK) ==
+        image.scroll(&rect, 5, -3, PBM_BLACK));
+  CHECK(pbm_writeCharStyled(&reference, 2, 3, PBM_BLACK, &font, NULL, 'A') ==
+        image.writeChar(2, 3, PBM_BLACK, font, 'A'));
+  pbm_return expected = pbm_writeStringStyled(
+      &reference, 36, 20, PBM_WHITE, &font, PBM_STRING_RIGHT_TOP, NULL, "pbm");
+  CHECK(expected == image.writeString(36, 20, PBM_WHITE, font,
+                                      PBM_STRING_RIGHT_TOP, "pbm"));
+  compareImages(image.view(), reference);
+  image.fill(PBM_BLACK);
+  pbm_fill(&reference, PBM_BLACK);
+  compareImages(image.view(), reference);
+}
@@ -0,0 +1,237 @@
+/**
+ * @file test_largeImage.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of images with more than 4 GiB of data
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// MAP_ANONYMOUS, MAP_NORESERVE and pwrite
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pbm_graphics.h"
+#include "pbm_io.h"
+#include "test.h"
+
+#define LARGE_WIDTH (524288u) ///< Width of the round trip image
+#define LARGE_HEIGHT (8193u)  ///< Height with more than 2^32 pixels
+#define LARGE_LINE (LARGE_WIDTH / 8)
+
+/**
+ * @brief Image dimensions with the expected data size
+ *
+ */
+typedef struct {
+  uint32_t width;               ///< Width of the image
+  uint32_t height;              ///< Height of the image
+  pbm_data_alignment alignment; ///< Data alignment
+  uint64_t size;                ///< Expected number of data bytes
+} sizeCase;
+
+/**
+ * @brief Check the data sizes around the 32 bit boundaries
+ *
+ */
+static void checkDataSizes(void);
+
+/**
+ * @brief Draw the last pixels of an image with more than 4 GiB of data
+ *
+ * The data is a mapping without reserved memory, only the touched pages are
+ * allocated.
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @param alignment the data alignment
+ * @param lastByte index of the byte with the last pixel
+ * @param lastMask bit of the last pixel
+ */
+static void checkLastPixel(uint32_t width, uint32_t height,
+                           pbm_data_alignment alignment, uint64_t lastByte,
+                           uint8_t lastMask);
+
+/**
+ * @brief Fill a line with a pattern of its row
+ *
+ * @param line the line of LARGE_LINE bytes
+ * @param row the row of the line
+ */
+static void fillPattern(uint8_t *line, uint32_t row);
+
+/**
+ * @brief Compare the first and the last row of a large image with the pattern
+ *
+ * @param image the decoded image
+ * @return int 1 if the rows are equal
+ */
+static int checkRows(const pbm_image *image);
+
+/**
+ * @brief Round trip an image with more than 2^32 pixels
+ *
+ * A sparse file with only the first and the last row written is decoded from
+ * the file descriptor and aliased in a stream, encoded again and decoded from
+ * the encoded file.
+ */
+static void checkRoundTrip(void);
+
+int main(void) {
+  checkDataSizes();
+#if SIZE_MAX > UINT32_MAX
+  checkLastPixel(524288, 65537, PBM_DATA_HORIZONTAL_MSB, 65536ull * 65537 - 1,
+                 0x01);
+  checkLastPixel(536870912, 72, PBM_DATA_VERTICAL_LSB, 9ull * 536870912 - 1,
+                 0x80);
+  checkRoundTrip();
+#endif
+  return TEST_RESULT("largeImage");
+}
+
+static void checkDataSizes(void) {
+  const sizeCase cases[] = {
+      {524288, 65535, PBM_DATA_HORIZONTAL_MSB, 65536ull * 65535},
+      {524288, 65536, PBM_DATA_HORIZONTAL_LSB, 1ull << 32},
+      {524281, 65536, PBM_DATA_HORIZONTAL_MSB, 1ull << 32},
+      {UINT32_MAX, 1, PBM_DATA_HORIZONTAL_MSB, 536870912},
+      {UINT32_MAX, UINT32_MAX, PBM_DATA_HORIZONTAL_LSB,
+       536870912ull * UINT32_MAX},
+      {UINT32_MAX, 8, PBM_DATA_VERTICAL_LSB, UINT32_MAX},
+      {2147483648u, 16, PBM_DATA_VERTICAL_MSB, 1ull << 32},
+      {1, UINT32_MAX, PBM_DATA_VERTICAL_LSB, 536870912},
+      {0, 0, PBM_DATA_HORIZONTAL_MSB, 0}};
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    pbm_image image = {cases[i].width, cases[i].height, cases[i].alignment,
+                       NULL};
+    size_t size = 0;
+    pbm_return ret = pbm_imageDataSize(&image, &size);
+    if (cases[i].size > SIZE_MAX) {
+      CHECK(PBM_SIZE == ret);
+    } else {
+      CHECK(PBM_OK == ret);
+      CHECK(cases[i].size == size);
+    }
+  }
+}
+
+static void checkLastPixel(uint32_t width, uint32_t height,
+                           pbm_data_alignment alignment, uint64_t lastByte,
+                           uint8_t lastMask) {
+  pbm_image image = {width, height, alignment, NULL};
+  size_t size = 0;
+  CHECK(PBM_OK == pbm_imageDataSize(&image, &size));
+  CHECK(lastByte + 1 == size);
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (MAP_FAILED == data) {
+    printf("largeImage: %u x %u not mapped, skipped\n", width, height);
+    return;
+  }
+  image.data = data;
+  CHECK(PBM_OK ==
+        pbm_setPixel(&image, PBM_IMAGE_END, PBM_IMAGE_END, PBM_BLACK));
+  CHECK(lastMask == image.data[lastByte]);
+  // A 32 bit position would wrap into the first 4 GiB
+  CHECK(0 == image.data[lastByte & UINT32_MAX]);
+
+  // The last line with the span writer
+  CHECK(PBM_OK == pbm_drawLine(&image, 0, PBM_IMAGE_END, PBM_IMAGE_END,
+                               PBM_IMAGE_END, PBM_BLACK));
+  size_t first = (PBM_DATA_HORIZONTAL_MSB == alignment)
+                     ? lastByte + 1 - (width + 7) / 8
+                     : lastByte + 1 - width;
+  // Bit of x = 0, the vertical alignments have the bit of the row
+  uint8_t firstMask = (PBM_DATA_HORIZONTAL_MSB == alignment) ? 0x80 : lastMask;
+  CHECK(firstMask == (image.data[first] & firstMask));
+  CHECK(0 == image.data[first - 1]);
+  munmap(data, size);
+}
+
+static void fillPattern(uint8_t *line, uint32_t row) {
+  for (uint32_t i = 0; i < LARGE_LINE; i++) {
+    line[i] = (uint8_t)(i * 7u + row);
+  }
+}
+
+static int checkRows(const pbm_image *image) {
+  if (LARGE_WIDTH != image->width || LARGE_HEIGHT != image->height ||
+      PBM_DATA_HORIZONTAL_MSB != image->alignment) {
+    return 0;
+  }
+  static uint8_t line[LARGE_LINE];
+  fillPattern(line, 0);
+  if (0 != memcmp(image->data, line, LARGE_LINE)) {
+    return 0;
+  }
+  fillPattern(line, LARGE_HEIGHT - 1);
+  return 0 == memcmp(&image->data[(size_t)LARGE_LINE * (LARGE_HEIGHT - 1)],
+                     line, LARGE_LINE);
+}
+
+static void checkRoundTrip(void) {
+  const char header[] = "P4\n524288 8193\n";
+  const off_t dataOffset = sizeof(header) - 1;
+  const off_t size = dataOffset + (off_t)LARGE_LINE * LARGE_HEIGHT;
+  static uint8_t line[LARGE_LINE];
+  int fd = open("largeImage.pbm", O_RDWR | O_CREAT | O_TRUNC, 0644);
+  CHECK(fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+  // Only the header and the first and last row use blocks of the file
+  CHECK(dataOffset == write(fd, header, dataOffset));
+  fillPattern(line, 0);
+  CHECK(LARGE_LINE == pwrite(fd, line, LARGE_LINE, dataOffset));
+  fillPattern(line, LARGE_HEIGHT - 1);
+  CHECK(LARGE_LINE == pwrite(fd, line, LARGE_LINE, size - LARGE_LINE));
+
+  pbm_image image = {0};
+  CHECK(0 == lseek(fd, 0, SEEK_SET));
+  CHECK(PBM_OK == pbm_decodeFromFd(fd, &image));
+  CHECK(checkRows(&image));
+  free(image.data);
+  close(fd);
+
+  pbm_stream stream;
+  CHECK(PBM_OK == pbm_openStream("largeImage.pbm", &stream));
+  image.data = NULL;
+  CHECK(PBM_OK == pbm_readStream(&stream, &image, PBM_DECODE_ALIAS));
+  CHECK(checkRows(&image));
+
+  // Encode the aliased image, the new file is written completely
+  fd = open("largeImageCopy.pbm", O_RDWR | O_CREAT | O_TRUNC, 0644);
+  CHECK(fd >= 0);
+  if (fd >= 0) {
+    CHECK(PBM_OK == pbm_encodeToFd(fd, &image));
+    CHECK(0 == lseek(fd, 0, SEEK_SET));
+    pbm_image copy = {0};
+    CHECK(PBM_OK == pbm_decodeFromFd(fd, &copy));
+    CHECK(checkRows(&copy));
+    free(copy.data);
+    close(fd);
+  }
+  pbm_closeStream(&stream);
+  unlink("largeImageCopy.pbm");
+  unlink("largeImage.pbm");
+}
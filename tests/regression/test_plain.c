@@ -0,0 +1,210 @@
+/**
+ * @file test_plain.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the vectorized and scalar P1 raster parser
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pbm_io.h"
+#include "test.h"
+
+#define MAX_TEXT (16 * 1024)  ///< Maximum length of an encoded test image
+#define TRAILER "\nP1\n1 1 x" ///< Bytes after the image, never parsed
+#define TRAILER_LENGTH (sizeof(TRAILER) - 1)
+
+/**
+ * @brief Layout of the raster text
+ *
+ */
+typedef enum {
+  LAYOUT_DENSE = 0, ///< Digits without whitespace
+  LAYOUT_SPACED,    ///< Every digit followed by whitespace
+  LAYOUT_MIXED      ///< Runs of digits between random whitespace
+} textLayout;
+
+/**
+ * @brief Get the next pseudo random number
+ *
+ * @return uint32_t random number
+ */
+static uint32_t nextRandom(void);
+
+/**
+ * @brief Write a P1 image of random pixels
+ *
+ * @param text the destination of MAX_TEXT bytes
+ * @param width width of the image
+ * @param height height of the image
+ * @param layout layout of the raster text
+ * @param pixels the pixels, one byte per pixel
+ * @return size_t length of the text
+ */
+static size_t createText(char *text, uint32_t width, uint32_t height,
+                         textLayout layout, uint8_t *pixels);
+
+/**
+ * @brief Decode a P1 text from memory, a FILE and a pipe
+ *
+ * @param text the encoded image
+ * @param length length of the text
+ * @param width width of the image
+ * @param height height of the image
+ * @param pixels the expected pixels or NULL if the text is invalid
+ */
+static void checkText(const char *text, size_t length, uint32_t width,
+                      uint32_t height, const uint8_t *pixels);
+
+/**
+ * @brief Compare a decoded image with the expected pixels
+ *
+ * @param image the decoded image
+ * @param width width of the image
+ * @param height height of the image
+ * @param pixels the expected pixels
+ * @return int 1 if the image is equal
+ */
+static int samePixels(const pbm_image *image, uint32_t width, uint32_t height,
+                      const uint8_t *pixels);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  static char text[MAX_TEXT];
+  static uint8_t pixels[MAX_TEXT];
+  // Widths below, at and across the 16 characters of the vector loop
+  const uint32_t widths[] = {1, 5, 15, 16, 17, 31, 32, 37, 64, 100};
+  for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+    for (textLayout layout = LAYOUT_DENSE; layout <= LAYOUT_MIXED; layout++) {
+      uint32_t height = 1 + nextRandom() % 13;
+      size_t length =
+          createText(text, widths[i], height, layout, pixels);
+      checkText(text, length, widths[i], height, pixels);
+    }
+  }
+
+  // Invalid characters in the scalar and the vector part, the characters
+  // around the whitespace range and with the sign bit
+  const uint8_t invalid[] = {'2', '/', 'x', '#', 0x08, 0x0E, 0x80, 0xB0, 0xFF};
+  size_t length = createText(text, 37, 5, LAYOUT_MIXED, pixels);
+  // The raster without the header and the bytes after the image
+  for (size_t position = 12; position < length - TRAILER_LENGTH;
+       position += 7) {
+    if ('0' != text[position] && '1' != text[position] &&
+        ' ' != text[position]) {
+      continue;
+    }
+    char original = text[position];
+    text[position] = (char)invalid[position % sizeof(invalid)];
+    checkText(text, length, 37, 5, NULL);
+    text[position] = original;
+  }
+  return TEST_RESULT("plain");
+}
+
+static uint32_t nextRandom(void) {
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 8;
+}
+
+static size_t createText(char *text, uint32_t width, uint32_t height,
+                         textLayout layout, uint8_t *pixels) {
+  const char spaces[] = " \t\n\v\f\r";
+  size_t length = (size_t)sprintf(text, "P1\n%u %u\n", width, height);
+  for (uint32_t i = 0; i < width * height; i++) {
+    pixels[i] = (uint8_t)(nextRandom() % 2);
+    text[length++] = (char)('0' + pixels[i]);
+    uint32_t blanks = 0;
+    if (LAYOUT_SPACED == layout) {
+      blanks = 1 + nextRandom() % 2;
+    } else if (LAYOUT_MIXED == layout && 0 == nextRandom() % 9) {
+      blanks = 1 + nextRandom() % 20;
+    }
+    for (uint32_t j = 0; j < blanks; j++) {
+      text[length++] = spaces[nextRandom() % (sizeof(spaces) - 1)];
+    }
+  }
+  // Bytes after the image are not parsed
+  memcpy(&text[length], TRAILER, TRAILER_LENGTH);
+  length += TRAILER_LENGTH;
+  return length;
+}
+
+static void checkText(const char *text, size_t length, uint32_t width,
+                      uint32_t height, const uint8_t *pixels) {
+  pbm_image image = {0};
+  size_t used = 0;
+  pbm_return ret = pbm_decodeFromMemory((const uint8_t *)text, length, &image,
+                                        PBM_DECODE_COPY, &used);
+  if (NULL == pixels) {
+    CHECK(PBM_ERROR == ret);
+  } else {
+    CHECK(PBM_OK == ret && samePixels(&image, width, height, pixels));
+    // The parser stops after the last digit
+    CHECK('0' == text[used - 1] || '1' == text[used - 1]);
+    CHECK(0 == memcmp(&text[used], TRAILER, TRAILER_LENGTH) ||
+          NULL != strchr(" \t\n\v\f\r", text[used]));
+    free(image.data);
+  }
+
+  // The FILE and the pipe are read in blocks of the missing pixels
+  FILE *file = tmpfile();
+  CHECK(NULL != file && length == fwrite(text, 1, length, file));
+  rewind(file);
+  ret = pbm_decodeFromFile(file, &image);
+  fclose(file);
+  if (NULL == pixels) {
+    CHECK(PBM_ERROR == ret);
+  } else {
+    CHECK(PBM_OK == ret && samePixels(&image, width, height, pixels));
+    free(image.data);
+  }
+
+  int fds[2];
+  CHECK(0 == pipe(fds));
+  CHECK((ssize_t)length == write(fds[1], text, length));
+  close(fds[1]);
+  ret = pbm_decodeFromFd(fds[0], &image);
+  close(fds[0]);
+  if (NULL == pixels) {
+    CHECK(PBM_ERROR == ret);
+  } else {
+    CHECK(PBM_OK == ret && samePixels(&image, width, height, pixels));
+    free(image.data);
+  }
+}
+
+static int samePixels(const pbm_image *image, uint32_t width, uint32_t height,
+                      const uint8_t *pixels) {
+  if (width != image->width || height != image->height) {
+    return 0;
+  }
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      if (testPixel(image, x, y) != pixels[y * width + x]) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_probe.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of probing truncated files and long headers
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pbm_io.h"
+#include "test.h"
+
+#define PROBE_FILE "probe.pbm" ///< Path of the probed files
+#define MAX_TEXT (4096)        ///< Maximum length of a probed image
+
+/**
+ * @brief Probe an image as file and in memory
+ *
+ * Both probes must return the same state and header information.
+ *
+ * @param text the encoded image
+ * @param length the number of bytes
+ * @param expected the expected state
+ * @param info the expected header information for PBM_OK
+ */
+static void checkProbe(const char *text, size_t length, pbm_return expected,
+                       const pbm_imageInfo *info);
+
+/**
+ * @brief Probe an image and the image without the last byte
+ *
+ * @param text the encoded image with the complete raster
+ * @param length the number of bytes
+ * @param info the expected header information
+ */
+static void checkTruncated(const char *text, size_t length,
+                           const pbm_imageInfo *info);
+
+int main(void) {
+  static char text[MAX_TEXT];
+  pbm_imageInfo info = {PBM_FORMAT_BINARY, 16, 3, 1, 8, 6};
+  memcpy(text, "P4\n16 3\nABCDEF", 14);
+  checkTruncated(text, 14, &info);
+
+  // Comments longer than the probe buffer, one directly after the height
+  size_t length = (size_t)sprintf(text, "P4\n# ");
+  memset(&text[length], 'c', 1000);
+  length += 1000;
+  length += (size_t)sprintf(&text[length], "\n16 # width\n3#");
+  memset(&text[length], '#', 600);
+  length += 600;
+  text[length++] = '\n';
+  info.dataOffset = length;
+  memcpy(&text[length], "\xFF\x00\x81\x7E\x01\x80", 6);
+  checkTruncated(text, length + 6, &info);
+
+  // Samples of 16 bit gray and 8 bit color
+  pbm_imageInfo gray = {PBM_FORMAT_GRAY, 4, 2, 65535, 13, 16};
+  memcpy(text, "P5 4 2 65535\n0123456789abcdef", 29);
+  checkTruncated(text, 29, &gray);
+  pbm_imageInfo color = {PBM_FORMAT_COLOR, 2, 2, 255, 11, 12};
+  memcpy(text, "P6\n2 2\n255\n0123456789ab", 23);
+  checkTruncated(text, 23, &color);
+  // A plain raster has at least a character per pixel
+  pbm_imageInfo plain = {PBM_FORMAT_PLAIN, 3, 2, 1, 7, 6};
+  checkTruncated("P1 3 2\n010111", 13, &plain);
+
+  // Truncated and invalid headers
+  const char *invalid[] = {"", "P", "P4", "P4\n16", "P4\n16 3", "P4 16 3 #",
+                           "P7 1 1\n", "P4 16 x\n", "P5 1 1 0\n0"};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    checkProbe(invalid[i], strlen(invalid[i]), PBM_ERROR, NULL);
+  }
+  checkProbe("P4 4294967296 1\n", 16, PBM_SIZE, NULL);
+  CHECK(PBM_ERROR == pbm_probeImage("missing.pbm", &info));
+  CHECK(PBM_ARGUMENTS == pbm_probeMemory(NULL, 0, &info));
+  unlink(PROBE_FILE);
+  return TEST_RESULT("probe");
+}
+
+static void checkProbe(const char *text, size_t length, pbm_return expected,
+                       const pbm_imageInfo *info) {
+  FILE *file = fopen(PROBE_FILE, "wb");
+  CHECK(NULL != file && length == fwrite(text, 1, length, file));
+  fclose(file);
+  pbm_imageInfo fileInfo;
+  pbm_imageInfo memoryInfo;
+  memset(&fileInfo, 0xA5, sizeof(fileInfo));
+  memset(&memoryInfo, 0xA5, sizeof(memoryInfo));
+  pbm_imageInfo unchanged = fileInfo;
+  CHECK(expected == pbm_probeImage(PROBE_FILE, &fileInfo));
+  CHECK(expected ==
+        pbm_probeMemory((const uint8_t *)text, length, &memoryInfo));
+  if (PBM_OK != expected) {
+    // The information is only changed on success
+    CHECK(0 == memcmp(&unchanged, &fileInfo, sizeof(fileInfo)));
+    CHECK(0 == memcmp(&unchanged, &memoryInfo, sizeof(memoryInfo)));
+    return;
+  }
+  const pbm_imageInfo *probed[] = {&fileInfo, &memoryInfo};
+  for (size_t i = 0; i < 2; i++) {
+    CHECK(info->format == probed[i]->format);
+    CHECK(info->width == probed[i]->width);
+    CHECK(info->height == probed[i]->height);
+    CHECK(info->maxval == probed[i]->maxval);
+    CHECK(info->dataOffset == probed[i]->dataOffset);
+    CHECK(info->dataSize == probed[i]->dataSize);
+  }
+}
+
+static void checkTruncated(const char *text, size_t length,
+                           const pbm_imageInfo *info) {
+  checkProbe(text, length, PBM_OK, info);
+  checkProbe(text, length - 1, PBM_ERROR, NULL);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_proportional.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the proportional advance and the kerning
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256) ///< Glyphs of the test font
+#define WIDTH (96)   ///< Width of the test image
+#define HEIGHT (10)  ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+
+static const char *const texts[] = {"AVAT", "iil ,.", "To Wa!", "A", ""};
+
+/**
+ * @brief Kerning pairs of the test, sorted by the left and the right glyph
+ *
+ */
+static const pbm_kerningPair kerning[] = {
+    {'A', 'T', -1}, {'A', 'V', -1}, {'T', 'o', -2}, {'V', 'A', -1},
+    {'W', 'a', 2},  {'i', 'l', 3},
+};
+
+/**
+ * @brief Compute the pen positions of the glyphs of a text
+ *
+ * @param font the proportional font
+ * @param text the text
+ * @param pens output pen position of every glyph
+ * @return uint32_t width of the text
+ */
+static uint32_t referencePens(const pbm_font *font, const char *text,
+                              int32_t *pens);
+
+/**
+ * @brief Check the drawn text against the advance columns of every glyph
+ *
+ * @param font the proportional font
+ * @param text the text
+ */
+static void checkDrawn(const pbm_font *font, const char *text);
+
+static pbm_glyphMetrics metrics[GLYPHS];
+
+int main(void) {
+  pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                   .width = 6,
+                   .height = 8,
+                   .alignment = PBM_DATA_HORIZONTAL_MSB};
+  CHECK(PBM_OK == pbm_computeGlyphMetrics(&font, metrics, GLYPHS));
+  CHECK(font.width / 2 == metrics[' '].advance);
+  CHECK(metrics['i'].advance < font.width);
+  font.metrics = metrics;
+
+  for (int kerned = 0; kerned < 2; kerned++) {
+    font.kerning = kerned ? kerning : NULL;
+    font.kerningCount =
+        kerned ? (uint32_t)(sizeof(kerning) / sizeof(kerning[0])) : 0;
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+      int32_t pens[16];
+      pbm_textExtent extent;
+      CHECK(PBM_OK == pbm_measureString(&font, texts[i], &extent));
+      CHECK(referencePens(&font, texts[i], pens) == extent.width);
+      checkDrawn(&font, texts[i]);
+    }
+  }
+  // The kerning changes the width by the sum of the pair offsets
+  pbm_textExtent plain;
+  pbm_textExtent kerned;
+  font.kerning = NULL;
+  font.kerningCount = 0;
+  CHECK(PBM_OK == pbm_measureString(&font, "AVAT", &plain));
+  font.kerning = kerning;
+  font.kerningCount = sizeof(kerning) / sizeof(kerning[0]);
+  CHECK(PBM_OK == pbm_measureString(&font, "AVAT", &kerned));
+  CHECK(plain.width - 3 == kerned.width);
+  return TEST_RESULT("proportional");
+}
+
+static uint32_t referencePens(const pbm_font *font, const char *text,
+                              int32_t *pens) {
+  int32_t pen = 0;
+  size_t length = strlen(text);
+  for (size_t i = 0; i < length; i++) {
+    if (i > 0) {
+      pen += 1;
+      for (uint32_t k = 0; k < font->kerningCount; k++) {
+        if (font->kerning[k].left == (uint8_t)text[i - 1] &&
+            font->kerning[k].right == (uint8_t)text[i]) {
+          pen += font->kerning[k].offset;
+        }
+      }
+    }
+    pens[i] = pen;
+    pen += font->metrics[(uint8_t)text[i]].advance;
+  }
+  return (uint32_t)pen;
+}
+
+static void checkDrawn(const pbm_font *font, const char *text) {
+  uint8_t drawnData[DATA_SIZE];
+  uint8_t expectedData[DATA_SIZE];
+  uint8_t glyphData[8];
+  pbm_image drawn = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, drawnData};
+  pbm_image expected = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, expectedData};
+  pbm_image glyph = {8, 8, PBM_DATA_HORIZONTAL_MSB, glyphData};
+  pbm_font fixed = *font;
+  fixed.metrics = NULL;
+  fixed.kerning = NULL;
+  fixed.kerningCount = 0;
+  const uint32_t x = 4;
+  const uint32_t y = 1;
+
+  pbm_fill(&drawn, PBM_WHITE);
+  if ('\0' == *text) {
+    CHECK(PBM_ARGUMENTS == pbm_writeString(&drawn, x, y, PBM_BLACK, font,
+                                           PBM_STRING_LEFT_TOP, text));
+    return;
+  }
+  CHECK(PBM_OK == pbm_writeString(&drawn, x, y, PBM_BLACK, font,
+                                  PBM_STRING_LEFT_TOP, text));
+  // Copy the advance columns of the fixed width glyphs to the pen positions,
+  // a later glyph overwrites the columns of a negative kerning
+  int32_t pens[16];
+  referencePens(font, text, pens);
+  pbm_fill(&expected, PBM_WHITE);
+  for (size_t i = 0; text[i] != '\0'; i++) {
+    const pbm_glyphMetrics *metric = &font->metrics[(uint8_t)text[i]];
+    pbm_fill(&glyph, PBM_WHITE);
+    pbm_writeChar(&glyph, 0, 0, PBM_BLACK, &fixed, (uint8_t)text[i]);
+    for (uint32_t column = 0; column < metric->advance; column++) {
+      for (uint32_t line = 0; line < font->height; line++) {
+        pbm_colors pixel = testPixel(&glyph, metric->leftBearing + column,
+                                     line)
+                               ? PBM_BLACK
+                               : PBM_WHITE;
+        pbm_setPixel(&expected, x + pens[i] + column, y + line, pixel);
+      }
+    }
+  }
+  CHECK(0 == memcmp(drawnData, expectedData, DATA_SIZE));
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_rotation.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the rotated text with the added font rotations
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256) ///< Glyphs of the test font
+#define SIZE (48)    ///< Width and height of the test images
+#define DATA_SIZE (SIZE / 8 * SIZE)
+#define TEXT_X (5) ///< Position of the text box in x
+#define TEXT_Y (3) ///< Position of the text box in y
+
+static const char text[] = "Rot|g";
+
+/**
+ * @brief Check the rotated text against the rotated upright text
+ *
+ * @param font the font with the rotations
+ * @param rotation the clockwise rotation
+ * @param mode the text mode
+ */
+static void checkRotation(const pbm_font *font, pbm_textRotation rotation,
+                          pbm_textMode mode);
+
+int main(void) {
+  pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                   .width = 6,
+                   .height = 8,
+                   .alignment = PBM_DATA_HORIZONTAL_MSB};
+  pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE, .rotation = PBM_ROTATE_90};
+  uint8_t data[DATA_SIZE];
+  pbm_image image = {SIZE, SIZE, PBM_DATA_HORIZONTAL_MSB, data};
+  // Rotated text needs the rotations of the font
+  CHECK(PBM_ARGUMENTS == pbm_writeStringStyled(&image, 0, 0, PBM_BLACK, &font,
+                                               PBM_STRING_LEFT_TOP, &style,
+                                               text));
+
+  uint32_t size = 0;
+  pbm_fontRotations rotations;
+  CHECK(PBM_OK == pbm_addFontRotations(&font, GLYPHS, NULL, &size, NULL));
+  // 6 lines of 8 pixels for 90 and 270 degree, 8 lines of 6 pixels for 180
+  CHECK((6 + 8 + 6) * GLYPHS == size);
+  CHECK(NULL == font.rotations);
+  uint8_t *rotated = (uint8_t *)malloc(size);
+  if (NULL == rotated) {
+    CHECK(0);
+    return TEST_RESULT("rotation");
+  }
+  uint32_t smallSize = size - 1;
+  CHECK(PBM_SIZE ==
+        pbm_addFontRotations(&font, GLYPHS, rotated, &smallSize, &rotations));
+  CHECK(size == smallSize && NULL == font.rotations);
+  CHECK(PBM_OK ==
+        pbm_addFontRotations(&font, GLYPHS, rotated, &size, &rotations));
+  CHECK(font.rotations == rotations.table);
+  CHECK(8 == rotations.fonts[0].width && 6 == rotations.fonts[0].height);
+  CHECK(6 == rotations.fonts[1].width && 8 == rotations.fonts[1].height);
+
+  for (int rotation = PBM_ROTATE_90; rotation <= PBM_ROTATE_270; rotation++) {
+    checkRotation(&font, (pbm_textRotation)rotation, PBM_TEXT_OPAQUE);
+    checkRotation(&font, (pbm_textRotation)rotation, PBM_TEXT_TRANSPARENT);
+  }
+  free(rotated);
+  return TEST_RESULT("rotation");
+}
+
+static void checkRotation(const pbm_font *font, pbm_textRotation rotation,
+                          pbm_textMode mode) {
+  uint8_t uprightData[DATA_SIZE];
+  uint8_t rotatedData[DATA_SIZE];
+  pbm_image upright = {SIZE, SIZE, PBM_DATA_HORIZONTAL_MSB, uprightData};
+  pbm_image rotated = {SIZE, SIZE, PBM_DATA_HORIZONTAL_MSB, rotatedData};
+  pbm_textExtent extent;
+  CHECK(PBM_OK == pbm_measureString(font, text, &extent));
+  uint32_t width = extent.width;
+  uint32_t height = extent.height;
+
+  pbm_fill(&upright, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeString(&upright, 0, 0, PBM_BLACK, font,
+                                  PBM_STRING_LEFT_TOP, text));
+  pbm_textStyle style = {.mode = mode, .rotation = rotation};
+  pbm_fill(&rotated, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeStringStyled(&rotated, TEXT_X, TEXT_Y, PBM_BLACK,
+                                        font, PBM_STRING_LEFT_TOP, &style,
+                                        text));
+  uint32_t boxWidth = (PBM_ROTATE_180 == rotation) ? width : height;
+  uint32_t boxHeight = (PBM_ROTATE_180 == rotation) ? height : width;
+  uint32_t wrongPixels = 0;
+  for (uint32_t y = 0; y < SIZE; y++) {
+    for (uint32_t x = 0; x < SIZE; x++) {
+      int expected = 0;
+      if (x >= TEXT_X && x < TEXT_X + boxWidth && y >= TEXT_Y &&
+          y < TEXT_Y + boxHeight) {
+        // Upright pixel at the clockwise rotated position
+        uint32_t u = x - TEXT_X;
+        uint32_t v = y - TEXT_Y;
+        uint32_t uprightX = v;
+        uint32_t uprightY = height - 1 - u;
+        if (PBM_ROTATE_180 == rotation) {
+          uprightX = width - 1 - u;
+          uprightY = height - 1 - v;
+        } else if (PBM_ROTATE_270 == rotation) {
+          uprightX = width - 1 - v;
+          uprightY = u;
+        }
+        expected = testPixel(&upright, uprightX, uprightY);
+      }
+      wrongPixels += (expected != testPixel(&rotated, x, y));
+    }
+  }
+  if (0 != wrongPixels) {
+    printf("rotation %d mode %d: %u wrong pixels\n", (int)rotation, (int)mode,
+           wrongPixels);
+  }
+  CHECK(0 == wrongPixels);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file test_scaled.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the scaled and smoothed glyphs
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "12x20_horizontal_MSB.h"
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256)   ///< Glyphs of the test fonts
+#define WIDTH (104)    ///< Width of the test image
+#define HEIGHT (80)    ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+#define GLYPH_X (3)    ///< Glyph position in x, not on a byte border
+#define GLYPH_Y (2)    ///< Glyph position in y
+#define MAX_CELL (256) ///< Maximal pixels of an unscaled glyph
+
+/**
+ * @brief Compare every scaled glyph of a font with the reference scaling
+ *
+ * @param font the font
+ * @param scale the scale factor
+ * @param smooth smoothing of the style
+ * @param mode the text mode
+ */
+static void checkScale(const pbm_font *font, uint8_t scale, uint8_t smooth,
+                       pbm_textMode mode);
+
+/**
+ * @brief Scale a glyph cell, smoothed with the Scale2x rules for even scales
+ *
+ * @param src unscaled pixels of the glyph, one byte per pixel
+ * @param width width of the glyph
+ * @param height height of the glyph
+ * @param scale the scale factor
+ * @param smooth smoothing of the style
+ * @param x pixel position in x in the scaled glyph
+ * @param y pixel position in y in the scaled glyph
+ * @return uint8_t 1 for a set pixel
+ */
+static uint8_t referencePixel(const uint8_t *src, uint32_t width,
+                              uint32_t height, uint32_t scale, uint8_t smooth,
+                              uint32_t x, uint32_t y);
+
+static uint8_t drawnData[DATA_SIZE];
+static pbm_image drawn = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, drawnData};
+
+int main(void) {
+  const pbm_font small = {.fontData = &font_6x8H_MSB[0][0],
+                          .width = 6,
+                          .height = 8,
+                          .alignment = PBM_DATA_HORIZONTAL_MSB};
+  const pbm_font large = {.fontData = &font_12x20H_MSB[0][0],
+                          .width = 12,
+                          .height = 20,
+                          .alignment = PBM_DATA_HORIZONTAL_MSB};
+  for (uint8_t scale = 1; scale <= PBM_TEXT_SCALE_MAX; scale++) {
+    checkScale(&small, scale, 0, PBM_TEXT_OPAQUE);
+    // Odd scales are not smoothed
+    checkScale(&small, scale, 1, PBM_TEXT_OPAQUE);
+  }
+  checkScale(&small, 4, 1, PBM_TEXT_TRANSPARENT);
+  checkScale(&small, 3, 0, PBM_TEXT_TRANSPARENT);
+  for (uint8_t scale = 1; scale <= 3; scale++) {
+    checkScale(&large, scale, 0, PBM_TEXT_OPAQUE);
+    checkScale(&large, scale, 1, PBM_TEXT_TRANSPARENT);
+  }
+  // The scale wrapper equals the style without smoothing
+  uint8_t styledData[DATA_SIZE];
+  pbm_image styled = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, styledData};
+  pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE, .scale = 3};
+  pbm_fill(&drawn, PBM_WHITE);
+  pbm_fill(&styled, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeStringScaled(&drawn, GLYPH_X, GLYPH_Y, PBM_BLACK,
+                                        &small, PBM_STRING_LEFT_TOP, 3,
+                                        "Ag&"));
+  CHECK(PBM_OK == pbm_writeStringStyled(&styled, GLYPH_X, GLYPH_Y, PBM_BLACK,
+                                        &small, PBM_STRING_LEFT_TOP, &style,
+                                        "Ag&"));
+  CHECK(0 == memcmp(drawnData, styledData, DATA_SIZE));
+  style.scale = PBM_TEXT_SCALE_MAX + 1;
+  CHECK(PBM_ARGUMENTS == pbm_writeCharStyled(&drawn, 0, 0, PBM_BLACK, &small,
+                                             &style, 'A'));
+  return TEST_RESULT("scaled");
+}
+
+static void checkScale(const pbm_font *font, uint8_t scale, uint8_t smooth,
+                       pbm_textMode mode) {
+  uint8_t cellData[2 * 20];
+  pbm_image cell = {font->width, font->height, PBM_DATA_HORIZONTAL_MSB,
+                    cellData};
+  uint8_t src[MAX_CELL];
+  pbm_textStyle style;
+  memset(&style, 0, sizeof(style));
+  style.mode = mode;
+  style.scale = scale;
+  style.smooth = smooth;
+  uint32_t width = font->width * scale;
+  uint32_t height = font->height * scale;
+  uint32_t wrongGlyphs = 0;
+  // A pattern shows the transparent background
+  uint8_t patternData[DATA_SIZE];
+  pbm_image pattern = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, patternData};
+  for (uint32_t i = 0; i < DATA_SIZE; i++) {
+    patternData[i] = (PBM_TEXT_TRANSPARENT == mode) ? (uint8_t)(i * 37) : 0;
+  }
+
+  for (uint32_t glyph = 0; glyph < GLYPHS; glyph++) {
+    pbm_fill(&cell, PBM_WHITE);
+    pbm_writeChar(&cell, 0, 0, PBM_BLACK, font, (uint8_t)glyph);
+    for (uint32_t y = 0; y < font->height; y++) {
+      for (uint32_t x = 0; x < font->width; x++) {
+        src[y * font->width + x] = (uint8_t)testPixel(&cell, x, y);
+      }
+    }
+    memcpy(drawnData, patternData, DATA_SIZE);
+    CHECK(PBM_OK == pbm_writeCharStyled(&drawn, GLYPH_X, GLYPH_Y, PBM_BLACK,
+                                        font, &style, (uint8_t)glyph));
+    uint32_t wrongPixels = 0;
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+      for (uint32_t x = 0; x < WIDTH; x++) {
+        uint8_t background = (uint8_t)testPixel(&pattern, x, y);
+        uint8_t expected = background;
+        if (x >= GLYPH_X && x < GLYPH_X + width && y >= GLYPH_Y &&
+            y < GLYPH_Y + height) {
+          uint8_t ink = referencePixel(src, font->width, font->height, scale,
+                                       smooth, x - GLYPH_X, y - GLYPH_Y);
+          expected = (PBM_TEXT_TRANSPARENT == mode) ? (background | ink) : ink;
+        }
+        wrongPixels += (expected != testPixel(&drawn, x, y));
+      }
+    }
+    wrongGlyphs += (0 != wrongPixels);
+  }
+  if (0 != wrongGlyphs) {
+    printf("%ux%u scale %u smooth %u mode %d: %u wrong glyphs\n", font->width,
+           font->height, scale, smooth, (int)mode, wrongGlyphs);
+  }
+  CHECK(0 == wrongGlyphs);
+}
+
+static uint8_t referencePixel(const uint8_t *src, uint32_t width,
+                              uint32_t height, uint32_t scale, uint8_t smooth,
+                              uint32_t x, uint32_t y) {
+  if (!smooth || 0 != scale % 2) {
+    return src[(y / scale) * width + x / scale];
+  }
+  // Scale2x of the source pixel, then replicated by the half scale
+  uint32_t half = scale / 2;
+  uint32_t column = x / half / 2;
+  uint32_t line = y / half / 2;
+  uint32_t quadrant = (x / half) % 2 + 2 * ((y / half) % 2);
+  uint8_t p = src[line * width + column];
+  uint8_t a = (line > 0) ? src[(line - 1) * width + column] : 0;
+  uint8_t d = (line + 1 < height) ? src[(line + 1) * width + column] : 0;
+  uint8_t c = (column > 0) ? src[line * width + column - 1] : 0;
+  uint8_t b = (column + 1 < width) ? src[line * width + column + 1] : 0;
+  switch (quadrant) {
+  case 0:
+    return (c == a && c != d && a != b) ? a : p;
+  case 1:
+    return (a == b && a != c && b != d) ? b : p;
+  case 2:
+    return (d == c && d != b && c != a) ? c : p;
+  default:
+    return (b == d && b != a && d != c) ? d : p;
+  }
+}
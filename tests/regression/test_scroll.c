@@ -0,0 +1,131 @@
+/**
+ * @file test_scroll.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of scrolling rectangles in all alignments
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#define WIDTH (37)  ///< Width of the test images
+#define HEIGHT (29) ///< Height of the test images
+#define DATA_SIZE (WIDTH * ((HEIGHT + 7) / 8))
+
+/**
+ * @brief Scroll a random image and compare every pixel with the expected one
+ *
+ * @param alignment the data alignment
+ * @param rect the scrolled rectangle or NULL
+ * @param dx horizontal distance
+ * @param dy vertical distance
+ * @param fill the fill color
+ */
+static void checkScroll(pbm_data_alignment alignment, const pbm_rect *rect,
+                        int32_t dx, int32_t dy, pbm_colors fill);
+
+/**
+ * @brief Scroll rectangles of an alignment with several distances
+ *
+ * @param alignment the data alignment
+ */
+static void checkAlignment(pbm_data_alignment alignment);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  checkAlignment(PBM_DATA_HORIZONTAL_MSB);
+  checkAlignment(PBM_DATA_HORIZONTAL_LSB);
+  checkAlignment(PBM_DATA_VERTICAL_MSB);
+  checkAlignment(PBM_DATA_VERTICAL_LSB);
+  uint8_t data[DATA_SIZE];
+  pbm_image image = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, NULL};
+  CHECK(PBM_ARGUMENTS == pbm_scroll(NULL, NULL, 1, 1, PBM_WHITE));
+  CHECK(PBM_ARGUMENTS == pbm_scroll(&image, NULL, 1, 1, PBM_WHITE));
+  image.data = data;
+  image.alignment = (pbm_data_alignment)99;
+  CHECK(PBM_ARGUMENTS == pbm_scroll(&image, NULL, 1, 1, PBM_WHITE));
+  return TEST_RESULT("scroll");
+}
+
+static void checkAlignment(pbm_data_alignment alignment) {
+  // Byte aligned, unaligned, single pixel and clipped rectangles
+  const pbm_rect rects[] = {{0, 0, WIDTH, HEIGHT}, {8, 8, 16, 16},
+                            {3, 5, 27, 19},        {9, 2, 1, 13},
+                            {4, 11, 30, 1},        {30, 20, 100, 100},
+                            {WIDTH, 0, 5, 5}};
+  const int32_t distances[] = {0, 1, -1, 3, -7, 8, -9, 13, 40, -40};
+  const size_t distanceCount = sizeof(distances) / sizeof(distances[0]);
+  for (size_t i = 0; i < distanceCount; i++) {
+    for (size_t j = 0; j < distanceCount; j++) {
+      pbm_colors fill = ((i + j) % 2) ? PBM_BLACK : PBM_WHITE;
+      checkScroll(alignment, NULL, distances[i], distances[j], fill);
+      for (size_t k = 0; k < sizeof(rects) / sizeof(rects[0]); k++) {
+        checkScroll(alignment, &rects[k], distances[i], distances[j], fill);
+      }
+    }
+  }
+}
+
+static void checkScroll(pbm_data_alignment alignment, const pbm_rect *rect,
+                        int32_t dx, int32_t dy, pbm_colors fill) {
+  uint8_t data[DATA_SIZE];
+  uint8_t originalData[DATA_SIZE];
+  for (uint32_t i = 0; i < DATA_SIZE; i++) {
+    seed = seed * 1103515245u + 12345u;
+    data[i] = (uint8_t)(seed >> 16);
+  }
+  memcpy(originalData, data, DATA_SIZE);
+  pbm_image image = {WIDTH, HEIGHT, alignment, data};
+  const pbm_image original = {WIDTH, HEIGHT, alignment, originalData};
+  CHECK(PBM_OK == pbm_scroll(&image, rect, dx, dy, fill));
+
+  int64_t left = 0;
+  int64_t top = 0;
+  int64_t right = WIDTH;
+  int64_t bottom = HEIGHT;
+  if (NULL != rect) {
+    left = (rect->x < WIDTH) ? rect->x : WIDTH;
+    top = (rect->y < HEIGHT) ? rect->y : HEIGHT;
+    right = ((int64_t)rect->x + rect->width < WIDTH) ? rect->x + rect->width
+                                                     : WIDTH;
+    bottom = ((int64_t)rect->y + rect->height < HEIGHT)
+                 ? rect->y + rect->height
+                 : HEIGHT;
+  }
+  uint32_t errors = 0;
+  for (int64_t y = 0; y < HEIGHT; y++) {
+    for (int64_t x = 0; x < WIDTH; x++) {
+      int expected = testPixel(&original, (uint32_t)x, (uint32_t)y);
+      if (x >= left && x < right && y >= top && y < bottom) {
+        int64_t srcX = x - dx;
+        int64_t srcY = y - dy;
+        if (srcX >= left && srcX < right && srcY >= top && srcY < bottom) {
+          expected = testPixel(&original, (uint32_t)srcX, (uint32_t)srcY);
+        } else {
+          expected = (PBM_BLACK == fill);
+        }
+      }
+      errors += (expected != testPixel(&image, (uint32_t)x, (uint32_t)y));
+    }
+  }
+  CHECK(0 == errors);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test_setPixels.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the batched pixel plotting
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#define WIDTH (37)   ///< Width of the test images
+#define HEIGHT (29)  ///< Height of the test images
+#define POINTS (600) ///< Points of the point cloud
+#define DATA_SIZE (WIDTH * ((HEIGHT + 7) / 8) + HEIGHT * ((WIDTH + 7) / 8))
+
+/**
+ * @brief Create a point cloud with points outside of the image and points at
+ * the image end
+ *
+ * @param points the created points
+ */
+static void createPoints(pbm_point *points);
+
+/**
+ * @brief Byte position of a point in the image data
+ *
+ * @param image the image
+ * @param point the point inside of the image
+ * @return uint32_t the byte index
+ */
+static uint32_t bytePosition(const pbm_image *image, pbm_point point);
+
+/**
+ * @brief Compare pbm_setPixels with pbm_setPixel in an alignment
+ *
+ * @param alignment the data alignment
+ */
+static void checkAlignment(pbm_data_alignment alignment);
+
+int main(void) {
+  checkAlignment(PBM_DATA_HORIZONTAL_MSB);
+  checkAlignment(PBM_DATA_HORIZONTAL_LSB);
+  checkAlignment(PBM_DATA_VERTICAL_MSB);
+  checkAlignment(PBM_DATA_VERTICAL_LSB);
+  return TEST_RESULT("setPixels");
+}
+
+static void createPoints(pbm_point *points) {
+  uint32_t seed = 12345;
+  for (uint32_t i = 0; i < POINTS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    points[i].x = (seed >> 8) % (WIDTH + 2);
+    seed = seed * 1103515245u + 12345u;
+    points[i].y = (seed >> 8) % (HEIGHT + 2);
+    if (0 == i % 17) {
+      points[i].x = PBM_IMAGE_END;
+    }
+    if (0 == i % 23) {
+      points[i].y = PBM_IMAGE_END;
+    }
+  }
+}
+
+static uint32_t bytePosition(const pbm_image *image, pbm_point point) {
+  if (PBM_DATA_VERTICAL_MSB == image->alignment ||
+      PBM_DATA_VERTICAL_LSB == image->alignment) {
+    return point.y / 8 * image->width + point.x;
+  }
+  return point.y * ((image->width + 7) / 8) + point.x / 8;
+}
+
+static void checkAlignment(pbm_data_alignment alignment) {
+  uint8_t expectedData[DATA_SIZE];
+  uint8_t unsortedData[DATA_SIZE];
+  uint8_t sortedData[DATA_SIZE];
+  pbm_image expected = {WIDTH, HEIGHT, alignment, expectedData};
+  pbm_image unsorted = {WIDTH, HEIGHT, alignment, unsortedData};
+  pbm_image sorted = {WIDTH, HEIGHT, alignment, sortedData};
+  size_t size = 0;
+  pbm_imageDataSize(&expected, &size);
+  pbm_point points[POINTS];
+  createPoints(points);
+
+  for (int color = PBM_BLACK; color >= PBM_WHITE; color--) {
+    pbm_fill(&expected, !color);
+    pbm_fill(&unsorted, !color);
+    pbm_fill(&sorted, !color);
+    pbm_return expectedResult = PBM_OK;
+    for (uint32_t i = 0; i < POINTS; i++) {
+      if (PBM_OK !=
+          pbm_setPixel(&expected, points[i].x, points[i].y, color)) {
+        expectedResult = PBM_OUT_OF_RANGE;
+      }
+    }
+    CHECK(expectedResult ==
+          pbm_setPixels(&unsorted, points, POINTS, color));
+    CHECK(0 == memcmp(expectedData, unsortedData, size));
+
+    pbm_point sortedPoints[POINTS];
+    memcpy(sortedPoints, points, sizeof(points));
+    CHECK(PBM_OK == pbm_sortPoints(&sorted, sortedPoints, POINTS));
+    CHECK(expectedResult ==
+          pbm_setPixels(&sorted, sortedPoints, POINTS, color));
+    CHECK(0 == memcmp(expectedData, sortedData, size));
+
+    // The points inside of the image are in the order of their bytes
+    uint32_t unordered = 0;
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < POINTS; i++) {
+      pbm_point point = sortedPoints[i];
+      point.x = (PBM_IMAGE_END == point.x) ? WIDTH - 1 : point.x;
+      point.y = (PBM_IMAGE_END == point.y) ? HEIGHT - 1 : point.y;
+      if (point.x >= WIDTH || point.y >= HEIGHT) {
+        continue;
+      }
+      uint32_t position = bytePosition(&sorted, point);
+      unordered += (position < previous);
+      previous = position;
+    }
+    CHECK(0 == unordered);
+  }
+}
@@ -0,0 +1,260 @@
+/**
+ * @file test_streamIndex.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of seeking in streams with a saved and loaded index
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+// mkfifo and fork
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "pbm_io.h"
+#include "test.h"
+
+#define IMAGES (20)         ///< Images in the test stream
+#define STREAM "stream.pbm" ///< Path of the test stream
+#define INDEX "stream.idx"  ///< Path of the saved index
+#define BROKEN "broken.idx" ///< Path of the changed index files
+#define FIFO "stream.fifo"  ///< Path of the sequentially read stream
+
+/**
+ * @brief Write the images in P4 and P1 with whitespace between them
+ *
+ * @param images the created images
+ * @return size_t the size of the stream file
+ */
+static size_t createStream(pbm_image *images);
+
+/**
+ * @brief Compare all pixels of two images
+ *
+ * @param image the decoded image
+ * @param expected the original image
+ * @return int 1 if the images are equal
+ */
+static int sameImage(const pbm_image *image, const pbm_image *expected);
+
+/**
+ * @brief Seek to every image in random order and decode it
+ *
+ * @param stream the stream with an index or without
+ * @param images the expected images
+ */
+static void checkSeek(pbm_stream *stream, const pbm_image *images);
+
+/**
+ * @brief Load changed copies of the saved index, all are rejected
+ *
+ * @param stream the stream of the index
+ */
+static void checkBrokenIndex(pbm_stream *stream);
+
+/**
+ * @brief Read the stream sequentially from a pipe
+ *
+ * @param images the expected images
+ */
+static void checkFifo(const pbm_image *images);
+
+static uint32_t seed = 12345;
+
+int main(void) {
+  pbm_image images[IMAGES];
+  size_t size = createStream(images);
+
+  // The index is built on the first seek
+  pbm_stream stream;
+  CHECK(PBM_OK == pbm_openStream(STREAM, &stream));
+  CHECK(NULL != stream.mapping && size == stream.size);
+  CHECK(NULL == stream.offsets);
+  checkSeek(&stream, images);
+  size_t count = 0;
+  CHECK(PBM_OK == pbm_streamCount(&stream, &count) && IMAGES == count);
+  CHECK(PBM_OK == pbm_saveStreamIndex(&stream, INDEX));
+
+  // A loaded index has the same offsets
+  pbm_stream loaded;
+  CHECK(PBM_OK == pbm_openStream(STREAM, &loaded));
+  CHECK(PBM_OK == pbm_loadStreamIndex(&loaded, INDEX));
+  CHECK(IMAGES == loaded.count);
+  CHECK(0 == memcmp(stream.offsets, loaded.offsets,
+                    IMAGES * sizeof(*stream.offsets)));
+  checkSeek(&loaded, images);
+  checkBrokenIndex(&loaded);
+  // A rejected index keeps the previous one
+  CHECK(IMAGES == loaded.count && NULL != loaded.offsets);
+  pbm_closeStream(&loaded);
+  pbm_closeStream(&stream);
+
+  checkFifo(images);
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    free(images[i].data);
+  }
+  unlink(STREAM);
+  unlink(INDEX);
+  unlink(BROKEN);
+  return TEST_RESULT("streamIndex");
+}
+
+static size_t createStream(pbm_image *images) {
+  FILE *file = fopen(STREAM, "wb");
+  CHECK(NULL != file);
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    seed = seed * 1103515245u + 12345u;
+    images[i].width = 1 + (seed >> 8) % 70;
+    seed = seed * 1103515245u + 12345u;
+    images[i].height = 1 + (seed >> 8) % 20;
+    images[i].alignment = PBM_DATA_HORIZONTAL_MSB;
+    size_t bytes = ((size_t)images[i].width + 7) / 8 * images[i].height;
+    images[i].data = (uint8_t *)malloc(bytes);
+    for (size_t j = 0; j < bytes; j++) {
+      seed = seed * 1103515245u + 12345u;
+      images[i].data[j] = (uint8_t)(seed >> 16);
+    }
+    pbm_format format = (i % 3) ? PBM_FORMAT_BINARY : PBM_FORMAT_PLAIN;
+    CHECK(PBM_OK == pbm_encodeToFileFormat(file, &images[i], format));
+    fputs((i % 2) ? "\n" : " \t\n", file);
+  }
+  long size = ftell(file);
+  fclose(file);
+  return (size_t)size;
+}
+
+static int sameImage(const pbm_image *image, const pbm_image *expected) {
+  if (image->width != expected->width || image->height != expected->height) {
+    return 0;
+  }
+  for (uint32_t y = 0; y < image->height; y++) {
+    for (uint32_t x = 0; x < image->width; x++) {
+      if (testPixel(image, x, y) != testPixel(expected, x, y)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+static void checkSeek(pbm_stream *stream, const pbm_image *images) {
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < 2 * IMAGES; i++) {
+    seed = seed * 1103515245u + 12345u;
+    size_t index = (seed >> 8) % IMAGES;
+    pbm_image image;
+    CHECK(PBM_OK == pbm_seekStream(stream, index));
+    CHECK(PBM_OK == pbm_readStream(stream, &image, PBM_DECODE_COPY));
+    errors += !sameImage(&image, &images[index]);
+    free(image.data);
+    // The next image follows without a seek
+    if (index + 1 < IMAGES) {
+      CHECK(PBM_OK == pbm_readStream(stream, &image, PBM_DECODE_COPY));
+      errors += !sameImage(&image, &images[index + 1]);
+      free(image.data);
+    }
+  }
+  CHECK(0 == errors);
+  CHECK(PBM_OUT_OF_RANGE == pbm_seekStream(stream, IMAGES));
+  pbm_image image;
+  CHECK(PBM_OK == pbm_seekStream(stream, IMAGES - 1));
+  CHECK(PBM_OK == pbm_readStream(stream, &image, PBM_DECODE_COPY));
+  free(image.data);
+  CHECK(PBM_OUT_OF_RANGE ==
+        pbm_readStream(stream, &image, PBM_DECODE_COPY));
+}
+
+static void checkBrokenIndex(pbm_stream *stream) {
+  uint8_t saved[(3 + IMAGES) * 8 + 1];
+  FILE *file = fopen(INDEX, "rb");
+  CHECK(NULL != file);
+  size_t size = fread(saved, 1, sizeof(saved), file);
+  fclose(file);
+  CHECK(sizeof(saved) - 1 == size);
+
+  // Magic, stream size, count, order and range of the offsets, truncated and
+  // too long files
+  const size_t changes[] = {0, 8, 16, 3 * 8, 4 * 8, 5 * 8, (3 + IMAGES) * 8};
+  for (size_t i = 0; i < sizeof(changes) / sizeof(changes[0]); i++) {
+    uint8_t broken[sizeof(saved)];
+    memcpy(broken, saved, size);
+    size_t brokenSize = size;
+    if (changes[i] == size) {
+      broken[brokenSize++] = 0;
+    } else if (4 * 8 == changes[i]) {
+      // Equal to the previous offset
+      memcpy(&broken[changes[i]], &broken[changes[i] - 8], 8);
+    } else if (5 * 8 == changes[i]) {
+      brokenSize = changes[i] + 3;
+    } else {
+      broken[changes[i] + 1] ^= 0x40;
+    }
+    file = fopen(BROKEN, "wb");
+    CHECK(NULL != file && brokenSize == fwrite(broken, 1, brokenSize, file));
+    fclose(file);
+    CHECK(PBM_ERROR == pbm_loadStreamIndex(stream, BROKEN));
+  }
+  CHECK(PBM_ERROR == pbm_loadStreamIndex(stream, "missing.idx"));
+}
+
+static void checkFifo(const pbm_image *images) {
+  unlink(FIFO);
+  CHECK(0 == mkfifo(FIFO, 0600));
+  pid_t writer = fork();
+  if (0 == writer) {
+    // Copy the stream file into the pipe
+    FILE *source = fopen(STREAM, "rb");
+    FILE *fifo = fopen(FIFO, "wb");
+    int byte;
+    while (NULL != source && NULL != fifo && EOF != (byte = fgetc(source))) {
+      fputc(byte, fifo);
+    }
+    // _exit does not flush the streams
+    if (NULL != fifo) {
+      fclose(fifo);
+    }
+    _exit(0);
+  }
+  CHECK(writer > 0);
+  pbm_stream stream;
+  CHECK(PBM_OK == pbm_openStream(FIFO, &stream));
+  CHECK(NULL == stream.mapping && NULL != stream.file);
+  pbm_image image;
+  // Pipes can not be aliased or indexed
+  CHECK(PBM_ARGUMENTS == pbm_readStream(&stream, &image, PBM_DECODE_ALIAS));
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < IMAGES; i++) {
+    pbm_return ret = pbm_readStream(&stream, &image, PBM_DECODE_COPY);
+    CHECK(PBM_OK == ret);
+    if (PBM_OK == ret) {
+      errors += !sameImage(&image, &images[i]);
+      free(image.data);
+    }
+  }
+  CHECK(0 == errors);
+  CHECK(PBM_OUT_OF_RANGE == pbm_readStream(&stream, &image, PBM_DECODE_COPY));
+  CHECK(PBM_ERROR == pbm_seekStream(&stream, 0));
+  pbm_closeStream(&stream);
+  waitpid(writer, NULL, 0);
+  unlink(FIFO);
+}
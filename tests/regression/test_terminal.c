@@ -0,0 +1,228 @@
+/**
+ * @file test_terminal.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the terminal escape sequences and the dirty cells
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_terminal.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define ROWS (4)     ///< Rows of the test terminal
+#define COLUMNS (10) ///< Columns of the test terminal
+#define WIDTH (64)   ///< Width of the test image
+#define HEIGHT (40)  ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+
+/**
+ * @brief Get a shown cell of the terminal
+ *
+ * @param terminal the terminal
+ * @param row the shown row
+ * @param column the column
+ * @return const pbm_terminalCell* the cell
+ */
+static const pbm_terminalCell *cellAt(const pbm_terminal *terminal,
+                                      uint32_t row, uint32_t column);
+
+/**
+ * @brief Compare the characters of a shown row
+ *
+ * @param terminal the terminal
+ * @param row the shown row
+ * @param text the expected characters of all columns
+ * @return int 1 if the row is equal
+ */
+static int rowIs(const pbm_terminal *terminal, uint32_t row, const char *text);
+
+/**
+ * @brief Count the dirty cells of a shown row
+ *
+ * @param terminal the terminal
+ * @param row the shown row
+ * @return uint32_t number of dirty cells
+ */
+static uint32_t dirtyCells(const pbm_terminal *terminal, uint32_t row);
+
+/**
+ * @brief Flush the terminal and compare the image with all cells drawn new
+ *
+ * @param terminal the terminal
+ */
+static void checkFlush(pbm_terminal *terminal);
+
+static uint8_t imageData[DATA_SIZE];
+static pbm_image image = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, imageData};
+
+int main(void) {
+  const pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                         .width = 6,
+                         .height = 8,
+                         .alignment = PBM_DATA_HORIZONTAL_MSB};
+  pbm_terminalCell cells[ROWS * COLUMNS];
+  pbm_terminal terminal;
+  pbm_fill(&image, PBM_WHITE);
+  CHECK(PBM_SIZE == pbm_initTerminal(&terminal, &image, 8, 0, &font, ROWS,
+                                     COLUMNS, cells, PBM_BLACK));
+  CHECK(PBM_OK == pbm_initTerminal(&terminal, &image, 2, 3, &font, ROWS,
+                                   COLUMNS, cells, PBM_BLACK));
+  CHECK(COLUMNS == dirtyCells(&terminal, 0));
+  checkFlush(&terminal);
+  CHECK(0 == dirtyCells(&terminal, 0));
+
+  // Only changed cells get dirty
+  pbm_writeTerminal(&terminal, "ab");
+  CHECK(rowIs(&terminal, 0, "ab        "));
+  CHECK(2 == dirtyCells(&terminal, 0) && 0 == dirtyCells(&terminal, 1));
+  checkFlush(&terminal);
+  pbm_writeTerminal(&terminal, "\rab");
+  CHECK(0 == dirtyCells(&terminal, 0));
+
+  // Cursor movement, also with sequences split over several calls
+  pbm_writeTerminal(&terminal, "\x1b[3;4Hc");
+  CHECK(rowIs(&terminal, 2, "   c      "));
+  CHECK(2 == terminal.cursorRow && 4 == terminal.cursorColumn);
+  pbm_writeTerminal(&terminal, "\x1b[");
+  pbm_writeTerminal(&terminal, "2;");
+  pbm_writeTerminal(&terminal, "8fd");
+  CHECK(rowIs(&terminal, 1, "       d  "));
+  pbm_writeTerminal(&terminal, "\x1b[A\x1b[2De");
+  CHECK(rowIs(&terminal, 0, "ab    e   "));
+  pbm_writeTerminal(&terminal, "\x1b[99B\x1b[99C");
+  CHECK(ROWS - 1 == terminal.cursorRow && COLUMNS - 1 == terminal.cursorColumn);
+  pbm_writeTerminal(&terminal, "\x1b[99A\x1b[99D");
+  CHECK(0 == terminal.cursorRow && 0 == terminal.cursorColumn);
+  pbm_writeTerminal(&terminal, "\x1b[H\x1b[?25l");
+  CHECK(0 == terminal.cursorRow && 0 == terminal.cursorColumn);
+  checkFlush(&terminal);
+
+  // Tab, backspace and carriage return
+  pbm_writeTerminal(&terminal, "\x1b[4;1H\tx\by\rz");
+  CHECK(rowIs(&terminal, 3, "z       y "));
+  CHECK(2 == dirtyCells(&terminal, 3));
+
+  // Attributes of the written characters
+  pbm_writeTerminal(&terminal, "\x1b[2;1H\x1b[1;4mB\x1b[22mU\x1b[7mI\x1b[0mN");
+  CHECK((PBM_TERMINAL_BOLD | PBM_TERMINAL_UNDERLINE) ==
+        (cellAt(&terminal, 1, 0)->attributes & ~PBM_TERMINAL_DIRTY));
+  CHECK(PBM_TERMINAL_UNDERLINE ==
+        (cellAt(&terminal, 1, 1)->attributes & ~PBM_TERMINAL_DIRTY));
+  CHECK((PBM_TERMINAL_UNDERLINE | PBM_TERMINAL_INVERSE) ==
+        (cellAt(&terminal, 1, 2)->attributes & ~PBM_TERMINAL_DIRTY));
+  CHECK(0 == (cellAt(&terminal, 1, 3)->attributes & ~PBM_TERMINAL_DIRTY));
+  checkFlush(&terminal);
+  // The same character with other attributes is a change
+  pbm_writeTerminal(&terminal, "\x1b[2;4H\x1b[1mN\x1b[m");
+  CHECK(1 == dirtyCells(&terminal, 1));
+  checkFlush(&terminal);
+
+  // Erase in line and in display
+  pbm_writeTerminal(&terminal, "\x1b[1;1H0123456789\x1b[1;4H\x1b[K");
+  CHECK(rowIs(&terminal, 0, "012       "));
+  pbm_writeTerminal(&terminal, "\x1b[1;1H0123456789\x1b[1;4H\x1b[1K");
+  CHECK(rowIs(&terminal, 0, "    456789"));
+  pbm_writeTerminal(&terminal, "\x1b[2K");
+  CHECK(rowIs(&terminal, 0, "          "));
+  pbm_writeTerminal(&terminal, "\x1b[1;1Habc\x1b[3;2H\x1b[1J");
+  CHECK(rowIs(&terminal, 0, "          ") && rowIs(&terminal, 1, "          "));
+  CHECK(rowIs(&terminal, 2, "   c      ") && rowIs(&terminal, 3, "z       y "));
+  pbm_writeTerminal(&terminal, "\x1b[4;5H\x1b[J");
+  CHECK(rowIs(&terminal, 3, "z         "));
+  checkFlush(&terminal);
+
+  // Scrolling moves the image rows, only the new row is dirty
+  pbm_writeTerminal(&terminal, "\x1b[2J\x1b[H1\n2\n3\n4");
+  checkFlush(&terminal);
+  pbm_writeTerminal(&terminal, "\n5");
+  CHECK(rowIs(&terminal, 0, "2         ") && rowIs(&terminal, 3, "5         "));
+  CHECK(0 == dirtyCells(&terminal, 0) && 0 == dirtyCells(&terminal, 2));
+  CHECK(1 == terminal.scrolledRows);
+  checkFlush(&terminal);
+  // A line longer than the terminal wraps
+  pbm_writeTerminal(&terminal, "\nabcdefghijklm");
+  CHECK(rowIs(&terminal, 2, "abcdefghij") && rowIs(&terminal, 3, "klm       "));
+  checkFlush(&terminal);
+  // More scrolled rows than the terminal redraws everything
+  pbm_writeTerminal(&terminal, "\n\n\n\n\n\nlast");
+  CHECK(rowIs(&terminal, 3, "last      "));
+  checkFlush(&terminal);
+  CHECK(PBM_OUT_OF_RANGE == pbm_setTerminalCursor(&terminal, ROWS, 0));
+  CHECK(PBM_OK == pbm_clearTerminal(&terminal));
+  checkFlush(&terminal);
+  return TEST_RESULT("terminal");
+}
+
+static const pbm_terminalCell *cellAt(const pbm_terminal *terminal,
+                                      uint32_t row, uint32_t column) {
+  uint32_t cellRow = (terminal->firstRow + row) % terminal->rows;
+  return &terminal->cells[cellRow * terminal->columns + column];
+}
+
+static int rowIs(const pbm_terminal *terminal, uint32_t row,
+                 const char *text) {
+  for (uint32_t column = 0; column < terminal->columns; column++) {
+    if (cellAt(terminal, row, column)->character != (uint8_t)text[column]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static uint32_t dirtyCells(const pbm_terminal *terminal, uint32_t row) {
+  uint32_t dirty = 0;
+  for (uint32_t column = 0; column < terminal->columns; column++) {
+    dirty += (0 != (cellAt(terminal, row, column)->attributes &
+                    PBM_TERMINAL_DIRTY));
+  }
+  return dirty;
+}
+
+static void checkFlush(pbm_terminal *terminal) {
+  CHECK(PBM_OK == pbm_flushTerminal(terminal));
+  uint32_t dirty = 0;
+  for (uint32_t row = 0; row < terminal->rows; row++) {
+    dirty += dirtyCells(terminal, row);
+  }
+  CHECK(0 == dirty && 0 == terminal->scrolledRows);
+
+  uint8_t expectedData[DATA_SIZE];
+  pbm_image expected = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, expectedData};
+  pbm_fill(&expected, PBM_WHITE);
+  const pbm_font *font = terminal->font;
+  for (uint32_t row = 0; row < terminal->rows; row++) {
+    for (uint32_t column = 0; column < terminal->columns; column++) {
+      const pbm_terminalCell *cell = cellAt(terminal, row, column);
+      pbm_textStyle style = {.mode = PBM_TEXT_OPAQUE};
+      style.emphasis |=
+          (cell->attributes & PBM_TERMINAL_BOLD) ? PBM_TEXT_BOLD : 0;
+      style.emphasis |=
+          (cell->attributes & PBM_TERMINAL_UNDERLINE) ? PBM_TEXT_UNDERLINE : 0;
+      pbm_colors color =
+          (cell->attributes & PBM_TERMINAL_INVERSE) ? PBM_WHITE : PBM_BLACK;
+      pbm_writeCharStyled(&expected, terminal->x + column * font->width,
+                          terminal->y + row * font->height, color, font,
+                          &style, cell->character);
+    }
+  }
+  CHECK(0 == memcmp(imageData, expectedData, DATA_SIZE));
+}
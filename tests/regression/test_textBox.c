@@ -0,0 +1,184 @@
+/**
+ * @file test_textBox.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the text box wrapping and justification
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (64)  ///< Width of the test image
+#define HEIGHT (48) ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+#define BOX_X (3)      ///< Left border of the text box
+#define BOX_WIDTH (41) ///< Six characters of the 6x8 font
+
+static const char text[] = "ab cd efgh ijklmnop q\nxy";
+
+/**
+ * @brief Expected line of a text box layout
+ *
+ */
+typedef struct {
+  uint32_t start;
+  uint32_t length;
+  uint32_t width;
+  uint16_t spaces;
+  uint8_t lastLine;
+} expectedLine;
+
+static const expectedLine wordLines[] = {{0, 5, 34, 1, 0},
+                                         {6, 4, 27, 0, 0},
+                                         {11, 6, 41, 0, 0},
+                                         {17, 4, 27, 1, 1},
+                                         {22, 2, 13, 0, 1}};
+
+static const expectedLine characterLines[] = {{0, 5, 34, 1, 0},
+                                              {6, 6, 41, 1, 0},
+                                              {12, 6, 41, 0, 0},
+                                              {18, 3, 20, 1, 1},
+                                              {22, 2, 13, 0, 1}};
+
+/**
+ * @brief Check the line breaks of a wrap mode
+ *
+ * @param font the font
+ * @param wrapMode the wrap mode
+ * @param lines the expected lines
+ * @param count number of expected lines
+ */
+static void checkLines(const pbm_font *font, pbm_wrapMode wrapMode,
+                       const expectedLine *lines, uint32_t count);
+
+/**
+ * @brief Check the justified lines fill the box width
+ *
+ * @param font the font
+ */
+static void checkJustified(const pbm_font *font);
+
+/**
+ * @brief Check the cache detects a changed text behind the same pointer
+ *
+ * @param font the font
+ */
+static void checkCache(const pbm_font *font);
+
+static uint8_t imageData[DATA_SIZE];
+static pbm_image image = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, imageData};
+static const pbm_rect box = {BOX_X, 2, BOX_WIDTH, HEIGHT - 2};
+
+int main(void) {
+  pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                   .width = 6,
+                   .height = 8,
+                   .alignment = PBM_DATA_HORIZONTAL_MSB};
+  checkLines(&font, PBM_WRAP_WORD, wordLines,
+             sizeof(wordLines) / sizeof(wordLines[0]));
+  checkLines(&font, PBM_WRAP_CHARACTER, characterLines,
+             sizeof(characterLines) / sizeof(characterLines[0]));
+  checkJustified(&font);
+  checkCache(&font);
+  return TEST_RESULT("textBox");
+}
+
+static void checkLines(const pbm_font *font, pbm_wrapMode wrapMode,
+                       const expectedLine *lines, uint32_t count) {
+  pbm_textBoxCache cache;
+  memset(&cache, 0, sizeof(cache));
+  pbm_fill(&image, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, wrapMode, NULL, text,
+                                   &cache));
+  CHECK(count == cache.lineCount);
+  for (uint32_t i = 0; i < count && i < cache.lineCount; i++) {
+    const pbm_textLine *line = &cache.lines[i];
+    CHECK(lines[i].start == line->start);
+    CHECK(lines[i].length == line->length);
+    CHECK(lines[i].width == line->width);
+    CHECK(lines[i].spaces == line->spaces);
+    CHECK(lines[i].lastLine == line->lastLine);
+  }
+}
+
+static void checkJustified(const pbm_font *font) {
+  uint8_t expectedData[DATA_SIZE];
+  pbm_image expected = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, expectedData};
+  pbm_fill(&image, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_JUSTIFY_TOP, PBM_WRAP_WORD, NULL,
+                                   text, NULL));
+  // The first line gets the free pixels in its single space, the other lines
+  // have no space or end a paragraph and stay left aligned
+  const uint32_t step = font->height + 1;
+  pbm_fill(&expected, PBM_WHITE);
+  pbm_writeString(&expected, BOX_X, 2, PBM_BLACK, font, PBM_STRING_LEFT_TOP,
+                  "ab");
+  pbm_writeString(&expected, BOX_X + BOX_WIDTH, 2, PBM_BLACK, font,
+                  PBM_STRING_RIGHT_TOP, "cd");
+  pbm_writeString(&expected, BOX_X, 2 + step, PBM_BLACK, font,
+                  PBM_STRING_LEFT_TOP, "efgh");
+  pbm_writeString(&expected, BOX_X, 2 + 2 * step, PBM_BLACK, font,
+                  PBM_STRING_LEFT_TOP, "ijklmn");
+  pbm_writeString(&expected, BOX_X, 2 + 3 * step, PBM_BLACK, font,
+                  PBM_STRING_LEFT_TOP, "op q");
+  pbm_writeString(&expected, BOX_X, 2 + 4 * step, PBM_BLACK, font,
+                  PBM_STRING_LEFT_TOP, "xy");
+  CHECK(0 == memcmp(imageData, expectedData, DATA_SIZE));
+}
+
+static void checkCache(const pbm_font *font) {
+  char changing[16] = "one two three";
+  pbm_textBoxCache cache;
+  memset(&cache, 0, sizeof(cache));
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, PBM_WRAP_WORD, NULL,
+                                   changing, &cache));
+  CHECK(3 == cache.lineCount && 3 == cache.lines[0].length);
+  // A changed content is found by the hash of the text
+  strcpy(changing, "seven six");
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, PBM_WRAP_WORD, NULL,
+                                   changing, &cache));
+  CHECK(2 == cache.lineCount && 5 == cache.lines[0].length);
+  // Without the hash only an invalidation renews the layout
+  cache.skipTextHash = 1;
+  strcpy(changing, "one two three");
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, PBM_WRAP_WORD, NULL,
+                                   changing, &cache));
+  CHECK(2 == cache.lineCount && 5 == cache.lines[0].length);
+  pbm_invalidateTextBox(&cache);
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &box, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, PBM_WRAP_WORD, NULL,
+                                   changing, &cache));
+  CHECK(3 == cache.lineCount && 3 == cache.lines[0].length);
+  // A changed box size is found without the hash
+  pbm_rect smallBox = box;
+  smallBox.height = 8;
+  CHECK(PBM_OK == pbm_writeTextBox(&image, &smallBox, PBM_BLACK, font,
+                                   PBM_STRING_LEFT_TOP, PBM_WRAP_WORD, NULL,
+                                   changing, &cache));
+  CHECK(1 == cache.lineCount);
+}
@@ -0,0 +1,181 @@
+/**
+ * @file test_textCache.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the text cache and the bitmap blits
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_textCache.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (64)  ///< Width of the test images
+#define HEIGHT (40) ///< Height of the test images
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+
+/**
+ * @brief Check the cached strings and the counters of hits, misses and
+ * evictions
+ *
+ * @param font the font
+ */
+static void checkCache(const pbm_font *font);
+
+/**
+ * @brief Draw a string through the cache and directly and compare the images
+ *
+ * @param cache the text cache
+ * @param font the font
+ * @param style the text style
+ * @param msg the string
+ * @return int 1 if the images are equal
+ */
+static int sameAsDirect(pbm_textCache *cache, const pbm_font *font,
+                        const pbm_textStyle *style, const char *msg);
+
+/**
+ * @brief Check the line and page wise bitmap blits against single pixels
+ *
+ * @param alignment the alignment of the image and the bitmap
+ */
+static void checkBlit(pbm_data_alignment alignment);
+
+int main(void) {
+  const pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                         .width = 6,
+                         .height = 8,
+                         .alignment = PBM_DATA_HORIZONTAL_MSB};
+  checkCache(&font);
+  for (int alignment = 0; alignment < PBM_DATA_MAX_ALIGNMENTS; alignment++) {
+    checkBlit((pbm_data_alignment)alignment);
+  }
+  CHECK(pbm_hashString("abc") != pbm_hashString("abd"));
+  CHECK(pbm_hashString(NULL) == pbm_hashString(""));
+  return TEST_RESULT("textCache");
+}
+
+static void checkCache(const pbm_font *font) {
+  pbm_textCache cache;
+  pbm_textStyle transparent = {.mode = PBM_TEXT_TRANSPARENT};
+  // Measure the size of one entry
+  CHECK(PBM_OK == pbm_initTextCache(&cache, 1 << 20));
+  CHECK(sameAsDirect(&cache, font, NULL, "aaa"));
+  size_t entrySize = cache.used;
+  CHECK(1 == cache.entries && 1 == cache.misses && 0 == cache.hits);
+  pbm_clearTextCache(&cache);
+  CHECK(0 == cache.used && 0 == cache.entries);
+
+  // Two strings of the same size fit into the budget
+  CHECK(PBM_OK == pbm_initTextCache(&cache, 2 * entrySize + entrySize / 2));
+  CHECK(sameAsDirect(&cache, font, NULL, "aaa"));
+  CHECK(sameAsDirect(&cache, font, NULL, "bbb"));
+  CHECK(2 == cache.misses && 0 == cache.hits && 2 == cache.entries);
+  CHECK(sameAsDirect(&cache, font, NULL, "aaa"));
+  CHECK(1 == cache.hits);
+  // The least recently used string "bbb" is evicted
+  CHECK(sameAsDirect(&cache, font, NULL, "ccc"));
+  CHECK(3 == cache.misses && 1 == cache.evictions && 2 == cache.entries);
+  CHECK(sameAsDirect(&cache, font, NULL, "aaa"));
+  CHECK(2 == cache.hits);
+  CHECK(sameAsDirect(&cache, font, NULL, "bbb"));
+  CHECK(4 == cache.misses && 2 == cache.evictions);
+  CHECK(cache.used <= cache.budget);
+  // Another style is another string
+  uint32_t misses = cache.misses;
+  CHECK(sameAsDirect(&cache, font, &transparent, "bbb"));
+  CHECK(misses + 1 == cache.misses);
+  // A string larger than the budget is drawn without the cache
+  uint32_t entries = cache.entries;
+  CHECK(sameAsDirect(&cache, font, NULL, "a much longer string"));
+  CHECK(entries == cache.entries);
+  pbm_clearTextCache(&cache);
+}
+
+static int sameAsDirect(pbm_textCache *cache, const pbm_font *font,
+                        const pbm_textStyle *style, const char *msg) {
+  uint8_t cachedData[DATA_SIZE];
+  uint8_t directData[DATA_SIZE];
+  pbm_image cached = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, cachedData};
+  pbm_image direct = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, directData};
+  for (uint32_t i = 0; i < DATA_SIZE; i++) {
+    cachedData[i] = (uint8_t)(i * 29);
+    directData[i] = (uint8_t)(i * 29);
+  }
+  if (PBM_OK != pbm_writeStringCached(cache, &cached, 3, 5, PBM_BLACK, font,
+                                      PBM_STRING_LEFT_TOP, style, msg) ||
+      PBM_OK != pbm_writeStringStyled(&direct, 3, 5, PBM_BLACK, font,
+                                      PBM_STRING_LEFT_TOP, style, msg)) {
+    return 0;
+  }
+  return 0 == memcmp(cachedData, directData, DATA_SIZE);
+}
+
+static void checkBlit(pbm_data_alignment alignment) {
+  // Bitmap height not a multiple of 8 and positions off the byte borders,
+  // partly outside of the image
+  static const int32_t positions[][2] = {
+      {0, 0}, {3, 5}, {-4, -3}, {50, 30}, {17, 13}, {-9, 37}};
+  uint8_t bitmapData[3 * 20];
+  pbm_image bitmap = {20, 19, alignment, bitmapData};
+  for (uint32_t i = 0; i < sizeof(bitmapData); i++) {
+    bitmapData[i] = (uint8_t)(i * 73 + 11);
+  }
+  uint8_t blitData[DATA_SIZE];
+  uint8_t pixelData[DATA_SIZE];
+  pbm_image blit = {WIDTH, HEIGHT, alignment, blitData};
+  pbm_image pixels = {WIDTH, HEIGHT, alignment, pixelData};
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+    for (int colorIndex = 0; colorIndex < 2; colorIndex++) {
+      for (int modeIndex = 0; modeIndex < 2; modeIndex++) {
+        pbm_colors color = colorIndex ? PBM_BLACK : PBM_WHITE;
+        pbm_textMode mode = modeIndex ? PBM_TEXT_TRANSPARENT : PBM_TEXT_OPAQUE;
+        for (uint32_t j = 0; j < DATA_SIZE; j++) {
+          blitData[j] = (uint8_t)(j * 41 + 7);
+          pixelData[j] = (uint8_t)(j * 41 + 7);
+        }
+        uint32_t x = (uint32_t)positions[i][0];
+        uint32_t y = (uint32_t)positions[i][1];
+        CHECK(PBM_OK == pbm_drawBitmap(&blit, x, y, color,
+                                       PBM_STRING_LEFT_TOP, &bitmap, mode));
+        for (uint32_t v = 0; v < bitmap.height; v++) {
+          for (uint32_t u = 0; u < bitmap.width; u++) {
+            int set = testPixel(&bitmap, u, v);
+            // Positions left or above are skipped, -1 is PBM_IMAGE_END
+            if (positions[i][0] + (int32_t)u < 0 ||
+                positions[i][1] + (int32_t)v < 0) {
+              continue;
+            }
+            if (set || PBM_TEXT_OPAQUE == mode) {
+              pbm_setPixel(&pixels, x + u, y + v, set ? color : !color);
+            }
+          }
+        }
+        if (0 != memcmp(blitData, pixelData, DATA_SIZE)) {
+          printf("alignment %d position %d,%d color %d mode %d differs\n",
+                 (int)alignment, positions[i][0], positions[i][1],
+                 (int)color, (int)mode);
+          CHECK(0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file test_transparent.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the transparent text and the glyph ink boxes
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define GLYPHS (256) ///< Glyphs of the test font
+#define WIDTH (64)   ///< Width of the test image
+#define HEIGHT (12)  ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+
+static const char text[] = "Ink |.,'";
+
+/**
+ * @brief Check the ink boxes against the set pixels of every glyph
+ *
+ * @param font the font
+ * @param boxes the ink boxes of the font
+ */
+static void checkBoxes(const pbm_font *font, const pbm_glyphBox *boxes);
+
+/**
+ * @brief Check transparent text only changes the ink pixels
+ *
+ * @param font the font
+ * @param color the text color
+ */
+static void checkTransparent(const pbm_font *font, pbm_colors color);
+
+static pbm_glyphBox boxes[GLYPHS];
+
+int main(void) {
+  pbm_font font = {.fontData = &font_6x8H_MSB[0][0],
+                   .width = 6,
+                   .height = 8,
+                   .alignment = PBM_DATA_HORIZONTAL_MSB};
+  CHECK(PBM_OK == pbm_computeGlyphBoxes(&font, boxes, GLYPHS));
+  checkBoxes(&font, boxes);
+  // The same pixels with and without the ink boxes
+  for (int boxed = 0; boxed < 2; boxed++) {
+    font.glyphBoxes = boxed ? boxes : NULL;
+    checkTransparent(&font, PBM_BLACK);
+    checkTransparent(&font, PBM_WHITE);
+  }
+  return TEST_RESULT("transparent");
+}
+
+static void checkBoxes(const pbm_font *font, const pbm_glyphBox *boxes) {
+  uint8_t data[8];
+  pbm_image image = {font->width, font->height, PBM_DATA_HORIZONTAL_MSB,
+                     data};
+  uint32_t wrongBoxes = 0;
+  for (uint32_t glyph = 0; glyph < GLYPHS; glyph++) {
+    pbm_fill(&image, PBM_WHITE);
+    pbm_writeChar(&image, 0, 0, PBM_BLACK, font, (uint8_t)glyph);
+    pbm_glyphBox ink = {UINT8_MAX, UINT8_MAX, 0, 0};
+    for (uint32_t y = 0; y < font->height; y++) {
+      for (uint32_t x = 0; x < font->width; x++) {
+        if (testPixel(&image, x, y)) {
+          ink.xMin = (x < ink.xMin) ? (uint8_t)x : ink.xMin;
+          ink.yMin = (y < ink.yMin) ? (uint8_t)y : ink.yMin;
+          ink.xMax = (x > ink.xMax) ? (uint8_t)x : ink.xMax;
+          ink.yMax = (uint8_t)y;
+        }
+      }
+    }
+    const pbm_glyphBox *box = &boxes[glyph];
+    if (UINT8_MAX == ink.xMin) {
+      wrongBoxes += (box->xMin <= box->xMax);
+    } else {
+      wrongBoxes += (0 != memcmp(&ink, box, sizeof(ink)));
+    }
+  }
+  CHECK(0 == wrongBoxes);
+  CHECK(boxes[' '].xMin > boxes[' '].xMax);
+}
+
+static void checkTransparent(const pbm_font *font, pbm_colors color) {
+  uint8_t inkData[DATA_SIZE];
+  uint8_t drawnData[DATA_SIZE];
+  pbm_image ink = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, inkData};
+  pbm_image drawn = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, drawnData};
+  // The ink of the opaque text on a white background
+  pbm_fill(&ink, PBM_WHITE);
+  CHECK(PBM_OK == pbm_writeString(&ink, 3, 2, PBM_BLACK, font,
+                                  PBM_STRING_LEFT_TOP, text));
+
+  pbm_textStyle style;
+  memset(&style, 0, sizeof(style));
+  style.mode = PBM_TEXT_TRANSPARENT;
+  for (uint32_t i = 0; i < DATA_SIZE; i++) {
+    drawnData[i] = (uint8_t)(0xA5 ^ (i * 7));
+  }
+  CHECK(PBM_OK == pbm_writeStringStyled(&drawn, 3, 2, color, font,
+                                        PBM_STRING_LEFT_TOP, &style, text));
+  uint32_t wrongBytes = 0;
+  for (uint32_t i = 0; i < DATA_SIZE; i++) {
+    uint8_t background = (uint8_t)(0xA5 ^ (i * 7));
+    uint8_t expected = (PBM_BLACK == color) ? (background | inkData[i])
+                                            : (background & ~inkData[i]);
+    wrongBytes += (expected != drawnData[i]);
+  }
+  CHECK(0 == wrongBytes);
+}
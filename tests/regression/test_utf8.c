@@ -0,0 +1,128 @@
+/**
+ * @file test_utf8.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Regression test of the UTF-8 decoding of glyph map fonts
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "pbm_graphics.h"
+#include "test.h"
+
+#include "6x8_horizontal_MSB.h"
+
+#define WIDTH (64)  ///< Width of the test image
+#define HEIGHT (8)  ///< Height of the test image
+#define DATA_SIZE (WIDTH / 8 * HEIGHT)
+
+/**
+ * @brief UTF-8 input and the glyphs of the expected codepoints
+ *
+ */
+typedef struct {
+  const char *utf8;
+  const char *glyphs;
+} decodeCase;
+
+/**
+ * @brief Glyph map of the test, every mapped codepoint gets a letter glyph
+ *
+ */
+static const pbm_glyphRange glyphMap[] = {
+    {0x20, 0x5F, 0x20}, {0xE9, 1, 'e'},     {0x20AC, 1, 'E'},
+    {0xD7FF, 1, 'D'},   {0xD800, 1, 'X'},   {0xDFFF, 1, 'X'},
+    {0xE000, 1, 'P'},   {0x1F600, 1, 'S'},  {0x10FFFF, 1, 'M'},
+};
+
+static const decodeCase cases[] = {
+    // Valid sequences of every length and the borders of the ranges
+    {"A\xC3\xA9"
+     "B",
+     "AeB"},
+    {"\xE2\x82\xAC", "E"},
+    {"\xF0\x9F\x98\x80", "S"},
+    {"\xED\x9F\xBF", "D"},
+    {"\xEE\x80\x80", "P"},
+    {"\xF4\x8F\xBF\xBF", "M"},
+    // Overlong forms
+    {"\xC0\x80", "?"},
+    {"\xC1\x81", "?"},
+    {"\xE0\x80\x80", "?"},
+    {"\xE0\x81\x81", "?"},
+    {"\xF0\x80\x80\x80", "?"},
+    {"\xF0\x80\x81\x81", "?"},
+    // Surrogates
+    {"\xED\xA0\x80", "?"},
+    {"\xED\xBF\xBF", "?"},
+    // Codepoints above U+10FFFF and invalid lead bytes
+    {"\xF4\x90\x80\x80", "?"},
+    {"\xF5\x80\x80\x80", "????"},
+    {"\xF8\x88\x80\x80\x80", "?????"},
+    {"\xFF"
+     "A",
+     "?A"},
+    // Truncated sequences and lone continuation bytes
+    {"\xE2\x82"
+     "x",
+     "?x"},
+    {"\xF0\x9F"
+     "A",
+     "?A"},
+    {"\x80"
+     "A",
+     "?A"},
+};
+
+int main(void) {
+  pbm_font plain = {.fontData = &font_6x8H_MSB[0][0],
+                    .width = 6,
+                    .height = 8,
+                    .alignment = PBM_DATA_HORIZONTAL_MSB};
+  pbm_font mapped = plain;
+  mapped.glyphMap = glyphMap;
+  mapped.glyphMapCount = sizeof(glyphMap) / sizeof(glyphMap[0]);
+  mapped.defaultGlyph = '?';
+
+  uint8_t decodedData[DATA_SIZE];
+  uint8_t expectedData[DATA_SIZE];
+  pbm_image decoded = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, decodedData};
+  pbm_image expected = {WIDTH, HEIGHT, PBM_DATA_HORIZONTAL_MSB, expectedData};
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    pbm_textExtent decodedExtent;
+    pbm_textExtent expectedExtent;
+    CHECK(PBM_OK == pbm_measureString(&mapped, cases[i].utf8, &decodedExtent));
+    CHECK(PBM_OK ==
+          pbm_measureString(&plain, cases[i].glyphs, &expectedExtent));
+    CHECK(expectedExtent.width == decodedExtent.width);
+
+    pbm_fill(&decoded, PBM_WHITE);
+    pbm_fill(&expected, PBM_WHITE);
+    CHECK(PBM_OK == pbm_writeString(&decoded, 0, 0, PBM_BLACK, &mapped,
+                                    PBM_STRING_LEFT_TOP, cases[i].utf8));
+    CHECK(PBM_OK == pbm_writeString(&expected, 0, 0, PBM_BLACK, &plain,
+                                    PBM_STRING_LEFT_TOP, cases[i].glyphs));
+    if (0 != memcmp(decodedData, expectedData, DATA_SIZE)) {
+      printf("case %u: wrong glyphs, expected \"%s\"\n", (unsigned)i,
+             cases[i].glyphs);
+      CHECK(0);
+    }
+  }
+  return TEST_RESULT("utf8");
+}
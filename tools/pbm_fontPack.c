@@ -0,0 +1,227 @@
+/**
+ * @file pbm_fontPack.c
+ * @author Adrian STEINER (adi.steiner@hotmail.ch)
+ * @brief Converter of a bitmap font header into a packed font header
+ *
+ * Reads a font header with the glyphs as hexadecimal values (like the fonts in
+ * tests/linux/fonts) and writes a C header with the packed font data, the
+ * glyph offsets and the glyph boxes to stdout.
+ *
+ * Usage: pbm_fontPack <font.h> <width> <height> <MSB|LSB> <name> [glyphs]
+ *
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * @copyright (C) 2026 Adrian STEINER
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https: //www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pbm_graphics.h"
+
+#define DEFAULT_GLYPHS (256) ///< Glyphs of a full 8 bit font
+#define VALUES_PER_LINE (12) ///< Printed values per output line
+
+/**
+ * @brief Read all hexadecimal values after the first '=' of a font header
+ *
+ * Comments are skipped.
+ *
+ * @param file the opened font header
+ * @param data output buffer of the values
+ * @param size size of the output buffer
+ * @return size_t number of read values, or size + 1 if the buffer is too small
+ */
+static size_t readFontValues(FILE *file, uint8_t *data, size_t size);
+
+/**
+ * @brief Print an array of values as C array
+ *
+ * @param type the C type of the array
+ * @param name the name of the array
+ * @param values the values to print
+ * @param count number of values
+ * @param valueSize size of one value in bytes (1 or 4)
+ */
+static void printArray(const char *type, const char *name, const void *values,
+                       uint32_t count, uint32_t valueSize);
+
+int main(int argc, char **argv) {
+  if (argc < 6 || argc > 7) {
+    fprintf(stderr,
+            "usage: %s <font.h> <width> <height> <MSB|LSB> <name> [glyphs]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  pbm_font font = {0};
+  font.width = (uint8_t)atoi(argv[2]);
+  font.height = (uint8_t)atoi(argv[3]);
+  if (0 == strcmp(argv[4], "MSB")) {
+    font.alignment = PBM_DATA_HORIZONTAL_MSB;
+  } else if (0 == strcmp(argv[4], "LSB")) {
+    font.alignment = PBM_DATA_HORIZONTAL_LSB;
+  } else {
+    fprintf(stderr, "unknown font alignment %s\n", argv[4]);
+    return EXIT_FAILURE;
+  }
+  const char *name = argv[5];
+  uint32_t glyphs = (7 == argc) ? (uint32_t)atoi(argv[6]) : DEFAULT_GLYPHS;
+  if (0 == font.width || 0 == font.height || 0 == glyphs) {
+    fprintf(stderr, "invalid font size\n");
+    return EXIT_FAILURE;
+  }
+
+  size_t fontSize = (size_t)glyphs * font.height * ((font.width + 7) / 8);
+  uint8_t *fontData = malloc(fontSize);
+  uint32_t *offsets = malloc(glyphs * sizeof(uint32_t));
+  pbm_glyphBox *boxes = malloc(glyphs * sizeof(pbm_glyphBox));
+  if (NULL == fontData || NULL == offsets || NULL == boxes) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  FILE *file = fopen(argv[1], "r");
+  if (NULL == file) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  size_t values = readFontValues(file, fontData, fontSize);
+  fclose(file);
+  if (values != fontSize) {
+    fprintf(stderr, "font %s has %zu values, expected %zu\n", argv[1], values,
+            fontSize);
+    return EXIT_FAILURE;
+  }
+  font.fontData = fontData;
+
+  uint32_t packedSize = 0;
+  if (PBM_OK != pbm_packFont(&font, glyphs, NULL, &packedSize, NULL, NULL)) {
+    fprintf(stderr, "cannot pack font\n");
+    return EXIT_FAILURE;
+  }
+  uint8_t *packed = calloc(packedSize ? packedSize : 1, 1);
+  if (NULL == packed || PBM_OK != pbm_packFont(&font, glyphs, packed,
+                                               &packedSize, offsets, boxes)) {
+    fprintf(stderr, "cannot pack font\n");
+    return EXIT_FAILURE;
+  }
+
+  size_t tableSize = glyphs * (sizeof(uint32_t) + sizeof(pbm_glyphBox));
+  if (packedSize + tableSize >= fontSize) {
+    fprintf(stderr,
+            "warning: the packed font (%zu bytes) is not smaller than the "
+            "bitmap font (%zu bytes)\n",
+            packedSize + tableSize, fontSize);
+  }
+
+  printf("// Packed %ux%u font generated by pbm_fontPack from %s\n",
+         font.width, font.height, argv[1]);
+  printf("// Bitmap data: %zu bytes, packed data: %u bytes + %zu bytes "
+         "tables\n",
+         fontSize, packedSize, tableSize);
+  printf("//\n// const pbm_font font = {.fontData = %s_data, .width = %u,\n"
+         "//     .height = %u, .alignment = PBM_DATA_HORIZONTAL_MSB,\n"
+         "//     .glyphBoxes = %s_boxes, .encoding = PBM_FONT_PACKED,\n"
+         "//     .glyphOffsets = %s_offsets};\n\n",
+         name, font.width, font.height, name, name);
+  printf("#include \"pbm_fontHandler.h\"\n\n");
+  char arrayName[256];
+  snprintf(arrayName, sizeof(arrayName), "%s_data", name);
+  printArray("unsigned char", arrayName, packed, packedSize, 1);
+  snprintf(arrayName, sizeof(arrayName), "%s_offsets", name);
+  printArray("uint32_t", arrayName, offsets, glyphs, 4);
+  printf("const pbm_glyphBox %s_boxes[%u] = {\n", name, glyphs);
+  for (uint32_t i = 0; i < glyphs; i++) {
+    printf("    {%u, %u, %u, %u}, // 0x%02X\n", boxes[i].xMin, boxes[i].yMin,
+           boxes[i].xMax, boxes[i].yMax, i);
+  }
+  printf("};\n");
+
+  free(packed);
+  free(boxes);
+  free(offsets);
+  free(fontData);
+  return EXIT_SUCCESS;
+}
+
+static size_t readFontValues(FILE *file, uint8_t *data, size_t size) {
+  size_t count = 0;
+  int started = 0;
+  int character = fgetc(file);
+  while (EOF != character) {
+    if ('/' == character) {
+      int next = fgetc(file);
+      if ('/' == next) {
+        // Line comment
+        while (EOF != character && '\n' != character) {
+          character = fgetc(file);
+        }
+        continue;
+      }
+      if ('*' == next) {
+        // Block comment
+        int previous = 0;
+        character = fgetc(file);
+        while (EOF != character && !('*' == previous && '/' == character)) {
+          previous = character;
+          character = fgetc(file);
+        }
+        character = fgetc(file);
+        continue;
+      }
+      character = next;
+      continue;
+    }
+    if ('=' == character) {
+      started = 1;
+    } else if (started && '0' == character) {
+      int next = fgetc(file);
+      if ('x' == next || 'X' == next) {
+        unsigned int value = 0;
+        if (1 == fscanf(file, "%x", &value)) {
+          if (count >= size) {
+            return size + 1;
+          }
+          data[count++] = (uint8_t)value;
+        }
+        character = fgetc(file);
+      } else {
+        character = next;
+      }
+      continue;
+    }
+    character = fgetc(file);
+  }
+  return count;
+}
+
+static void printArray(const char *type, const char *name, const void *values,
+                       uint32_t count, uint32_t valueSize) {
+  printf("const %s %s[%u] = {", type, name, count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (0 == i % VALUES_PER_LINE) {
+      printf("\n   ");
+    }
+    if (1 == valueSize) {
+      printf(" 0x%02X,", ((const uint8_t *)values)[i]);
+    } else {
+      printf(" %u,", ((const uint32_t *)values)[i]);
+    }
+  }
+  printf("\n};\n\n");
+}